@@ -0,0 +1,63 @@
+// swift-tools-version:4.0
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import PackageDescription
+
+// `BlocklyCore` contains the parts of Blockly that only depend on Foundation, so they can be built
+// and tested on platforms without UIKit or the Objective-C runtime (eg. Linux).
+//
+// The iOS framework (including the model, layout and UI layers) is still built with
+// `Blockly.xcodeproj`, CocoaPods or Carthage. Files are only listed here once they no longer depend
+// on UIKit or `@objc`.
+let package = Package(
+  name: "Blockly",
+  products: [
+    .library(name: "BlocklyCore", targets: ["BlocklyCore"]),
+  ],
+  targets: [
+    .target(
+      name: "BlocklyCore",
+      path: "Sources",
+      sources: [
+        "Common/Array+Helper.swift",
+        "Common/Assertions.swift",
+        "Common/BundledFile.swift",
+        "Common/CGPoint+Operators.swift",
+        "Common/CGSize+Operators.swift",
+        "Common/ColorComponents.swift",
+        "Common/Dictionary+Helper.swift",
+        "Common/LRUCache.swift",
+        "Common/Logging.swift",
+        "Common/String+Encoding.swift",
+        "Common/String+Util.swift",
+        "Common/TextMeasurer.swift",
+        "Common/TileIndex.swift",
+        "Common/WrapperBox.swift",
+      ]),
+    .testTarget(
+      name: "BlocklyCoreTests",
+      dependencies: ["BlocklyCore"],
+      path: "Tests/Sources",
+      sources: [
+        "TestConstants.swift",
+        "Core/Common/ColorComponentsTest.swift",
+        "Core/Common/LRUCacheTest.swift",
+        "Core/Common/TextMeasurerTest.swift",
+        "Core/Common/TileIndexTest.swift",
+        "Core/XCTestManifests.swift",
+      ]),
+  ]
+)
@@ -60,6 +60,10 @@ import AEXML
       xmlParsing = 500,
       /// Thrown when xml specifies a block that's unknown to the system.
       xmlUnknownBlock = 501,
+      /// Thrown when xml can't be correctly serialized.
+      xmlSerialization = 502,
+      /// Thrown when a workspace snapshot can't be correctly decoded.
+      snapshotParsing = 550,
       /// Thrown when a file can't be found.
       fileNotFound = 600,
       /// Thrown when a file can't be read.
@@ -69,7 +73,9 @@ import AEXML
       /// Thrown when a property is set to something illegal.
       illegalArgument = 701,
       /// Thrown when an operation is called in an illegal manner.
-      illegalOperation = 702
+      illegalOperation = 702,
+      /// Thrown when code can't be generated for a block.
+      codeGeneration = 800
   }
 
   // MARK: - Initializers
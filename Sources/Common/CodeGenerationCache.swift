@@ -0,0 +1,208 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Incrementally generates code for a workspace using a `NativeCodeGenerator`, by caching the code of
+ each top-level block tree (ie. each stack of blocks).
+
+ The cache listens to events fired by `EventManager.shared`. Whenever a `BlocklyEvent.Change`,
+ `BlocklyEvent.Move`, `BlocklyEvent.Create` or `BlocklyEvent.Delete` event is fired for the
+ workspace, only the code of the affected top-level block trees is invalidated. When `code()` is
+ called, only invalidated trees are regenerated, and the cached code of every tree is stitched back
+ together in workspace order.
+
+ - note: Since events are only received once they have been fired, this class assumes that
+ `EventManager.shared.firePendingEvents()` has been called after the workspace was last modified.
+ If the generator's block generators are changed, `invalidateAll()` must be called.
+ - note: This class is not thread-safe and should only be accessed from the main thread.
+ */
+@objc(BKYCodeGenerationCache)
+@objcMembers public final class CodeGenerationCache: NSObject {
+  // MARK: - Structs
+
+  /**
+   Statistics describing how effective a `CodeGenerationCache` has been.
+   */
+  public struct Statistics {
+    /// The number of top-level block trees whose cached code was reused.
+    public fileprivate(set) var hitCount = 0
+    /// The number of top-level block trees whose code had to be generated.
+    public fileprivate(set) var missCount = 0
+    /// The number of cached top-level block trees that were invalidated by events.
+    public fileprivate(set) var invalidationCount = 0
+
+    /// The ratio of hits to all lookups, or `0` if there haven't been any lookups.
+    public var hitRatio: Double {
+      let lookupCount = hitCount + missCount
+      return lookupCount > 0 ? Double(hitCount) / Double(lookupCount) : 0
+    }
+  }
+
+  // MARK: - Properties
+
+  /// The workspace that code is generated for.
+  public private(set) weak var workspace: Workspace?
+
+  /// The generator used to generate code.
+  public let generator: NativeCodeGenerator
+
+  /// Statistics for this cache.
+  public private(set) var statistics = Statistics()
+
+  /// The number of top-level block trees whose code is currently cached.
+  public var cachedBlockTreeCount: Int {
+    return _fragments.count
+  }
+
+  /// Cached code, indexed by the UUID of each top-level block.
+  private var _fragments = [String: NativeCodeGenerator.Fragment]()
+
+  // MARK: - Initializers
+
+  /**
+   Creates a cache for generating code for a workspace, and starts listening to events from
+   `EventManager.shared`.
+
+   - parameter workspace: The workspace to generate code for.
+   - parameter generator: The generator used to generate code.
+   */
+  public init(workspace: Workspace, generator: NativeCodeGenerator) {
+    self.workspace = workspace
+    self.generator = generator
+    super.init()
+
+    EventManager.shared.addListener(self, filter: EventFilter(
+      eventTypes: [
+        BlocklyEvent.Change.EVENT_TYPE, BlocklyEvent.Create.EVENT_TYPE,
+        BlocklyEvent.Delete.EVENT_TYPE, BlocklyEvent.Move.EVENT_TYPE
+      ],
+      workspaceIDs: [workspace.uuid]))
+  }
+
+  deinit {
+    EventManager.shared.removeListener(self)
+  }
+
+  // MARK: - Public
+
+  /**
+   Generates code for the workspace, only regenerating the code of top-level block trees that have
+   changed since the last call.
+
+   - returns: The generated code.
+   - throws:
+   `BlocklyError`: Thrown if no generator exists for a block, or if a generator failed.
+   */
+  public func code() throws -> String {
+    guard let workspace = self.workspace else {
+      return ""
+    }
+
+    let topLevelBlocks = NativeCodeGenerator.sortedByPosition(workspace.topLevelBlocks())
+    var fragments = [NativeCodeGenerator.Fragment]()
+    var liveFragments = [String: NativeCodeGenerator.Fragment]()
+
+    for block in topLevelBlocks {
+      let fragment: NativeCodeGenerator.Fragment
+      if let cachedFragment = _fragments[block.uuid] {
+        fragment = cachedFragment
+        statistics.hitCount += 1
+      } else {
+        fragment = try generator.fragment(forTopLevelBlock: block)
+        statistics.missCount += 1
+      }
+      fragments.append(fragment)
+      liveFragments[block.uuid] = fragment
+    }
+
+    // Drop fragments for blocks that are no longer top-level blocks
+    _fragments = liveFragments
+
+    return NativeCodeGenerator.stitch(fragments)
+  }
+
+  /**
+   Invalidates the cached code of all top-level block trees.
+   */
+  public func invalidateAll() {
+    statistics.invalidationCount += _fragments.count
+    _fragments.removeAll()
+  }
+
+  /**
+   Invalidates the cached code of the top-level block tree containing a given block.
+
+   - parameter blockUUID: The UUID of the block.
+   */
+  public func invalidateBlockTree(containingBlockUUID blockUUID: String) {
+    guard let block = workspace?.allBlocks[blockUUID] else {
+      // The block isn't in the workspace, but it may have been a top-level block
+      invalidateFragment(forTopLevelBlockUUID: blockUUID)
+      return
+    }
+    invalidateFragment(forTopLevelBlockUUID: topLevelBlock(of: block).uuid)
+  }
+
+  // MARK: - Private
+
+  private func invalidateFragment(forTopLevelBlockUUID uuid: String) {
+    if _fragments.removeValue(forKey: uuid) != nil {
+      statistics.invalidationCount += 1
+    }
+  }
+
+  private func topLevelBlock(of block: Block) -> Block {
+    var current = block
+    while let connection = current.inferiorConnection,
+      let parent = (connection.targetConnection ?? connection.shadowConnection)?.sourceBlock
+    {
+      current = parent
+    }
+    return current
+  }
+}
+
+// MARK: - EventManagerListener Implementation
+
+extension CodeGenerationCache: EventManagerListener {
+  public func eventManager(_ eventManager: EventManager, didFireEvent event: BlocklyEvent) {
+    guard let workspace = self.workspace, event.workspaceID == workspace.uuid else {
+      return
+    }
+
+    if let event = event as? BlocklyEvent.Move, let blockID = event.blockID {
+      if event.oldParentID == nil && event.newParentID == nil {
+        // The block tree was only repositioned, which only affects the order of the cached code
+        return
+      }
+      if let oldParentID = event.oldParentID {
+        invalidateBlockTree(containingBlockUUID: oldParentID)
+      }
+      // This also invalidates `blockID` if it was previously a top-level block
+      invalidateFragment(forTopLevelBlockUUID: blockID)
+      invalidateBlockTree(containingBlockUUID: blockID)
+    } else if event is BlocklyEvent.Change || event is BlocklyEvent.Create,
+      let blockID = event.blockID
+    {
+      invalidateBlockTree(containingBlockUUID: blockID)
+    } else if let event = event as? BlocklyEvent.Delete {
+      for blockID in event.blockIDs {
+        invalidateFragment(forTopLevelBlockUUID: blockID)
+      }
+    }
+  }
+}
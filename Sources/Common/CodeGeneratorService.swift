@@ -20,6 +20,11 @@ import Foundation
 /**
  Service for generating code from a workspace.
 
+ Loaded code generators are pooled by their generator configuration (ie. the generator object, JS
+ block generator files and JSON block definition files of a request), so generating code for
+ several languages does not reload a web view each time. Requests with the same configuration are
+ executed in order, while requests for different configurations are executed in parallel.
+
  For details on how to use this class, see:
  https://developers.google.com/blockly/guides/configure/ios/code-generators
  */
@@ -43,14 +48,123 @@ import Foundation
    */
   public typealias ErrorClosure = (_ requestUUID: String, _ error: String) -> Void
 
+  /**
+   Closure that is called when a code generation request has finished, whether it succeeded or
+   failed.
+
+   - parameter requestUUID: The UUID of the request.
+   - parameter queueTime: The amount of time the request spent waiting in the queue, in seconds.
+   - parameter totalTime: The amount of time between the request being made and it finishing, in
+   seconds.
+   */
+  public typealias RequestFinishedClosure =
+    (_ requestUUID: String, _ queueTime: TimeInterval, _ totalTime: TimeInterval) -> Void
+
+  // MARK: - Structs
+
+  /**
+   Statistics describing the requests that have been processed by a `CodeGeneratorService`.
+   */
+  public struct Statistics {
+    /// The number of requests that have finished (successfully or not).
+    public fileprivate(set) var finishedRequestCount = 0
+    /// The number of requests that were merged into an identical request (ie. they reused its
+    /// result, instead of generating code themselves).
+    public fileprivate(set) var coalescedRequestCount = 0
+    /// The number of requests that were dropped because a newer request was made for the same
+    /// workspace (see `coalescesRequestsByWorkspace`).
+    public fileprivate(set) var supersededRequestCount = 0
+    /// The number of `CodeGenerator` instances that have been created (ie. the number of times a
+    /// web view had to be loaded).
+    public fileprivate(set) var codeGeneratorLoadCount = 0
+    /// The largest number of requests that have been in the queue at the same time.
+    public fileprivate(set) var maximumQueueDepth = 0
+    /// The time between the last finished request being made and it finishing, in seconds.
+    public fileprivate(set) var lastRequestLatency: TimeInterval = 0
+    /// The sum of the latencies of all finished requests, in seconds.
+    public fileprivate(set) var totalRequestLatency: TimeInterval = 0
+
+    /// The average latency of all finished requests, in seconds.
+    public var averageRequestLatency: TimeInterval {
+      return finishedRequestCount > 0 ? totalRequestLatency / Double(finishedRequestCount) : 0
+    }
+  }
+
   // MARK: - Properties
 
   /// List of core Blockly JS dependencies
   fileprivate let jsCoreDependencies: [BundledFile]
-  /// Current code generator
-  fileprivate var codeGenerator: CodeGenerator?
+  /// Pool of loaded code generators, keyed by their generator configuration (see
+  /// `CodeGeneratorServiceRequest.configurationKey`). This must only be accessed on the main
+  /// thread.
+  fileprivate var codeGenerators = [String: CodeGenerator]()
+  /// The keys of `codeGenerators`, ordered from least to most recently used. This must only be
+  /// accessed on the main thread.
+  fileprivate var codeGeneratorKeysByUse = [String]()
+  /// Requests that are waiting for the busy code generator of their configuration to become idle,
+  /// keyed by generator configuration. This must only be accessed on the main thread.
+  fileprivate var requestsWaitingForCodeGenerator = [String: [CodeGeneratorServiceRequest]]()
   /// Operation queue of all pending code generation requests
   fileprivate let requestQueue = OperationQueue()
+  /// The most recent request that has been made for each generator configuration, used for running
+  /// requests with the same configuration in order and for coalescing identical requests.
+  fileprivate var lastRequests = [String: CodeGeneratorServiceRequest]()
+  /// The most recent request that has been made for each workspace and generator configuration,
+  /// when `coalescesRequestsByWorkspace` is `true`.
+  fileprivate var lastWorkspaceRequests = [String: CodeGeneratorServiceRequest]()
+  /// Lock for accessing `lastRequests` and `lastWorkspaceRequests`
+  fileprivate let lastRequestsLock = NSLock()
+
+  /**
+   If `true`, requests made via `generateCode(forWorkspace:...)` are coalesced by workspace, where
+   only the latest request for a workspace (and generator configuration) is honored:
+
+   - Making a new request for a workspace supersedes any earlier requests for it. Superseded
+   requests that haven't started yet are dropped, and the completion/error closures of superseded
+   requests are never called.
+   - The workspace isn't serialized into XML until its request actually starts executing, so
+   superseded requests never pay for serialization.
+
+   This is useful when generating code in response to every workspace edit. Since serialization is
+   deferred, workspaces passed to `generateCode(forWorkspace:...)` must only be modified on the
+   main thread.
+
+   Defaults to `false`.
+   */
+  public var coalescesRequestsByWorkspace = false
+
+  /**
+   The maximum number of requests that can be executed at the same time. Requests that share the
+   same generator configuration are always executed one at a time, in the order they were made,
+   but requests for different configurations (eg. Python and JavaScript) can run in parallel.
+
+   Defaults to `3`.
+   */
+  public var maximumConcurrentRequests: Int {
+    get { return requestQueue.maxConcurrentOperationCount }
+    set { requestQueue.maxConcurrentOperationCount = max(newValue, 1) }
+  }
+
+  /**
+   The maximum number of loaded code generators to keep in the pool. When this limit is exceeded,
+   the least recently used idle code generator is discarded.
+
+   Defaults to `3`.
+   */
+  public var maximumCodeGeneratorCount = 3
+
+  /// The number of requests that are currently queued or executing.
+  public var queueDepth: Int {
+    return requestQueue.operationCount
+  }
+
+  /// Statistics for all requests processed by this service. This is only updated on the main
+  /// thread.
+  public fileprivate(set) var statistics = Statistics()
+
+  /// Closure that is called on the main thread whenever a request has finished, reporting its
+  /// latency.
+  public var onRequestFinished: RequestFinishedClosure?
 
   /// The code generator service request builder. This must be set before requesting code
   /// generation.
@@ -85,8 +199,7 @@ import Foundation
     self.jsCoreDependencies = jsCoreDependencies.map { (path: $0, bundle: bundle) }
     super.init()
 
-    // Only allow one request to execute at a time
-    requestQueue.maxConcurrentOperationCount = 1
+    requestQueue.maxConcurrentOperationCount = 3
   }
 
   deinit {
@@ -124,7 +237,13 @@ import Foundation
   public func generateCode(forWorkspace workspace: Workspace,
                            onCompletion: CompletionClosure? = nil,
                            onError: ErrorClosure? = nil) throws -> String {
-    return try generateCode(forWorkspaceXML: workspace.toXML(),
+    guard let builder = self.requestBuilder else {
+      throw BlocklyError(.illegalState,
+        "`setRequestBuilder(:shouldCache:)` must be called before requesting code generation.")
+    }
+
+    return try generateCode(forWorkspace: workspace,
+                            requestBuilder: builder,
                             onCompletion: onCompletion,
                             onError: onError)
   }
@@ -148,12 +267,91 @@ import Foundation
         "`setRequestBuilder(:shouldCache:)` must be called before requesting code generation.")
     }
 
-    let request = builder.makeRequest(forWorkspaceXML: xml)
+    return generateCode(
+      forWorkspaceXML: xml, requestBuilder: builder, onCompletion: onCompletion, onError: onError)
+  }
+
+  /**
+   Requests that code be generated from a given workspace, using a specific request builder
+   instead of the one set by `setRequestBuilder(:shouldCache:)`.
+
+   This allows code to be generated for multiple languages from the same workspace. Requests with
+   different generator configurations are executed in parallel, each on its own pooled
+   `CodeGenerator`.
+
+   - parameter workspace: The `Workspace` to generate code for.
+   - parameter requestBuilder: The `CodeGeneratorServiceRequestBuilder` that specifies generators.
+   - parameter onCompletion: The `CompletionClosure` to be called when the code is generated.
+   - parameter onError: The `ErrorClosure` to be called if the code fails to generate.
+   - returns: A UUID representing this particular request.
+   - throws:
+   `BlocklyError`: Occurs if `workspace` could not be serialized into XML. If
+   `coalescesRequestsByWorkspace` is `true`, serialization errors are instead reported through
+   `onError`.
+   */
+  public func generateCode(forWorkspace workspace: Workspace,
+                           requestBuilder: CodeGeneratorServiceRequestBuilder,
+                           onCompletion: CompletionClosure? = nil,
+                           onError: ErrorClosure? = nil) throws -> String {
+    if !coalescesRequestsByWorkspace {
+      return generateCode(forWorkspaceXML: try workspace.toXML(),
+                          requestBuilder: requestBuilder,
+                          onCompletion: onCompletion,
+                          onError: onError)
+    }
+
+    let request = requestBuilder.makeDeferredRequest(forWorkspace: workspace)
     request.uuid = UUID().uuidString
     request.onCompletion = onCompletion
     request.onError = onError
     request.codeGeneratorService = self
-    requestQueue.addOperation(request)
+
+    // Supersede the last request for this workspace
+    let workspaceKey = workspace.uuid + "\n" + request.configurationKey
+    lastRequestsLock.lock()
+    let supersededRequest = lastWorkspaceRequests[workspaceKey]
+    lastWorkspaceRequests[workspaceKey] = request
+    request.workspaceKey = workspaceKey
+    lastRequestsLock.unlock()
+
+    if let supersededRequest = supersededRequest,
+      !supersededRequest.isFinished && !supersededRequest.isCancelled
+    {
+      // If the request hasn't started, cancelling it drops it from the queue. Otherwise, it still
+      // runs to completion, but its closures are never called.
+      supersededRequest.cancel()
+      DispatchQueue.main.async {
+        self.statistics.supersededRequestCount += 1
+      }
+    }
+
+    enqueueRequest(request)
+    return request.uuid
+  }
+
+  /**
+   Requests that code be generated from given workspace XML, using a specific request builder
+   instead of the one set by `setRequestBuilder(:shouldCache:)`.
+
+   If an identical request (ie. one with the same generator configuration and workspace XML) is
+   still waiting in the queue, this request is coalesced with it and reuses its result.
+
+   - parameter xml: The workspace XML to generate code for.
+   - parameter requestBuilder: The `CodeGeneratorServiceRequestBuilder` that specifies generators.
+   - parameter onCompletion: The `CompletionClosure` to be called when the code is generated.
+   - parameter onError: The `ErrorClosure` to be called if the code fails to generate.
+   - returns: A UUID representing this particular request.
+   */
+  public func generateCode(forWorkspaceXML xml: String,
+                           requestBuilder: CodeGeneratorServiceRequestBuilder,
+                           onCompletion: CompletionClosure? = nil,
+                           onError: ErrorClosure? = nil) -> String {
+    let request = requestBuilder.makeRequest(forWorkspaceXML: xml)
+    request.uuid = UUID().uuidString
+    request.onCompletion = onCompletion
+    request.onError = onError
+    request.codeGeneratorService = self
+    enqueueRequest(request)
     return request.uuid
   }
 
@@ -184,51 +382,259 @@ import Foundation
 
   // MARK: - Private
 
+  fileprivate func enqueueRequest(_ request: CodeGeneratorServiceRequest) {
+    let key = request.configurationKey
+
+    lastRequestsLock.lock()
+    if let lastRequest = lastRequests[key] {
+      if let workspaceXML = request.workspaceXML,
+        !lastRequest.isExecuting && !lastRequest.isFinished && !lastRequest.isCancelled &&
+        lastRequest.workspaceXML == workspaceXML
+      {
+        // An identical request is still waiting to run, so reuse its result
+        request.coalescedRequest = lastRequest.coalescedRequest ?? lastRequest
+      }
+
+      // Requests for the same configuration share a code generator, so they must run in order
+      addOrderingDependencies(to: request, lastRequest: lastRequest)
+    }
+    lastRequests[key] = request
+    lastRequestsLock.unlock()
+
+    request.enqueueTime = Date()
+    requestQueue.addOperation(request)
+
+    let queueDepth = requestQueue.operationCount
+    DispatchQueue.main.async {
+      self.statistics.maximumQueueDepth = max(self.statistics.maximumQueueDepth, queueDepth)
+    }
+  }
+
+  /**
+   Makes a request depend on the last request for its configuration.
+
+   A cancelled operation finishes without waiting for its own dependencies, so if `lastRequest` (or
+   any request before it) has been cancelled, the new request also depends on whatever the
+   cancelled request was waiting for. Otherwise, superseding a queued request would let its
+   replacement start while an earlier request is still running.
+   */
+  fileprivate func addOrderingDependencies(
+    to request: CodeGeneratorServiceRequest, lastRequest: CodeGeneratorServiceRequest)
+  {
+    var visited = Set<ObjectIdentifier>()
+    var pending: [Operation] = [lastRequest]
+
+    while let operation = pending.popLast() {
+      if visited.contains(ObjectIdentifier(operation)) ||
+        (operation.isFinished && !operation.isCancelled)
+      {
+        // This request has already run to completion, so it no longer holds a code generator
+        continue
+      }
+      visited.insert(ObjectIdentifier(operation))
+
+      request.addDependency(operation)
+      if operation.isCancelled {
+        pending.append(contentsOf: operation.dependencies)
+      }
+    }
+  }
+
   fileprivate func executeRequest(_ request: CodeGeneratorServiceRequest) {
-    if let codeGenerator = self.codeGenerator ,
-      (compareLists(codeGenerator.jsonBlockDefinitionFiles, request.jsonBlockDefinitionFiles) &&
-      compareLists(codeGenerator.jsBlockGeneratorFiles, request.jsBlockGeneratorFiles) &&
-      codeGenerator.jsGeneratorObject == request.jsGeneratorObject)
-    {
-      // No JS/JSON files have changed since the last request. Use the existing code generator.
-      codeGenerator.generateCodeForWorkspaceXML(request.workspaceXML,
-        completion: request.completeRequest(withCode:),
-        error: request.completeRequest(withError:))
-    } else {
-      // Use a new code generator (`CodeGenerator` must be instantiated on the main thread)
-      DispatchQueue.main.async(execute: {
-        self.codeGenerator = CodeGenerator(
-          jsCoreDependencies: self.jsCoreDependencies,
-          jsGeneratorObject: request.jsGeneratorObject,
-          jsBlockGeneratorFiles: request.jsBlockGeneratorFiles,
-          jsonBlockDefinitionFiles: request.jsonBlockDefinitionFiles,
-          onLoadCompletion: {
-            self.codeGenerator?.generateCodeForWorkspaceXML(request.workspaceXML,
-              completion: request.completeRequest(withCode:),
-              error: request.completeRequest(withError:))
-          }, onLoadFailure: { (error) -> Void in
-            self.codeGenerator = nil // Nil out this self.codeGenerator so we don't use it again
-            request.completeRequest(withError: error)
-          })
+    // `CodeGenerator` must be instantiated and used on the main thread
+    DispatchQueue.main.async {
+      if let result = request.coalescedRequest?.result {
+        // An identical request has already generated code
+        self.statistics.coalescedRequestCount += 1
+        request.completeRequest(withResult: result)
+        return
+      }
+
+      // Serialize the workspace now, if it was deferred
+      let workspaceXML: String
+      do {
+        workspaceXML = try request.resolveWorkspaceXML()
+      } catch let error {
+        request.completeRequest(withError: "Could not serialize workspace into XML: \(error)")
+        return
+      }
+
+      if let nativeGenerator = request.nativeGenerator {
+        self.executeNativeRequest(
+          request, workspaceXML: workspaceXML, nativeGenerator: nativeGenerator)
+        return
+      }
+
+      let key = request.configurationKey
+
+      if let codeGenerator = self.codeGenerators[key] {
+        switch codeGenerator.state {
+        case .readyForUse:
+          // A code generator has already been loaded for this configuration. Use it.
+          self.markCodeGeneratorUsed(forKey: key)
+          self.generateCode(
+            forRequest: request, workspaceXML: workspaceXML, codeGenerator: codeGenerator)
+          return
+        case .initialized, .loading, .generatingCode:
+          // The code generator is still busy with an earlier request (eg. one whose ordering was
+          // broken by a cancellation). Replacing it would drop that request, so wait until it's
+          // idle instead.
+          self.requestsWaitingForCodeGenerator[key, default: []].append(request)
+          return
+        case .unusable:
+          // Load a new code generator below
+          break
+        }
+      }
+
+      // Load a new code generator. It keeps a reference to itself inside its load closures, until
+      // it has finished loading.
+      var codeGenerator: CodeGenerator!
+      codeGenerator = CodeGenerator(
+        jsCoreDependencies: self.jsCoreDependencies,
+        jsGeneratorObject: request.jsGeneratorObject,
+        jsBlockGeneratorFiles: request.jsBlockGeneratorFiles,
+        jsonBlockDefinitionFiles: request.jsonBlockDefinitionFiles,
+        onLoadCompletion: {
+          self.generateCode(
+            forRequest: request, workspaceXML: workspaceXML, codeGenerator: codeGenerator)
+        }, onLoadFailure: { (error) -> Void in
+          // Remove this code generator from the pool so we don't use it again
+          if self.codeGenerators[key] === codeGenerator {
+            self.removeCodeGenerator(forKey: key)
+          }
+          request.completeRequest(withError: error)
+          self.executeNextWaitingRequest(forKey: key)
+        })
+      self.statistics.codeGeneratorLoadCount += 1
+      self.codeGenerators[key] = codeGenerator
+      self.markCodeGeneratorUsed(forKey: key)
+      self.evictCodeGeneratorsIfNeeded()
+    }
+  }
+
+  fileprivate func generateCode(
+    forRequest request: CodeGeneratorServiceRequest, workspaceXML: String,
+    codeGenerator: CodeGenerator)
+  {
+    // This is called on the main thread
+    let key = request.configurationKey
+    codeGenerator.generateCodeForWorkspaceXML(workspaceXML,
+      completion: { code in
+        request.completeRequest(withCode: code)
+        self.executeNextWaitingRequest(forKey: key)
+      }, error: { error in
+        request.completeRequest(withError: error)
+        self.executeNextWaitingRequest(forKey: key)
       })
+  }
+
+  fileprivate func executeNextWaitingRequest(forKey key: String) {
+    // This is called on the main thread
+    guard var waitingRequests = requestsWaitingForCodeGenerator[key],
+      !waitingRequests.isEmpty else
+    {
+      return
+    }
+
+    let request = waitingRequests.removeFirst()
+    requestsWaitingForCodeGenerator[key] = waitingRequests.isEmpty ? nil : waitingRequests
+    executeRequest(request)
+  }
+
+  fileprivate func executeNativeRequest(
+    _ request: CodeGeneratorServiceRequest, workspaceXML: String,
+    nativeGenerator: NativeCodeGenerator)
+  {
+    // This is called on the main thread
+    let trimmedXML = workspaceXML.trimmingCharacters(in: .whitespacesAndNewlines)
+    if trimmedXML.isEmpty {
+      // Nothing to generate (eg. when warming up via `setRequestBuilder(:shouldCache:)`)
+      request.completeRequest(withCode: "")
+      return
+    }
+    guard let blockFactory = request.blockFactory else {
+      request.completeRequest(withError: "No block factory was specified for the native generator.")
+      return
+    }
+
+    // Rebuild a private copy of the workspace here, since `blockFactory` is not thread-safe. After
+    // that, the blocks are not shared with anything else, so code can be generated in the
+    // background.
+    let blockTrees: [Block.BlockTree]
+    do {
+      blockTrees = try BlockXMLStreamLoader(factory: blockFactory)
+        .blockTrees(fromWorkspaceXMLData: Data(workspaceXML.utf8))
+    } catch let error {
+      request.completeRequest(withError: "Could not load workspace XML: \(error)")
+      return
     }
+
+    DispatchQueue.global(qos: .userInitiated).async {
+      do {
+        let code = try nativeGenerator.code(forTopLevelBlocks: blockTrees.map { $0.rootBlock })
+        request.completeRequest(withCode: code)
+      } catch let error {
+        request.completeRequest(withError: "An error occurred generating code: \(error)")
+      }
+    }
+  }
+
+  fileprivate func requestFinished(_ request: CodeGeneratorServiceRequest) {
+    // This is called on the main thread
+    lastRequestsLock.lock()
+    if lastRequests[request.configurationKey] === request {
+      lastRequests[request.configurationKey] = nil
+    }
+    if let workspaceKey = request.workspaceKey, lastWorkspaceRequests[workspaceKey] === request {
+      lastWorkspaceRequests[workspaceKey] = nil
+    }
+    lastRequestsLock.unlock()
+
+    guard let enqueueTime = request.enqueueTime else {
+      return
+    }
+
+    let now = Date()
+    let totalTime = now.timeIntervalSince(enqueueTime)
+    let queueTime = (request.startTime ?? now).timeIntervalSince(enqueueTime)
+
+    statistics.finishedRequestCount += 1
+    statistics.lastRequestLatency = totalTime
+    statistics.totalRequestLatency += totalTime
+    onRequestFinished?(request.uuid, queueTime, totalTime)
   }
 
-  fileprivate func compareLists(_ list1: [BundledFile], _ list2: [BundledFile]) -> Bool {
-    if list1.count != list2.count {
-      return false
+  fileprivate func markCodeGeneratorUsed(forKey key: String) {
+    if let index = codeGeneratorKeysByUse.index(of: key) {
+      codeGeneratorKeysByUse.remove(at: index)
     }
-    var mutableList1 = list1
-    for path2 in list2 {
-      if let index = mutableList1.index(where:
-        { $0.path == path2.path && $0.bundle == path2.bundle })
+    codeGeneratorKeysByUse.append(key)
+  }
+
+  fileprivate func removeCodeGenerator(forKey key: String) {
+    codeGenerators[key] = nil
+    if let index = codeGeneratorKeysByUse.index(of: key) {
+      codeGeneratorKeysByUse.remove(at: index)
+    }
+  }
+
+  fileprivate func evictCodeGeneratorsIfNeeded() {
+    var i = 0
+    while codeGenerators.count > max(maximumCodeGeneratorCount, 1) &&
+      i < codeGeneratorKeysByUse.count
+    {
+      let key = codeGeneratorKeysByUse[i]
+
+      // Only discard idle code generators, since discarding a busy one would drop its request
+      if let codeGenerator = codeGenerators[key],
+        codeGenerator.state == .readyForUse || codeGenerator.state == .unusable
       {
-        mutableList1.remove(at: index)
+        removeCodeGenerator(forKey: key)
       } else {
-        return false
+        i += 1
       }
     }
-    return true
   }
 }
 
@@ -243,14 +649,26 @@ internal class CodeGeneratorServiceRequest: Operation {
   // MARK: - Properties
   /// The uuid for this request.
   internal var uuid: String = ""
-  /// The workspace XML to use when generating code
-  internal let workspaceXML: String
+  /// The workspace XML to use when generating code. This is `nil` for a deferred request until it
+  /// starts executing.
+  internal fileprivate(set) var workspaceXML: String?
+  /// Closure that serializes the workspace into XML, for requests that defer serialization until
+  /// they start executing.
+  internal var workspaceXMLProvider: (() throws -> String)?
   /// The name of the JS object that generates code (e.g. 'Blockly.Python')
   internal let jsGeneratorObject: String
   /// List of block generator JS files (e.g. ['python_compressed.js'])
   internal let jsBlockGeneratorFiles: [BundledFile]
   /// List of JSON files containing block definitions
   internal let jsonBlockDefinitionFiles: [BundledFile]
+  /// The native generator to use instead of a JS generator, if specified
+  internal let nativeGenerator: NativeCodeGenerator?
+  /// The block factory used to rebuild the workspace for `nativeGenerator`
+  internal let blockFactory: BlockFactory?
+  /// Key that identifies the generator configuration of this request (ie. its generator object,
+  /// JS block generator files and JSON block definition files). Requests with the same key can
+  /// share a `CodeGenerator`.
+  internal let configurationKey: String
   /// Callback that is executed when code generation completes successfully. This is always
   /// executed on the main thread.
   internal var onCompletion: CodeGeneratorService.CompletionClosure?
@@ -259,24 +677,71 @@ internal class CodeGeneratorServiceRequest: Operation {
   internal var onError: CodeGeneratorService.ErrorClosure?
   /// The code generator service used for executing this request.
   fileprivate weak var codeGeneratorService: CodeGeneratorService?
+  /// An identical request that was made earlier, whose result should be reused by this request.
+  fileprivate var coalescedRequest: CodeGeneratorServiceRequest?
+  /// The result of this request, once code generation has finished.
+  fileprivate var result: Result?
+  /// The time this request was added to the queue.
+  fileprivate var enqueueTime: Date?
+  /// The time this request started executing.
+  fileprivate var startTime: Date?
+  /// For requests that are coalesced by workspace, the key of the workspace and generator
+  /// configuration.
+  fileprivate var workspaceKey: String?
+
+  /// The result of a code generation request.
+  fileprivate enum Result {
+    case code(String)
+    case error(String)
+  }
 
   // MARK: - Initializers
 
   /**
    Use `CodeGeneratorServiceRequestBuilder` to create a request.
    */
-  internal init(workspaceXML: String, jsGeneratorObject: String,
+  internal init(workspaceXML: String?, jsGeneratorObject: String,
                 jsBlockGeneratorFiles: [BundledFile], jsonBlockDefinitionFiles: [BundledFile],
+                nativeGenerator: NativeCodeGenerator? = nil, blockFactory: BlockFactory? = nil,
                 onCompletion: CodeGeneratorService.CompletionClosure?,
                 onError: CodeGeneratorService.ErrorClosure?) {
     self.workspaceXML = workspaceXML
     self.jsGeneratorObject = jsGeneratorObject
     self.jsBlockGeneratorFiles = jsBlockGeneratorFiles
     self.jsonBlockDefinitionFiles = jsonBlockDefinitionFiles
+    self.nativeGenerator = nativeGenerator
+    self.blockFactory = blockFactory
+
+    if let nativeGenerator = nativeGenerator {
+      // Native generators don't use any files, so identify them by instance instead
+      self.configurationKey = "native\n\(ObjectIdentifier(nativeGenerator).hashValue)"
+    } else {
+      self.configurationKey = CodeGeneratorServiceRequest.makeConfigurationKey(
+        jsGeneratorObject: jsGeneratorObject, jsBlockGeneratorFiles: jsBlockGeneratorFiles,
+        jsonBlockDefinitionFiles: jsonBlockDefinitionFiles)
+    }
     self.onCompletion = onCompletion
     self.onError = onError
   }
 
+  /**
+   Creates a key that identifies a generator configuration. The order of files within each list
+   does not affect the key.
+   */
+  fileprivate static func makeConfigurationKey(
+    jsGeneratorObject: String, jsBlockGeneratorFiles: [BundledFile],
+    jsonBlockDefinitionFiles: [BundledFile]) -> String
+  {
+    let fileKey: ([BundledFile]) -> String = { files in
+      return files
+        .map { $0.bundle.bundlePath + "/" + $0.path }
+        .sorted()
+        .joined(separator: "\n")
+    }
+    return [jsGeneratorObject, fileKey(jsBlockGeneratorFiles), fileKey(jsonBlockDefinitionFiles)]
+      .joined(separator: "\n\n")
+  }
+
   // MARK: - Super
 
   fileprivate var _executing: Bool = false
@@ -314,6 +779,7 @@ internal class CodeGeneratorServiceRequest: Operation {
       return
     }
     self.isExecuting = true
+    self.startTime = Date()
 
     // Execute the request. The operation will eventually execute:
     // completeRequestWithCode(...) or
@@ -330,20 +796,45 @@ internal class CodeGeneratorServiceRequest: Operation {
 
   /// MARK: - Private
 
-  fileprivate func completeRequest(withCode code: String) {
-    DispatchQueue.main.async {
-      if !self.isCancelled {
-        self.onCompletion?(self.uuid, code)
-      }
-      self.finishOperation()
+  /**
+   Returns the workspace XML for this request, serializing the workspace first if this request was
+   deferred. This must be called on the main thread.
+   */
+  fileprivate func resolveWorkspaceXML() throws -> String {
+    if let workspaceXML = self.workspaceXML {
+      return workspaceXML
+    }
+    guard let provider = workspaceXMLProvider else {
+      throw BlocklyError(.illegalState, "No workspace has been specified for this request.")
     }
+
+    let workspaceXML = try provider()
+    self.workspaceXML = workspaceXML
+    self.workspaceXMLProvider = nil
+    return workspaceXML
+  }
+
+  fileprivate func completeRequest(withCode code: String) {
+    completeRequest(withResult: .code(code))
   }
 
   fileprivate func completeRequest(withError error: String) {
+    completeRequest(withResult: .error(error))
+  }
+
+  fileprivate func completeRequest(withResult result: Result) {
     DispatchQueue.main.async {
+      self.result = result
+
       if !self.isCancelled {
-        self.onError?(self.uuid, error)
+        switch result {
+        case .code(let code):
+          self.onCompletion?(self.uuid, code)
+        case .error(let error):
+          self.onError?(self.uuid, error)
+        }
       }
+      self.codeGeneratorService?.requestFinished(self)
       self.finishOperation()
     }
   }
@@ -351,6 +842,8 @@ internal class CodeGeneratorServiceRequest: Operation {
   fileprivate func finishOperation() {
     self.onCompletion = nil
     self.onError = nil
+    self.coalescedRequest = nil
+    self.workspaceXMLProvider = nil
     self.isExecuting = false
     self.isFinished = true
   }
@@ -30,6 +30,10 @@ import Foundation
   open private(set) var jsBlockGeneratorFiles = [BundledFile]()
   /// List of JSON files containing block definitions that should be used for each request
   open private(set) var jsonBlockDefinitionFiles = [BundledFile]()
+  /// The native generator that should be used for each request, instead of a JS generator
+  open let nativeGenerator: NativeCodeGenerator?
+  /// The block factory used to rebuild workspaces for `nativeGenerator`
+  open let blockFactory: BlockFactory?
 
   // MARK: - Initializers
 
@@ -42,6 +46,27 @@ import Foundation
   @objc(initWithJSGeneratorObject:)
   public init(jsGeneratorObject: String) {
     self.jsGeneratorObject = jsGeneratorObject
+    self.nativeGenerator = nil
+    self.blockFactory = nil
+  }
+
+  /**
+   Create a builder for making `CodeGeneratorServiceRequest` instances that generate code using a
+   `NativeCodeGenerator`, instead of a JS generator running inside a web view.
+
+   Requests made by this builder rebuild a private copy of the workspace from its XML (on the main
+   thread), and then generate code from it on a background thread. JS block generator and JSON
+   block definition files are ignored.
+
+   - parameter nativeGenerator: The native generator that should be used for each request.
+   - parameter blockFactory: The block factory used to rebuild workspaces from XML. It must contain
+   block builders for every block type that code is generated for.
+   */
+  @objc(initWithNativeGenerator:blockFactory:)
+  public init(nativeGenerator: NativeCodeGenerator, blockFactory: BlockFactory) {
+    self.jsGeneratorObject = nativeGenerator.name
+    self.nativeGenerator = nativeGenerator
+    self.blockFactory = blockFactory
   }
 
   // MARK: - Public
@@ -109,6 +134,7 @@ import Foundation
       workspaceXML: workspaceXML, jsGeneratorObject: jsGeneratorObject,
       jsBlockGeneratorFiles: jsBlockGeneratorFiles,
       jsonBlockDefinitionFiles: jsonBlockDefinitionFiles,
+      nativeGenerator: nativeGenerator, blockFactory: blockFactory,
       onCompletion: nil, onError: nil)
   }
 
@@ -122,4 +148,31 @@ import Foundation
   internal func makeRequest(forWorkspace workspace: Workspace) throws -> CodeGeneratorServiceRequest {
     return makeRequest(forWorkspaceXML: try workspace.toXML())
   }
+
+  /**
+   Based on the current state of the builder and a given workspace, create a
+   code generator service request that only serializes the workspace into XML once the request
+   starts executing.
+
+   - note: The request does not keep a strong reference to `workspace`.
+   - parameter workspace: The `Workspace` to use for the request.
+   - returns: A `CodeGeneratorServiceRequest`.
+   */
+  internal func makeDeferredRequest(forWorkspace workspace: Workspace)
+    -> CodeGeneratorServiceRequest
+  {
+    let request = CodeGeneratorServiceRequest(
+      workspaceXML: nil, jsGeneratorObject: jsGeneratorObject,
+      jsBlockGeneratorFiles: jsBlockGeneratorFiles,
+      jsonBlockDefinitionFiles: jsonBlockDefinitionFiles,
+      nativeGenerator: nativeGenerator, blockFactory: blockFactory,
+      onCompletion: nil, onError: nil)
+    request.workspaceXMLProvider = { [weak workspace] in
+      guard let workspace = workspace else {
+        throw BlocklyError(.illegalState, "The workspace was deallocated before generating code.")
+      }
+      return try workspace.toXML()
+    }
+    return request
+  }
 }
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ The red, green, and blue components of a color, each with a value between 0.0 and 1.0.
+
+ Unlike `UIColor`, this only depends on Foundation, so colors can be parsed and converted on
+ platforms without UIKit. `ColorHelper` uses this to create its `UIColor` instances.
+ */
+public struct ColorComponents: Equatable {
+  // MARK: - Properties
+
+  /// The red component.
+  public let red: CGFloat
+  /// The green component.
+  public let green: CGFloat
+  /// The blue component.
+  public let blue: CGFloat
+
+  // MARK: - Initializers
+
+  /**
+   Initializes the components of a color.
+
+   - parameter red: The red component, which is clamped to a value between 0.0 and 1.0.
+   - parameter green: The green component, which is clamped to a value between 0.0 and 1.0.
+   - parameter blue: The blue component, which is clamped to a value between 0.0 and 1.0.
+   */
+  public init(red: CGFloat, green: CGFloat, blue: CGFloat) {
+    self.red = min(max(red, 0), 1)
+    self.green = min(max(green, 0), 1)
+    self.blue = min(max(blue, 0), 1)
+  }
+
+  /**
+   Parses a RGB string into its components.
+
+   - parameter rgb: Supported formats are: (RRGGBB, #RRGGBB).
+   - returns: The parsed components, or nil if the string could not be parsed.
+   */
+  public init?(rgb: String) {
+    var rgbUpper = rgb.uppercased()
+
+    // Strip "#" if it exists
+    if rgbUpper.hasPrefix("#") {
+      let index = rgbUpper.index(after: rgbUpper.startIndex)
+      rgbUpper = String(rgbUpper[index...])
+    }
+
+    // Verify that the string contains 6 valid hexidecimal characters
+    let invalidCharacters = CharacterSet(charactersIn: "0123456789ABCDEF").inverted
+    guard rgbUpper.count == 6,
+      rgbUpper.rangeOfCharacter(from: invalidCharacters) == nil,
+      let rgbValue = UInt32(rgbUpper, radix: 16) else
+    {
+      return nil
+    }
+
+    self.init(
+      red: CGFloat((rgbValue & 0xFF0000) >> 16) / 255.0,
+      green: CGFloat((rgbValue & 0x00FF00) >> 8) / 255.0,
+      blue: CGFloat(rgbValue & 0x0000FF) / 255.0)
+  }
+
+  /**
+   Converts hue, saturation, and brightness values into their red, green, and blue components.
+
+   - parameter hue: The hue in degrees, which is clamped to a value between 0 and 360.
+   - parameter saturation: The saturation, which is clamped to a value between 0.0 and 1.0.
+   - parameter brightness: The brightness, which is clamped to a value between 0.0 and 1.0.
+   */
+  public init(hue: CGFloat, saturation: CGFloat, brightness: CGFloat) {
+    let h = (min(max(hue, 0), 360) / 60).truncatingRemainder(dividingBy: 6)
+    let s = min(max(saturation, 0), 1)
+    let v = min(max(brightness, 0), 1)
+
+    let sector = floor(h)
+    let fraction = h - sector
+    let p = v * (1 - s)
+    let q = v * (1 - s * fraction)
+    let t = v * (1 - s * (1 - fraction))
+
+    switch Int(sector) {
+    case 0: self.init(red: v, green: t, blue: p)
+    case 1: self.init(red: q, green: v, blue: p)
+    case 2: self.init(red: p, green: v, blue: t)
+    case 3: self.init(red: p, green: q, blue: v)
+    case 4: self.init(red: t, green: p, blue: v)
+    default: self.init(red: v, green: p, blue: q)
+    }
+  }
+
+  // MARK: - Equatable
+
+  public static func ==(lhs: ColorComponents, rhs: ColorComponents) -> Bool {
+    return lhs.red == rhs.red && lhs.green == rhs.green && lhs.blue == rhs.blue
+  }
+}
@@ -28,31 +28,12 @@ import Foundation
    - returns: A parsed RGB color, or nil if the string could not be parsed.
    */
   public static func makeColor(rgb: String, alpha: CGFloat = 1.0) -> UIColor? {
-    var rgbUpper = rgb.uppercased()
-
-    // Strip "#" if it exists
-    if rgbUpper.hasPrefix("#") {
-      let index = rgbUpper.index(after: rgbUpper.startIndex)
-      rgbUpper = String(rgbUpper[index...])
-    }
-
-    // Verify that the string contains 6 valid hexidecimal characters
-    let invalidCharacters = CharacterSet(charactersIn: "0123456789ABCDEF").inverted
-    if rgbUpper.count != 6 ||
-      rgbUpper.rangeOfCharacter(from: invalidCharacters) != nil {
+    guard let components = ColorComponents(rgb: rgb) else {
       return nil
     }
 
-    // Parse rgb as a hex value and return the color
-    let scanner = Scanner(string: rgbUpper)
-    var rgbValue: UInt32 = 0
-    scanner.scanHexInt32(&rgbValue)
-
     return UIColor(
-      red: CGFloat((rgbValue & 0xFF0000) >> 16) / 255.0,
-      green: CGFloat((rgbValue & 0x00FF00) >> 8) / 255.0,
-      blue: CGFloat(rgbValue & 0x0000FF) / 255.0,
-      alpha: alpha)
+      red: components.red, green: components.green, blue: components.blue, alpha: alpha)
   }
 
   /**
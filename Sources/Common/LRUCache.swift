@@ -0,0 +1,220 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ A cache that holds up to a fixed number of values. When the cache is full, the least recently used
+ value is evicted to make room for a new one.
+
+ Lookups, insertions and evictions are all O(1).
+
+ - note: This class is not thread-safe.
+ */
+internal final class LRUCache<Key: Hashable, Value> {
+  // MARK: - Properties
+
+  /// The maximum number of values held by the cache. Lowering this value immediately evicts the
+  /// least recently used values that no longer fit.
+  internal var capacity: Int {
+    didSet {
+      bky_assert(capacity > 0, message: "`capacity` must be positive.")
+      evictIfNeeded()
+    }
+  }
+
+  /// The number of values currently held by the cache.
+  internal var count: Int {
+    return _nodes.count
+  }
+
+  /// The number of lookups that found a value.
+  internal private(set) var hitCount = 0
+
+  /// The number of lookups that did not find a value.
+  internal private(set) var missCount = 0
+
+  /// The number of values that have been evicted to make room for other values.
+  internal private(set) var evictionCount = 0
+
+  /// The ratio of lookups that found a value, between `0` and `1`. This is `0` if there have been
+  /// no lookups.
+  internal var hitRate: Double {
+    let lookupCount = hitCount + missCount
+    return lookupCount > 0 ? Double(hitCount) / Double(lookupCount) : 0
+  }
+
+  /// Called with each value that is evicted to make room for other values. This isn't called for
+  /// values that are explicitly removed or replaced.
+  internal var evictionHandler: ((Key, Value) -> Void)?
+
+  /// Nodes for each key in the cache
+  private var _nodes = [Key: LRUCacheNode<Key, Value>]()
+
+  /// The most recently used node
+  private var _head: LRUCacheNode<Key, Value>?
+
+  /// The least recently used node
+  private var _tail: LRUCacheNode<Key, Value>?
+
+  // MARK: - Initializers
+
+  /**
+   Creates an empty cache.
+
+   - parameter capacity: The maximum number of values held by the cache.
+   */
+  internal init(capacity: Int) {
+    bky_assert(capacity > 0, message: "`capacity` must be positive.")
+    self.capacity = capacity
+  }
+
+  // MARK: - Public
+
+  /**
+   Returns the value for a key, and marks it as the most recently used value.
+
+   - parameter key: The key to look up.
+   - returns: The value for `key`, or `nil` if the cache does not contain it.
+   */
+  internal func value(forKey key: Key) -> Value? {
+    guard let node = _nodes[key] else {
+      missCount += 1
+      return nil
+    }
+
+    hitCount += 1
+    moveToHead(node)
+    return node.value
+  }
+
+  /**
+   Stores a value for a key as the most recently used value, evicting the least recently used
+   value if the cache is full.
+
+   - parameter value: The value to store.
+   - parameter key: The key of the value.
+   */
+  internal func setValue(_ value: Value, forKey key: Key) {
+    if let node = _nodes[key] {
+      node.value = value
+      moveToHead(node)
+      return
+    }
+
+    let node = LRUCacheNode(key: key, value: value)
+    _nodes[key] = node
+    insertAtHead(node)
+    evictIfNeeded()
+  }
+
+  /**
+   Removes the value for a key.
+
+   - parameter key: The key of the value to remove.
+   */
+  internal func removeValue(forKey key: Key) {
+    if let node = _nodes.removeValue(forKey: key) {
+      unlink(node)
+    }
+  }
+
+  /**
+   Removes all values from the cache. Statistics are not reset.
+   */
+  internal func removeAllValues() {
+    _nodes.removeAll()
+    // Break the links between nodes explicitly, to avoid a deeply recursive deinit
+    var node = _head
+    while let current = node {
+      node = current.next
+      current.next = nil
+    }
+    _head = nil
+    _tail = nil
+  }
+
+  /**
+   Resets `hitCount`, `missCount` and `evictionCount` to `0`.
+   */
+  internal func resetStatistics() {
+    hitCount = 0
+    missCount = 0
+    evictionCount = 0
+  }
+
+  // MARK: - Private
+
+  private func insertAtHead(_ node: LRUCacheNode<Key, Value>) {
+    node.previous = nil
+    node.next = _head
+    _head?.previous = node
+    _head = node
+
+    if _tail == nil {
+      _tail = node
+    }
+  }
+
+  private func unlink(_ node: LRUCacheNode<Key, Value>) {
+    if let previous = node.previous {
+      previous.next = node.next
+    } else {
+      _head = node.next
+    }
+
+    if let next = node.next {
+      next.previous = node.previous
+    } else {
+      _tail = node.previous
+    }
+
+    node.previous = nil
+    node.next = nil
+  }
+
+  private func moveToHead(_ node: LRUCacheNode<Key, Value>) {
+    if node !== _head {
+      unlink(node)
+      insertAtHead(node)
+    }
+  }
+
+  private func evictIfNeeded() {
+    while _nodes.count > capacity, let tail = _tail {
+      unlink(tail)
+      _nodes[tail.key] = nil
+      evictionCount += 1
+      evictionHandler?(tail.key, tail.value)
+    }
+  }
+}
+
+// MARK: - LRUCacheNode
+
+/**
+ A node in the doubly linked list used by `LRUCache` to order values by use.
+ */
+private final class LRUCacheNode<Key, Value> {
+  let key: Key
+  var value: Value
+  weak var previous: LRUCacheNode<Key, Value>?
+  var next: LRUCacheNode<Key, Value>?
+
+  init(key: Key, value: Value) {
+    self.key = key
+    self.value = value
+  }
+}
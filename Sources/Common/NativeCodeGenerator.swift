@@ -0,0 +1,436 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Generates code by walking the `Block` model directly, using block generators written in Swift.
+
+ This is a native alternative to `CodeGenerator`, which has to load Blockly's JS engine into a
+ `WKWebView`. It mirrors the generator API of web Blockly:
+
+ - Each block type is assigned a generator closure (see `setGenerator(forBlockType:_:)`), which
+ returns either a statement or a value (along with the operator precedence of the value).
+ - Generator closures build their code using helpers like `valueCode(for:inputName:outerOrder:)`,
+ `statementCode(for:inputName:)` and `prefixLines(_:with:)`.
+ - Shared helper code (eg. function definitions) can be added via `addDefinition(_:forName:)`, and
+ is prepended to the generated code.
+
+ Since it doesn't depend on UIKit or WebKit, a `NativeCodeGenerator` can generate code on any
+ thread, as long as the blocks being walked are not modified at the same time.
+
+ To use it with `CodeGeneratorService`, create a request builder with
+ `CodeGeneratorServiceRequestBuilder(nativeGenerator:blockFactory:)`.
+
+ - note: Code generation calls on the same instance are serialized internally, since definitions
+ are tracked per generation.
+ */
+@objc(BKYNativeCodeGenerator)
+@objcMembers open class NativeCodeGenerator: NSObject {
+  // MARK: - Enums
+
+  /**
+   The code generated for a single block.
+   */
+  public enum Output {
+    /// Code for a statement block, which does not include code for its next blocks.
+    case statement(String)
+    /// Code for a value block, along with the operator precedence of its outermost operation.
+    case value(String, order: Int)
+  }
+
+  // MARK: - Closures
+
+  /**
+   Closure that generates code for a block.
+
+   - parameter block: The block to generate code for.
+   - parameter generator: The generator that is generating code.
+   - returns: The code for the block.
+   - throws:
+   `Error`: Thrown if code could not be generated for the block.
+   */
+  public typealias BlockGeneratorClosure =
+    (_ block: Block, _ generator: NativeCodeGenerator) throws -> Output
+
+  /**
+   Closure that formats the code of a value block that is not plugged into anything (eg. a
+   top-level value block).
+
+   - parameter code: The code of the value block.
+   - returns: The formatted code.
+   */
+  public typealias NakedValueClosure = (_ code: String) -> String
+
+  // MARK: - Properties
+
+  /// The name of the generated language (eg. "Python"), used to identify this generator.
+  public let name: String
+
+  /// The indentation used for nested statements.
+  public var indent = "  "
+
+  /// The operator precedence of atomic values (eg. literals), which never need parentheses.
+  public var atomicOrder = 0
+
+  /// The operator precedence used when no precedence applies, which never adds parentheses.
+  public var noneOrder = 99
+
+  /// Formats the code of value blocks that are not plugged into anything. By default, a newline is
+  /// appended to the code.
+  public var nakedValueFormatter: NakedValueClosure = { code in
+    return code + "\n"
+  }
+
+  /// Generator closures, indexed by block type.
+  fileprivate var _blockGenerators = [String: BlockGeneratorClosure]()
+
+  /// Definitions that have been added during the current generation, indexed by name.
+  fileprivate var _definitions = [String: String]()
+
+  /// The names of `_definitions`, in the order they were added.
+  fileprivate var _definitionNames = [String]()
+
+  /// Lock that serializes code generation calls.
+  fileprivate let _lock = NSRecursiveLock()
+
+  // MARK: - Initializers
+
+  /**
+   Creates a native code generator.
+
+   - parameter name: The name of the generated language (eg. "Python").
+   */
+  public init(name: String) {
+    self.name = name
+    super.init()
+  }
+
+  // MARK: - Generators
+
+  /**
+   Sets the generator closure for a block type.
+
+   - parameter blockType: The block type (ie. `Block.name`).
+   - parameter generator: The closure that generates code for blocks of this type.
+   */
+  public func setGenerator(
+    forBlockType blockType: String, _ generator: @escaping BlockGeneratorClosure)
+  {
+    _lock.lock()
+    defer { _lock.unlock() }
+    _blockGenerators[blockType] = generator
+  }
+
+  /**
+   Returns whether a generator closure has been set for a block type.
+
+   - parameter blockType: The block type (ie. `Block.name`).
+   - returns: `true` if a generator exists for `blockType`, `false` otherwise.
+   */
+  public func hasGenerator(forBlockType blockType: String) -> Bool {
+    _lock.lock()
+    defer { _lock.unlock() }
+    return _blockGenerators[blockType] != nil
+  }
+
+  // MARK: - Code Generation
+
+  /**
+   Generates code for all top-level blocks in a workspace.
+
+   - parameter workspace: The workspace to generate code for.
+   - returns: The generated code.
+   - throws:
+   `BlocklyError`: Thrown if no generator exists for a block, or if a generator failed.
+   */
+  public func code(for workspace: Workspace) throws -> String {
+    return try code(forTopLevelBlocks: workspace.topLevelBlocks())
+  }
+
+  /**
+   Generates code for a list of top-level blocks. Blocks are ordered by their position (top to
+   bottom, then left to right), like in web Blockly.
+
+   - parameter blocks: The top-level blocks to generate code for.
+   - returns: The generated code.
+   - throws:
+   `BlocklyError`: Thrown if no generator exists for a block, or if a generator failed.
+   */
+  public func code(forTopLevelBlocks blocks: [Block]) throws -> String {
+    let fragments = try NativeCodeGenerator.sortedByPosition(blocks).map {
+      try fragment(forTopLevelBlock: $0)
+    }
+    return NativeCodeGenerator.stitch(fragments)
+  }
+
+  /**
+   Generates code for a block and all blocks connected after it. Any definitions that were added
+   during generation are prepended to the code.
+
+   - parameter block: The block to generate code for.
+   - returns: The generated code.
+   - throws:
+   `BlocklyError`: Thrown if no generator exists for a block, or if a generator failed.
+   */
+  public func code(forTopLevelBlock block: Block) throws -> String {
+    return try code(forTopLevelBlocks: [block])
+  }
+
+  // MARK: - Generator Helpers
+
+  /**
+   Generates code for a block. For statement blocks, this includes the code of all blocks connected
+   after it. Disabled blocks are skipped.
+
+   This should only be called from inside a generator closure.
+
+   - parameter block: The block to generate code for.
+   - returns: The code for the block, or `nil` if `block` is `nil`, or if it is disabled and has
+   no next block.
+   - throws:
+   `BlocklyError`: Thrown if no generator exists for a block, or if a generator failed.
+   */
+  public func output(for block: Block?) throws -> Output? {
+    guard let block = block else {
+      return nil
+    }
+    if block.disabled {
+      // Skip to the next block
+      return try output(for: block.nextBlock ?? block.nextShadowBlock)
+    }
+
+    guard let generator = _blockGenerators[block.name] else {
+      throw BlocklyError(.codeGeneration,
+        "\(name) generator does not know how to generate code for block type \"\(block.name)\".")
+    }
+
+    switch try generator(block, self) {
+    case .value(let code, let order):
+      return .value(code, order: order)
+    case .statement(let code):
+      var code = code
+      if let nextBlock = block.nextBlock ?? block.nextShadowBlock,
+        case .statement(let nextCode)? = try output(for: nextBlock)
+      {
+        code += nextCode
+      }
+      return .statement(code)
+    }
+  }
+
+  /**
+   Generates code for the value block connected to a given input, wrapping it in parentheses if its
+   precedence is weaker than (or equal to) `outerOrder`.
+
+   - parameter block: The block containing the input.
+   - parameter inputName: The name of the input.
+   - parameter outerOrder: The precedence of the operation that the value is used in.
+   - returns: The code of the value, or an empty string if nothing is connected to the input.
+   - throws:
+   `BlocklyError`: Thrown if a statement block is connected to the input, if no generator exists
+   for a block, or if a generator failed.
+   */
+  public func valueCode(for block: Block, inputName: String, outerOrder: Int) throws -> String {
+    guard let input = block.firstInput(withName: inputName),
+      let output = try output(for: input.connectedBlock ?? input.connectedShadowBlock) else
+    {
+      return ""
+    }
+    guard case let .value(code, innerOrder) = output else {
+      throw BlocklyError(.codeGeneration,
+        "Expected a value block in input \"\(inputName)\" of block \"\(block.name)\".")
+    }
+
+    return parenthesize(code, innerOrder: innerOrder, outerOrder: outerOrder)
+  }
+
+  /**
+   Generates code for the statement blocks connected to a given input, indenting every line by
+   `indent`.
+
+   - parameter block: The block containing the input.
+   - parameter inputName: The name of the input.
+   - returns: The code of the statements, or an empty string if nothing is connected to the input.
+   - throws:
+   `BlocklyError`: Thrown if a value block is connected to the input, if no generator exists for a
+   block, or if a generator failed.
+   */
+  public func statementCode(for block: Block, inputName: String) throws -> String {
+    guard let input = block.firstInput(withName: inputName),
+      let output = try output(for: input.connectedBlock ?? input.connectedShadowBlock) else
+    {
+      return ""
+    }
+    guard case let .statement(code) = output else {
+      throw BlocklyError(.codeGeneration,
+        "Expected a statement block in input \"\(inputName)\" of block \"\(block.name)\".")
+    }
+
+    return prefixLines(code, with: indent)
+  }
+
+  /**
+   Wraps code in parentheses, if the precedence of its outermost operation is weaker than (or equal
+   to) the precedence of the operation it is used in.
+
+   - parameter code: The code to wrap.
+   - parameter innerOrder: The precedence of the outermost operation in `code`.
+   - parameter outerOrder: The precedence of the operation that `code` is used in.
+   - returns: The (possibly) wrapped code.
+   */
+  public func parenthesize(_ code: String, innerOrder: Int, outerOrder: Int) -> String {
+    if code.isEmpty || outerOrder > innerOrder {
+      return code
+    }
+    if outerOrder == innerOrder && (outerOrder == atomicOrder || outerOrder == noneOrder) {
+      // Atomic values and values without any precedence never need parentheses
+      return code
+    }
+    return "(" + code + ")"
+  }
+
+  /**
+   Adds a prefix to every non-empty line of code.
+
+   - parameter code: The code to prefix.
+   - parameter prefix: The prefix to add (eg. `indent`).
+   - returns: The prefixed code.
+   */
+  public func prefixLines(_ code: String, with prefix: String) -> String {
+    if code.isEmpty || prefix.isEmpty {
+      return code
+    }
+
+    var result = ""
+    var atLineStart = true
+    for character in code {
+      if atLineStart && character != "\n" {
+        result.append(prefix)
+      }
+      result.append(character)
+      atLineStart = (character == "\n")
+    }
+    return result
+  }
+
+  /**
+   Adds helper code that should be prepended to the generated code (eg. a function definition).
+   Adding a definition with a name that has already been added during the current generation does
+   nothing.
+
+   This should only be called from inside a generator closure.
+
+   - parameter code: The helper code.
+   - parameter name: The name identifying the definition.
+   */
+  public func addDefinition(_ code: String, forName name: String) {
+    if _definitions[name] == nil {
+      _definitions[name] = code
+      _definitionNames.append(name)
+    }
+  }
+
+  // MARK: - Internal
+
+  /**
+   The code generated for a single top-level block, along with the definitions it requires.
+   */
+  internal struct Fragment {
+    /// The code of the top-level block (and all blocks connected to it).
+    let code: String
+    /// The definitions that were added while generating `code`, in the order they were added.
+    let definitions: [(name: String, code: String)]
+  }
+
+  /**
+   Generates code for a single top-level block, without prepending its definitions.
+
+   - parameter block: The top-level block.
+   - returns: The code of the block, along with its definitions.
+   - throws:
+   `BlocklyError`: Thrown if no generator exists for a block, or if a generator failed.
+   */
+  internal func fragment(forTopLevelBlock block: Block) throws -> Fragment {
+    _lock.lock()
+    defer {
+      _definitions.removeAll()
+      _definitionNames.removeAll()
+      _lock.unlock()
+    }
+
+    _definitions.removeAll()
+    _definitionNames.removeAll()
+
+    let code: String
+    switch try output(for: block) {
+    case .value(let valueCode, _)?:
+      code = nakedValueFormatter(valueCode)
+    case .statement(let statementCode)?:
+      code = statementCode
+    case nil:
+      code = ""
+    }
+
+    var definitions = [(name: String, code: String)]()
+    for name in _definitionNames {
+      if let definitionCode = _definitions[name] {
+        definitions.append((name: name, code: definitionCode))
+      }
+    }
+    return Fragment(code: code, definitions: definitions)
+  }
+
+  /**
+   Joins fragments together, in order, prepending the definitions of all fragments. Definitions
+   that share the same name are only included once.
+
+   - parameter fragments: The fragments to join.
+   - returns: The finished code.
+   */
+  internal static func stitch(_ fragments: [Fragment]) -> String {
+    var definitionNames = Set<String>()
+    var definitions = [String]()
+    var code = ""
+
+    for fragment in fragments {
+      for definition in fragment.definitions where !definitionNames.contains(definition.name) {
+        definitionNames.insert(definition.name)
+        definitions.append(definition.code)
+      }
+      code += fragment.code
+    }
+
+    if definitions.isEmpty {
+      return code
+    }
+    return definitions.joined(separator: "\n\n") + "\n\n" + code
+  }
+
+  /**
+   Sorts blocks by their position (top to bottom, then left to right).
+
+   - parameter blocks: The blocks to sort.
+   - returns: The sorted blocks.
+   */
+  internal static func sortedByPosition(_ blocks: [Block]) -> [Block] {
+    return blocks.sorted { block1, block2 in
+      if block1.position.y != block2.position.y {
+        return block1.position.y < block2.position.y
+      }
+      return block1.position.x < block2.position.x
+    }
+  }
+}
@@ -34,14 +34,69 @@ public protocol Recyclable: class {
 
 /**
 Handles the management of recyclable objects.
+
+Recycled objects are kept in a free list per type, keyed by the type's `ObjectIdentifier`. Each
+free list holds at most `capacity(forType:)` objects. Objects recycled beyond that capacity are
+discarded and counted as evictions. All free lists are emptied when the app receives a memory
+warning.
+
+- note: This class is not thread-safe and should only be accessed from the main thread.
 */
 @objc(BKYObjectPool)
 @objcMembers public final class ObjectPool: NSObject {
+  // MARK: - Constants
+
+  /// The default maximum number of recycled objects kept for each type.
+  public static let DefaultCapacityPerType = 512
+
   // MARK: - Properties
 
-  /// Keeps track of all recycled objects. Objects of the same type are keyed by their class name
-  /// and stored in a cache.
-  private let _recycledObjects = NSCache<NSString, NSMutableArray>()
+  /// The maximum number of recycled objects kept for types that don't have a specific capacity set
+  /// through `setCapacity(_:forType:)`. Lowering this value immediately discards objects that no
+  /// longer fit.
+  public var defaultCapacity = ObjectPool.DefaultCapacityPerType {
+    didSet {
+      for key in _freeLists.keys where _capacities[key] == nil {
+        trimFreeList(forKey: key)
+      }
+    }
+  }
+
+  /// Statistics for all types combined.
+  public var statistics: ObjectPoolStatistics {
+    var total = ObjectPoolStatistics()
+    for statistics in _statistics.values {
+      total.hitCount += statistics.hitCount
+      total.missCount += statistics.missCount
+      total.evictionCount += statistics.evictionCount
+      total.prewarmCount += statistics.prewarmCount
+    }
+    total.recycledObjectCount = _freeLists.values.reduce(0) { $0 + $1.count }
+    return total
+  }
+
+  /// Recycled objects for each type
+  private var _freeLists = [ObjectIdentifier: [AnyObject]]()
+
+  /// Capacities that have been set for specific types
+  private var _capacities = [ObjectIdentifier: Int]()
+
+  /// Statistics for each type
+  private var _statistics = [ObjectIdentifier: ObjectPoolStatistics]()
+
+  // MARK: - Initializers
+
+  public override init() {
+    super.init()
+
+    NotificationCenter.default.addObserver(
+      self, selector: #selector(didReceiveMemoryWarning(_:)),
+      name: .UIApplicationDidReceiveMemoryWarning, object: nil)
+  }
+
+  deinit {
+    NotificationCenter.default.removeObserver(self)
+  }
 
   // MARK: - Public
 
@@ -50,27 +105,26 @@ Handles the management of recyclable objects.
 
   If not, a new object of the given type is instantiated.
 
-
   - parameter type: The `Type` of object to retrieve.
   - note: Objects obtained through this method should be recycled through `recycleObject(:)`.
   - returns: An object of the given `type`.
   */
   public func object<T>(forType type: T.Type) -> T where T: NSObject {
-    let className = String(describing: type) as NSString
+    let key = ObjectIdentifier(type)
 
-    if let list = _recycledObjects.object(forKey: className), list.count > 0,
-      let recycledObject = list.lastObject as? T
-    {
-      list.removeLastObject()
+    if let recycledObject = _freeLists[key]?.popLast() as? T {
+      _statistics[key, default: ObjectPoolStatistics()].hitCount += 1
       return recycledObject
     }
 
     // Couldn't find a recycled object, create a new instance
+    _statistics[key, default: ObjectPoolStatistics()].missCount += 1
     return type.init()
   }
 
   /**
-   Calls `prepareForReuse()` on the object and stores it for re-use later.
+   Calls `prepareForReuse()` on the object and stores it for re-use later. If the pool already
+   holds `capacity(forType:)` objects of the same type, the object is discarded instead.
 
    - parameter object: The object to recycle.
    - note: Objects recycled through this method should be obtained through `objectForType(:)` or
@@ -80,23 +134,156 @@ Handles the management of recyclable objects.
     // Prepare the object for re-use
     object.prepareForReuse()
 
-    let className = String(describing: type(of: object)) as NSString
+    let key = ObjectIdentifier(type(of: object))
 
-    if let list = _recycledObjects.object(forKey: className) {
-      // Append to the array
-      list.add(object)
+    if _freeLists[key, default: []].count < capacity(forKey: key) {
+      _freeLists[key, default: []].append(object)
     } else {
-      // Create a new array. Because the array will be constantly changing, it is faster to use an
-      // NSMutableArray instead of an Array<Recyclable> here, as any changes to the array will be
-      // made by reference instead of by value.
-      _recycledObjects.setObject(NSMutableArray(array: [object]), forKey: className)
+      _statistics[key, default: ObjectPoolStatistics()].evictionCount += 1
     }
   }
 
+  /**
+   Creates new objects of a given type and stores them for re-use later, until the pool holds
+   `count` recycled objects of that type (or `capacity(forType:)`, whichever is lower).
+
+   This is useful for creating objects ahead of time (eg. views, while the app is idle), so they
+   don't need to be created when they're needed.
+
+   - parameter type: The `Type` of object to create.
+   - parameter count: The number of recycled objects the pool should hold for `type`.
+   */
+  public func prewarm<T>(_ type: T.Type, count: Int) where T: NSObject, T: Recyclable {
+    let key = ObjectIdentifier(type)
+    let createCount = min(count, capacity(forKey: key)) - (_freeLists[key]?.count ?? 0)
+    guard createCount > 0 else {
+      return
+    }
+
+    for _ in 0 ..< createCount {
+      _freeLists[key, default: []].append(type.init())
+    }
+    _statistics[key, default: ObjectPoolStatistics()].prewarmCount += createCount
+  }
+
+  /**
+   Sets the maximum number of recycled objects kept for a given type. If the pool currently holds
+   more objects than this for the type, the excess objects are discarded.
+
+   - parameter capacity: The maximum number of recycled objects.
+   - parameter type: The `Type` of object.
+   */
+  public func setCapacity(_ capacity: Int, forType type: AnyClass) {
+    let key = ObjectIdentifier(type)
+    _capacities[key] = max(capacity, 0)
+    trimFreeList(forKey: key)
+  }
+
+  /**
+   Removes the capacity that was set for a given type, so it uses `defaultCapacity` again.
+
+   - parameter type: The `Type` of object.
+   */
+  public func resetCapacity(forType type: AnyClass) {
+    let key = ObjectIdentifier(type)
+    _capacities[key] = nil
+    trimFreeList(forKey: key)
+  }
+
+  /**
+   Returns the maximum number of recycled objects kept for a given type.
+
+   - parameter type: The `Type` of object.
+   - returns: The capacity for `type`.
+   */
+  public func capacity(forType type: AnyClass) -> Int {
+    return capacity(forKey: ObjectIdentifier(type))
+  }
+
+  /**
+   Returns the number of recycled objects currently held for a given type.
+
+   - parameter type: The `Type` of object.
+   - returns: The number of recycled objects held for `type`.
+   */
+  public func recycledObjectCount(forType type: AnyClass) -> Int {
+    return _freeLists[ObjectIdentifier(type)]?.count ?? 0
+  }
+
+  /**
+   Returns statistics for a given type.
+
+   - parameter type: The `Type` of object.
+   - returns: Statistics for `type`.
+   */
+  public func statistics(forType type: AnyClass) -> ObjectPoolStatistics {
+    let key = ObjectIdentifier(type)
+    var statistics = _statistics[key] ?? ObjectPoolStatistics()
+    statistics.recycledObjectCount = _freeLists[key]?.count ?? 0
+    return statistics
+  }
+
+  /**
+   Resets the hit, miss, eviction and prewarm counts for all types.
+   */
+  public func resetStatistics() {
+    _statistics.removeAll()
+  }
+
   /**
    Removes all recycled objects from memory.
    */
   public func removeAllRecycledObjects() {
-    _recycledObjects.removeAllObjects()
+    _freeLists.removeAll()
+  }
+
+  // MARK: - Private
+
+  private func capacity(forKey key: ObjectIdentifier) -> Int {
+    return _capacities[key] ?? max(defaultCapacity, 0)
+  }
+
+  private func trimFreeList(forKey key: ObjectIdentifier) {
+    guard let count = _freeLists[key]?.count else {
+      return
+    }
+
+    let excess = count - capacity(forKey: key)
+    if excess > 0 {
+      _freeLists[key]?.removeFirst(excess)
+      _statistics[key, default: ObjectPoolStatistics()].evictionCount += excess
+    }
+  }
+
+  @objc private dynamic func didReceiveMemoryWarning(_ notification: Notification) {
+    removeAllRecycledObjects()
+  }
+}
+
+// MARK: - Object Pool Statistics
+
+/**
+ Statistics for the objects of an `ObjectPool`.
+ */
+public struct ObjectPoolStatistics {
+  /// The number of objects that were served from a free list
+  public internal(set) var hitCount: Int = 0
+
+  /// The number of objects that had to be created because no recycled object was available
+  public internal(set) var missCount: Int = 0
+
+  /// The number of recycled objects that were discarded because a free list was full
+  public internal(set) var evictionCount: Int = 0
+
+  /// The number of objects that were created by `ObjectPool.prewarm(_:count:)`
+  public internal(set) var prewarmCount: Int = 0
+
+  /// The number of recycled objects currently held by the pool
+  public internal(set) var recycledObjectCount: Int = 0
+
+  /// The ratio of requested objects that were served from a free list, between `0` and `1`
+  public var hitRate: Double {
+    let requestCount = hitCount + missCount
+    return requestCount > 0 ? Double(hitCount) / Double(requestCount) : 0
   }
 }
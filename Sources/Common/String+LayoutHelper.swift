@@ -17,6 +17,8 @@ import Foundation
 
 /**
 Contains methods to help measure how Strings will render in the UI.
+
+- note: Measurements are performed by `TextMeasurement.measurer`.
 */
 extension String {
   /**
@@ -32,13 +34,13 @@ extension String {
   public func bky_multiLineSizeWithAttributes(
     _ attributes: [NSAttributedStringKey : Any]?, constrainedToWidth width: CGFloat) -> CGSize
   {
-    let boundingBox = self.boundingRect(with: CGSize(width: width, height: CGFloat(MAXFLOAT)),
-      options: NSStringDrawingOptions.usesLineFragmentOrigin,
-      attributes: attributes,
-      context: nil)
+    if let font = attributes?[NSAttributedStringKey.font] as? UIFont, attributes?.count == 1 {
+      // Only a font was specified, so the configured measurer can be used.
+      return TextMeasurement.measurer.multiLineSize(of: self, font: font, constrainedToWidth: width)
+    }
 
-    // Use ceiling since you can't split a pixel
-    return CGSize(width: ceil(boundingBox.size.width), height: ceil(boundingBox.size.height))
+    return BoundingRectTextMeasurer().multiLineSize(
+      of: self, attributes: attributes, constrainedToWidth: width)
   }
 
   /**
@@ -51,8 +53,7 @@ extension String {
   */
   public func bky_multiLineSize(forFont font: UIFont, constrainedToWidth width: CGFloat) -> CGSize
   {
-    let attributes = [NSAttributedStringKey.font: font]
-    return self.bky_multiLineSizeWithAttributes(attributes, constrainedToWidth: width)
+    return TextMeasurement.measurer.multiLineSize(of: self, font: font, constrainedToWidth: width)
   }
 
   /**
@@ -63,14 +64,6 @@ extension String {
    - returns: The size required to render the string.
    */
   public func bky_singleLineSize(forFont font: UIFont) -> CGSize {
-    let attributes = [NSAttributedStringKey.font: font]
-    let boundingBox = self.boundingRect(
-      with: CGSize(width: CGFloat(MAXFLOAT), height: CGFloat(MAXFLOAT)),
-      options: NSStringDrawingOptions.usesLineFragmentOrigin,
-      attributes: attributes,
-      context: nil)
-
-    // Return ceiling since you can't split a pixel
-    return CGSize(width: ceil(boundingBox.size.width), height: ceil(boundingBox.size.height))
+    return TextMeasurement.measurer.singleLineSize(of: self, font: font)
   }
 }
@@ -0,0 +1,371 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Describes a font for the purposes of text measurement, without depending on a platform font class
+ (eg. `UIFont`).
+
+ Two fonts are equal if they have the same name, point size and traits.
+ */
+public final class TextMeasurementFont: Hashable {
+  // MARK: - Structs
+
+  /**
+   The stylistic traits of a font.
+   */
+  public struct Traits: OptionSet {
+    public let rawValue: Int
+
+    public init(rawValue: Int) {
+      self.rawValue = rawValue
+    }
+
+    /// The font is bold.
+    public static let bold = Traits(rawValue: 1 << 0)
+    /// The font is italic.
+    public static let italic = Traits(rawValue: 1 << 1)
+    /// Every glyph of the font has the same width.
+    public static let monospace = Traits(rawValue: 1 << 2)
+  }
+
+  // MARK: - Properties
+
+  /// The name of the font (eg. its PostScript name).
+  public let name: String
+  /// The point size of the font.
+  public let pointSize: CGFloat
+  /// The stylistic traits of the font.
+  public let traits: Traits
+  /// The platform font that this font was created from, if any. Platform measurers can use this
+  /// instead of looking the font up again. This is not considered for equality.
+  internal let platformFont: AnyObject?
+
+  // MARK: - Initializers
+
+  /**
+   Initializes the font.
+
+   - parameter name: The name of the font (eg. its PostScript name).
+   - parameter pointSize: The point size of the font.
+   - parameter traits: The stylistic traits of the font.
+   */
+  public convenience init(name: String, pointSize: CGFloat, traits: Traits = []) {
+    self.init(name: name, pointSize: pointSize, traits: traits, platformFont: nil)
+  }
+
+  internal init(name: String, pointSize: CGFloat, traits: Traits, platformFont: AnyObject?) {
+    self.name = name
+    self.pointSize = pointSize
+    self.traits = traits
+    self.platformFont = platformFont
+  }
+
+  // MARK: - Hashable
+
+  public var hashValue: Int {
+    return name.hashValue ^ pointSize.hashValue &* 31 ^ traits.rawValue &* 17
+  }
+
+  public static func ==(lhs: TextMeasurementFont, rhs: TextMeasurementFont) -> Bool {
+    return lhs.name == rhs.name && lhs.pointSize == rhs.pointSize && lhs.traits == rhs.traits
+  }
+}
+
+/**
+ Protocol for measuring how much space text will occupy when it is rendered.
+
+ All text measurement performed by the layout system (eg. when measuring field layouts) is routed
+ through `TextMeasurement.measurer`, so it can be swapped out for an implementation that does not
+ depend on the platform's text rendering engine. Fonts are described by `TextMeasurementFont`, so
+ implementations don't need to depend on UIKit.
+ */
+public protocol TextMeasurer: class {
+  /**
+   Computes the size of the bounding box that would be needed to render text using a given font,
+   on a single line.
+
+   - parameter text: The text to measure.
+   - parameter font: The font used to render the text.
+   - returns: The size required to render the text.
+   */
+  func singleLineSize(of text: String, font: TextMeasurementFont) -> CGSize
+
+  /**
+   Computes the size of the bounding box that would be needed to render text using a given font,
+   constrained to a maximum width.
+
+   - parameter text: The text to measure.
+   - parameter font: The font used to render the text.
+   - parameter width: The maximum width the text can occupy when rendered.
+   - returns: The size required to render the text.
+   */
+  func multiLineSize(
+    of text: String, font: TextMeasurementFont, constrainedToWidth width: CGFloat) -> CGSize
+}
+
+/**
+ Holds the `TextMeasurer` used throughout the library.
+ */
+public final class TextMeasurement {
+  /**
+   The measurer used for all text measurement. Defaults to a `CachingTextMeasurer` wrapping a
+   `BoundingRectTextMeasurer`. Swift packages (which don't include UIKit text rendering) default to
+   wrapping a `FixedMetricsTextMeasurer` instead.
+
+   - note: This should be set before any layouts are created, since existing layouts are not
+   re-measured when this value changes.
+   */
+  #if SWIFT_PACKAGE
+  public static var measurer: TextMeasurer =
+    CachingTextMeasurer(measurer: FixedMetricsTextMeasurer())
+  #else
+  public static var measurer: TextMeasurer =
+    CachingTextMeasurer(measurer: BoundingRectTextMeasurer())
+  #endif
+
+  /**
+   Discards all cached measurements, if `measurer` is a `CachingTextMeasurer`. This should be
+   called whenever fonts change in a way that isn't reflected by their font descriptor (eg. after
+   registering a new font file under an existing font name).
+   */
+  public static func removeAllCachedMeasurements() {
+    (measurer as? CachingTextMeasurer)?.removeAllMeasurements()
+  }
+}
+
+/**
+ Measures text using another `TextMeasurer`, caching the results of the most recently used
+ measurements.
+
+ Measurements are keyed by the text, the font and the width constraint. Since fonts are created
+ for a specific scale (see `LayoutConfig.font(for:)`), the scale of a measurement is part of its
+ font's point size. This makes the cache effective for
+ labels that are measured repeatedly (eg. "repeat", "do" and "if"), across every type of field
+ layout, during workspace loads and zoom changes.
+
+ When built with UIKit, the cache is cleared automatically when the preferred content size
+ category of the app changes.
+
+ - note: This class is not thread-safe and should only be used from the main thread.
+ */
+public final class CachingTextMeasurer: TextMeasurer {
+  // MARK: - Constants
+
+  /// The default maximum number of cached measurements.
+  public static let DefaultCapacity = 2048
+
+  // MARK: - Properties
+
+  /// The measurer that performs measurements that aren't cached.
+  public let measurer: TextMeasurer
+
+  /// The maximum number of cached measurements. When the cache is full, the least recently used
+  /// measurement is evicted.
+  public var capacity: Int {
+    get { return _cache.capacity }
+    set { _cache.capacity = max(newValue, 1) }
+  }
+
+  /// The number of measurements currently cached.
+  public var cachedMeasurementCount: Int {
+    return _cache.count
+  }
+
+  /// The number of measurements that were served from the cache.
+  public var hitCount: Int {
+    return _cache.hitCount
+  }
+
+  /// The number of measurements that had to be performed by `self.measurer`.
+  public var missCount: Int {
+    return _cache.missCount
+  }
+
+  /// The number of cached measurements that were evicted to make room for other measurements.
+  public var evictionCount: Int {
+    return _cache.evictionCount
+  }
+
+  /// The ratio of measurements that were served from the cache, between `0` and `1`.
+  public var hitRate: Double {
+    return _cache.hitRate
+  }
+
+  /// The cached measurements
+  fileprivate let _cache: LRUCache<MeasurementKey, CGSize>
+
+  /// The observer of content size category changes
+  private var _contentSizeCategoryObserver: NSObjectProtocol?
+
+  // MARK: - Initializers
+
+  /**
+   Initializes the measurer.
+
+   - parameter measurer: The measurer that performs measurements that aren't cached.
+   - parameter capacity: The maximum number of cached measurements.
+   */
+  public init(measurer: TextMeasurer, capacity: Int = CachingTextMeasurer.DefaultCapacity) {
+    self.measurer = measurer
+    _cache = LRUCache(capacity: max(capacity, 1))
+
+    #if !SWIFT_PACKAGE
+    _contentSizeCategoryObserver = NotificationCenter.default.addObserver(
+      forName: .UIContentSizeCategoryDidChange, object: nil, queue: nil) { [weak self] _ in
+        self?.removeAllMeasurements()
+      }
+    #endif
+  }
+
+  deinit {
+    if let observer = _contentSizeCategoryObserver {
+      NotificationCenter.default.removeObserver(observer)
+    }
+  }
+
+  // MARK: - Public
+
+  /**
+   Discards all cached measurements.
+   */
+  public func removeAllMeasurements() {
+    _cache.removeAllValues()
+  }
+
+  /**
+   Resets `hitCount`, `missCount` and `evictionCount` to `0`.
+   */
+  public func resetStatistics() {
+    _cache.resetStatistics()
+  }
+
+  // MARK: - TextMeasurer
+
+  public func singleLineSize(of text: String, font: TextMeasurementFont) -> CGSize {
+    let key = MeasurementKey(text: text, font: font, width: nil)
+    if let size = _cache.value(forKey: key) {
+      return size
+    }
+
+    let size = measurer.singleLineSize(of: text, font: font)
+    _cache.setValue(size, forKey: key)
+    return size
+  }
+
+  public func multiLineSize(
+    of text: String, font: TextMeasurementFont, constrainedToWidth width: CGFloat) -> CGSize
+  {
+    let key = MeasurementKey(text: text, font: font, width: width)
+    if let size = _cache.value(forKey: key) {
+      return size
+    }
+
+    let size = measurer.multiLineSize(of: text, font: font, constrainedToWidth: width)
+    _cache.setValue(size, forKey: key)
+    return size
+  }
+}
+
+// MARK: - MeasurementKey
+
+extension CachingTextMeasurer {
+  /// Identifies a single measurement.
+  fileprivate struct MeasurementKey: Hashable {
+    let text: String
+    let font: TextMeasurementFont
+    /// The width constraint, or `nil` for single-line measurements
+    let width: CGFloat?
+
+    var hashValue: Int {
+      return text.hashValue ^ font.hashValue &* 31 ^ (width?.hashValue ?? 0) &* 17
+    }
+
+    static func ==(lhs: MeasurementKey, rhs: MeasurementKey) -> Bool {
+      return lhs.width == rhs.width && lhs.text == rhs.text && lhs.font == rhs.font
+    }
+  }
+}
+
+/**
+ Measures text using fixed metrics derived from the font's point size, without consulting the
+ platform's text rendering engine.
+
+ Every character is treated as being `characterWidthRatio * font.pointSize` wide, and every line
+ as being `lineHeightRatio * font.pointSize` tall. Results are deterministic across devices and OS
+ versions, which makes this measurer useful for batch processing (eg. validating or laying out many
+ workspaces) and for tests, where exact glyph metrics are not important.
+ */
+public final class FixedMetricsTextMeasurer: TextMeasurer {
+  // MARK: - Properties
+
+  /// The width of each character, as a ratio of the font's point size.
+  public let characterWidthRatio: CGFloat
+
+  /// The height of each line, as a ratio of the font's point size.
+  public let lineHeightRatio: CGFloat
+
+  // MARK: - Initializers
+
+  /**
+   Initializes the measurer.
+
+   - parameter characterWidthRatio: The width of each character, as a ratio of the font's point
+   size.
+   - parameter lineHeightRatio: The height of each line, as a ratio of the font's point size.
+   */
+  public init(characterWidthRatio: CGFloat = 0.6, lineHeightRatio: CGFloat = 1.2) {
+    self.characterWidthRatio = characterWidthRatio
+    self.lineHeightRatio = lineHeightRatio
+  }
+
+  // MARK: - TextMeasurer
+
+  public func singleLineSize(of text: String, font: TextMeasurementFont) -> CGSize {
+    let characterWidth = characterWidthRatio * font.pointSize
+    let lineHeight = lineHeightRatio * font.pointSize
+    let lines = text.components(separatedBy: .newlines)
+    let longestLine = lines.reduce(0) { max($0, $1.count) }
+
+    return CGSize(
+      width: ceil(CGFloat(longestLine) * characterWidth),
+      height: ceil(CGFloat(lines.count) * lineHeight))
+  }
+
+  public func multiLineSize(
+    of text: String, font: TextMeasurementFont, constrainedToWidth width: CGFloat) -> CGSize
+  {
+    let characterWidth = characterWidthRatio * font.pointSize
+    let lineHeight = lineHeightRatio * font.pointSize
+    // Clamp the number of characters per line, since `width` may be effectively unbounded
+    let charactersPerLine = characterWidth > 0 ?
+      Int(min(max(width / characterWidth, 1), CGFloat(Int32.max))) : Int.max
+    var lineCount = 0
+    var longestLine = 0
+
+    for line in text.components(separatedBy: .newlines) {
+      // Wrap long lines at the character level
+      let count = line.count
+      let wrappedLines = count == 0 ? 1 : (count - 1) / charactersPerLine + 1
+      lineCount += wrappedLines
+      longestLine = max(longestLine, min(count, charactersPerLine))
+    }
+
+    return CGSize(
+      width: ceil(min(CGFloat(longestLine) * characterWidth, width)),
+      height: ceil(CGFloat(lineCount) * lineHeight))
+  }
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ A spatial index of rectangular frames, which buckets elements into the square tiles of a uniform
+ grid that their frames overlap.
+
+ Finding the elements that intersect a rect only visits the elements in the tiles that overlap the
+ rect, so the cost of a query is proportional to the number of elements near that rect rather than
+ the total number of elements in the index.
+
+ - note: This class is not thread-safe.
+ */
+internal final class TileIndex<Element: Hashable> {
+  // MARK: - Structs
+
+  /// The coordinates of a tile in the grid.
+  fileprivate struct Tile: Hashable {
+    let column: Int
+    let row: Int
+
+    var hashValue: Int {
+      return column.hashValue &* 31 &+ row.hashValue
+    }
+
+    static func ==(lhs: Tile, rhs: Tile) -> Bool {
+      return lhs.column == rhs.column && lhs.row == rhs.row
+    }
+  }
+
+  /// An inclusive range of tiles that a frame overlaps.
+  fileprivate struct TileRange: Equatable {
+    let minColumn: Int
+    let maxColumn: Int
+    let minRow: Int
+    let maxRow: Int
+
+    var tileCount: Int {
+      return (maxColumn - minColumn + 1) * (maxRow - minRow + 1)
+    }
+
+    func forEachTile(_ body: (Tile) -> Void) {
+      for column in minColumn ... maxColumn {
+        for row in minRow ... maxRow {
+          body(Tile(column: column, row: row))
+        }
+      }
+    }
+
+    static func ==(lhs: TileRange, rhs: TileRange) -> Bool {
+      return lhs.minColumn == rhs.minColumn && lhs.maxColumn == rhs.maxColumn &&
+        lhs.minRow == rhs.minRow && lhs.maxRow == rhs.maxRow
+    }
+  }
+
+  // MARK: - Constants
+
+  /// Frames that overlap more than this many tiles are not bucketed, and are instead checked on
+  /// every query. This prevents a single huge frame from filling the grid.
+  internal static var MaximumTilesPerElement: Int {
+    return 256
+  }
+
+  // MARK: - Properties
+
+  /// The width and height of each tile.
+  internal let tileSize: CGFloat
+
+  /// The number of elements in the index.
+  internal var count: Int {
+    return _frames.count
+  }
+
+  /// The number of elements that were checked against the query rect during the last call to
+  /// `elements(intersecting:)`.
+  internal private(set) var lastQueryVisitedCount = 0
+
+  /// The frame of each element
+  private var _frames = [Element: CGRect]()
+
+  /// The tiles that each bucketed element has been added to
+  private var _tileRanges = [Element: TileRange]()
+
+  /// The elements in each tile
+  private var _buckets = [Tile: Set<Element>]()
+
+  /// Elements whose frames overlap too many tiles to be bucketed
+  private var _oversizedElements = Set<Element>()
+
+  // MARK: - Initializers
+
+  /**
+   Creates an empty index.
+
+   - parameter tileSize: The width and height of each tile. For best results, this should be
+   roughly the size of a typical query rect.
+   */
+  internal init(tileSize: CGFloat) {
+    bky_assert(tileSize > 0, message: "`tileSize` must be positive.")
+    self.tileSize = max(tileSize, 1)
+  }
+
+  // MARK: - Public
+
+  /**
+   Returns the frame of an element in the index.
+
+   - parameter element: The element.
+   - returns: The frame of `element`, or `nil` if it is not in the index.
+   */
+  internal func frame(of element: Element) -> CGRect? {
+    return _frames[element]
+  }
+
+  /**
+   Adds an element to the index, or updates its frame if it's already in the index. Moving an
+   element within the same tiles doesn't change any buckets.
+
+   - parameter element: The element.
+   - parameter frame: The frame of the element.
+   */
+  internal func update(_ element: Element, frame: CGRect) {
+    _frames[element] = frame
+
+    let newRange = tileRange(for: frame)
+    let oldRange = _tileRanges[element]
+    if let range = newRange, range == oldRange {
+      // The element is still in the same tiles
+      return
+    }
+
+    removeFromBuckets(element)
+
+    if let range = newRange {
+      _tileRanges[element] = range
+      range.forEachTile { tile in
+        if _buckets[tile]?.insert(element) == nil {
+          _buckets[tile] = [element]
+        }
+      }
+    } else {
+      _oversizedElements.insert(element)
+    }
+  }
+
+  /**
+   Removes an element from the index.
+
+   - parameter element: The element to remove.
+   */
+  internal func remove(_ element: Element) {
+    if _frames.removeValue(forKey: element) != nil {
+      removeFromBuckets(element)
+    }
+  }
+
+  /**
+   Removes all elements from the index.
+   */
+  internal func removeAll() {
+    _frames.removeAll()
+    _tileRanges.removeAll()
+    _buckets.removeAll()
+    _oversizedElements.removeAll()
+  }
+
+  /**
+   Returns every element whose frame intersects a given rect.
+
+   - parameter rect: The rect to query.
+   - returns: The set of elements intersecting `rect`.
+   */
+  internal func elements(intersecting rect: CGRect) -> Set<Element> {
+    var result = Set<Element>()
+    var visitedCount = 0
+
+    let visit: (Element) -> Void = { element in
+      visitedCount += 1
+      if let frame = self._frames[element], frame.intersects(rect) {
+        result.insert(element)
+      }
+    }
+
+    if let range = tileRange(for: rect) {
+      range.forEachTile { tile in
+        if let bucket = _buckets[tile] {
+          // Elements spanning several tiles may be visited more than once
+          for element in bucket where !result.contains(element) {
+            visit(element)
+          }
+        }
+      }
+    } else {
+      // The query is too large to be worth bucketing, so check every element
+      for element in _frames.keys {
+        visit(element)
+      }
+    }
+
+    for element in _oversizedElements where !result.contains(element) {
+      visit(element)
+    }
+
+    lastQueryVisitedCount = visitedCount
+    return result
+  }
+
+  // MARK: - Private
+
+  private func tileRange(for rect: CGRect) -> TileRange? {
+    guard !rect.isNull && !rect.isInfinite else {
+      return nil
+    }
+
+    let bounds = [rect.minX, rect.maxX, rect.minY, rect.maxY].map { floor($0 / tileSize) }
+    // Make sure each coordinate can be safely converted to an `Int`
+    let limit = CGFloat(Int32.max)
+    guard !bounds.contains(where: { !$0.isFinite || $0 < -limit || limit < $0 }) else {
+      return nil
+    }
+
+    let range = TileRange(
+      minColumn: Int(bounds[0]), maxColumn: Int(bounds[1]),
+      minRow: Int(bounds[2]), maxRow: Int(bounds[3]))
+    return range.tileCount <= TileIndex.MaximumTilesPerElement ? range : nil
+  }
+
+  private func removeFromBuckets(_ element: Element) {
+    if let range = _tileRanges.removeValue(forKey: element) {
+      range.forEachTile { tile in
+        _buckets[tile]?.remove(element)
+        if _buckets[tile]?.isEmpty == true {
+          _buckets[tile] = nil
+        }
+      }
+    } else {
+      _oversizedElements.remove(element)
+    }
+  }
+}
@@ -26,6 +26,24 @@ Controller for `Connection` instances, where connections can be separated into g
   public typealias ConnectionPair =
     (moving: Connection, target: Connection, fromConnectionManagerGroup: ConnectionManager.Group)
 
+  // MARK: - Enum - IndexStrategy
+
+  /**
+   Specifies the data structure each `ConnectionManager.Group` uses to index its connections.
+   */
+  public enum IndexStrategy {
+    /// Connections are kept in lists sorted by y-position. Searches scan every connection within
+    /// the y-band of the search radius, regardless of its x-position.
+    case ySortedList
+    /// Connections are bucketed into a uniform 2D grid of square cells, whose size is specified
+    /// in the Workspace coordinate system. Searches only visit cells that overlap the search
+    /// radius, which is faster for wide workspaces with many connections.
+    case grid(cellSize: CGFloat)
+
+    /// A grid strategy with a cell size suitable for the default snap/bump distances.
+    public static let defaultGrid = IndexStrategy.grid(cellSize: 48)
+  }
+
   // MARK: - Properties
 
   /// The main group. By default, all connections are tracked in this group, unless specified
@@ -35,6 +53,9 @@ Controller for `Connection` instances, where connections can be separated into g
   /// Validator for accepting/rejecting block-level connection logic.
   public let connectionValidator: ConnectionValidator
 
+  /// The strategy used by every group in this manager to index its connections.
+  public let indexStrategy: IndexStrategy
+
   /// Dictionary for retrieving a connection's assigned group (keyed by the connection uuid)
   fileprivate var _groupsByConnection = NSMutableDictionary()
 
@@ -44,13 +65,29 @@ Controller for `Connection` instances, where connections can be separated into g
   // MARK: - Initializers
 
   /**
-   Initializes the connection manager with a `ConnectionValidator`
+   Initializes the connection manager with a `ConnectionValidator`, using `.ySortedList` to
+   index connections.
+
+   - parameter connectionValidator: The `ConnectionValidator` for block-level validation.
+   */
+  public convenience init(connectionValidator: ConnectionValidator = DefaultConnectionValidator())
+  {
+    self.init(connectionValidator: connectionValidator, indexStrategy: .ySortedList)
+  }
+
+  /**
+   Initializes the connection manager with a `ConnectionValidator` and an `IndexStrategy`.
 
    - parameter connectionValidator: The `ConnectionValidator` for block-level validation.
+   - parameter indexStrategy: The strategy used to index connections within each group.
    */
-  public init(connectionValidator: ConnectionValidator = DefaultConnectionValidator()) {
+  public init(
+    connectionValidator: ConnectionValidator = DefaultConnectionValidator(),
+    indexStrategy: IndexStrategy)
+  {
     self.connectionValidator = connectionValidator
-    self.mainGroup = ConnectionManager.Group(ownerBlock: nil)
+    self.indexStrategy = indexStrategy
+    self.mainGroup = ConnectionManager.Group(ownerBlock: nil, indexStrategy: indexStrategy)
     super.init()
     self._groups.insert(mainGroup)
   }
@@ -66,10 +103,10 @@ Controller for `Connection` instances, where connections can be separated into g
   - returns: The newly created connection group
   */
   public func startGroup(forBlock block: Block?) -> ConnectionManager.Group {
-    let newGroup = ConnectionManager.Group(ownerBlock: block)
+    let newGroup = ConnectionManager.Group(ownerBlock: block, indexStrategy: indexStrategy)
     _groups.insert(newGroup)
 
-    if let childConnections = block?.allConnectionsForTree() {
+    if let childConnections = block?.connectionsInTree() {
       // Change the connection group for all affected connections to the new one created
       // for the drag gesture
       for connection in childConnections {
@@ -279,13 +316,13 @@ extension ConnectionManager {
     // MARK: - Properties
     fileprivate weak var ownerBlock: Block?
 
-    fileprivate let _previousConnections = YSortedList()
-    fileprivate let _nextConnections = YSortedList()
-    fileprivate let _inputConnections = YSortedList()
-    fileprivate let _outputConnections = YSortedList()
+    fileprivate let _previousConnections: ConnectionIndex
+    fileprivate let _nextConnections: ConnectionIndex
+    fileprivate let _inputConnections: ConnectionIndex
+    fileprivate let _outputConnections: ConnectionIndex
 
-    fileprivate let _matchingLists: [YSortedList]
-    fileprivate let _oppositeLists: [YSortedList]
+    fileprivate let _matchingLists: [ConnectionIndex]
+    fileprivate let _oppositeLists: [ConnectionIndex]
 
     /// When the connection group's drag mode has been set to true, it's assumed that all
     /// connections are being moved together as a group. In this case, the group does not
@@ -298,16 +335,16 @@ extension ConnectionManager {
 
         // Depending on if the manager is in "drag mode", add or remove it as the
         // `positionDelegate` (to improve performance).
-        for connection in _previousConnections._connections {
+        for connection in _previousConnections.connections {
           connection.positionDelegate = dragMode ? nil : self
         }
-        for connection in _nextConnections._connections {
+        for connection in _nextConnections.connections {
           connection.positionDelegate = dragMode ? nil : self
         }
-        for connection in _inputConnections._connections {
+        for connection in _inputConnections.connections {
           connection.positionDelegate = dragMode ? nil : self
         }
-        for connection in _outputConnections._connections {
+        for connection in _outputConnections.connections {
           connection.positionDelegate = dragMode ? nil : self
         }
       }
@@ -315,15 +352,28 @@ extension ConnectionManager {
 
     /// All connections managed by this group (this list is not sorted)
     internal var allConnections: [Connection] {
-      return _previousConnections._connections + _nextConnections._connections +
-        _inputConnections._connections + _outputConnections._connections
+      return _previousConnections.connections + _nextConnections.connections +
+        _inputConnections.connections + _outputConnections.connections
     }
 
     // MARK: - Initializers
 
-    fileprivate init(ownerBlock: Block?) {
+    fileprivate init(ownerBlock: Block?, indexStrategy: IndexStrategy) {
       self.ownerBlock = ownerBlock
 
+      let makeIndex: () -> ConnectionIndex = {
+        switch indexStrategy {
+        case .ySortedList:
+          return YSortedList()
+        case .grid(let cellSize):
+          return Grid(cellSize: cellSize)
+        }
+      }
+      _previousConnections = makeIndex()
+      _nextConnections = makeIndex()
+      _inputConnections = makeIndex()
+      _outputConnections = makeIndex()
+
       // NOTE: If updating this, also update Connection.OPPOSITE_TYPES array.
       // The arrays are indexed by connection type codes (`connection.type.rawValue`).
       _matchingLists =
@@ -389,7 +439,7 @@ extension ConnectionManager {
                                                               validator: validator)
     }
 
-    internal func connections(forType type: Connection.ConnectionType) -> YSortedList {
+    internal func connections(forType type: Connection.ConnectionType) -> ConnectionIndex {
       return _matchingLists[type.rawValue]
     }
 
@@ -404,13 +454,13 @@ extension ConnectionManager {
         let toConnectionList = group._matchingLists[i]
 
         // Set the position delegate to the new group
-        let affectedConnections = fromConnectionList._connections
+        let affectedConnections = fromConnectionList.connections
         for connection in affectedConnections {
           connection.positionDelegate = group
         }
 
         // And now transfer the connections over to the corresponding list in the new group
-        fromConnectionList.transferConnections(toList: toConnectionList)
+        fromConnectionList.transferConnections(toIndex: toConnectionList)
       }
     }
 
@@ -454,6 +504,111 @@ extension ConnectionManager {
     }
   }
 }
+
+// MARK: - Protocol - ConnectionIndex
+
+/**
+ Protocol for a data structure that stores connections of a single type and can be queried for
+ connections near a given position.
+ */
+internal protocol ConnectionIndex: class {
+  /// All connections stored in this index
+  var connections: [Connection] { get }
+
+  /// The number of connections stored in this index
+  var count: Int { get }
+
+  /// `true` if this index contains no connections
+  var isEmpty: Bool { get }
+
+  /**
+   Inserts the given connection into this index.
+
+   - parameter connection: The connection to insert.
+   */
+  func addConnection(_ connection: Connection)
+
+  /**
+   Removes the given connection from this index.
+
+   - parameter connection: The connection to remove.
+   */
+  func removeConnection(_ connection: Connection)
+
+  /**
+   Removes all connections from this index.
+   */
+  func removeAllConnections()
+
+  /**
+   Returns whether the given connection is stored in this index.
+
+   - parameter connection: The connection to look for.
+   - returns: `true` if the connection is in this index, `false` otherwise.
+   */
+  func contains(_ connection: Connection) -> Bool
+
+  /**
+   Finds the closest connection to a given connection, that is within a given radius and is
+   accepted by a validator.
+
+   - parameter connection: The base connection for the search.
+   - parameter maxRadius: How far out to search for compatible connections.
+   - parameter validator: The ConnectionValidator to evaluate connectability.
+   - returns: The closest valid connection, or `nil` if none could be found.
+   */
+  func searchForClosestValidConnection(
+    to connection: Connection, maxRadius: CGFloat, validator: ConnectionValidator) -> Connection?
+
+  /**
+   Finds all connections within a given radius that look like they could connect to a given
+   connection (including shadow connections). Used for bumping, so type checking does not apply.
+
+   - parameter connection: The base connection for the search.
+   - parameter maxRadius: How far out to search for neighboring connections.
+   - returns: A list of all nearby connections.
+   */
+  func neighbors(forConnection connection: Connection, maxRadius: CGFloat) -> [Connection]
+
+  /**
+   Moves all connections from this index into another index.
+
+   - parameter index: The receiving index.
+   */
+  func transferConnections(toIndex index: ConnectionIndex)
+}
+
+// MARK: - ConnectionManager Helpers
+
+extension ConnectionManager {
+  /**
+   Returns whether `candidate` should be considered a neighbor of `connection` for the purposes of
+   bumping.
+
+   - parameter candidate: The connection being evaluated.
+   - parameter connection: The base connection for the search.
+   - parameter maxRadius: The maximum distance between the two connections.
+   - returns: `true` if `candidate` is a neighbor of `connection`.
+   */
+  fileprivate static func isNeighbor(
+    _ candidate: Connection, of connection: Connection, maxRadius: CGFloat) -> Bool
+  {
+    // If both connections are connected, that's probably fine.  But if either one of them is
+    // unconnected, then there could be confusion.
+    // We use Connection rather than ConnectionValidator here, because neighbors are used to check
+    // for bumping like blocks away from each other. Two blocks might be unable to connect, but we
+    // want to make sure their blocks don't obscure one another, so neighbors returns anything that
+    // looks like it could connect.
+    let allowedConnectionReasons: Connection.CheckResult = [
+      .CanConnect, .ReasonMustDisconnect, .ReasonTypeChecksFailed,
+      .ReasonCannotSetShadowForTarget]
+    return (!connection.connected || !candidate.connected) &&
+      connection.distanceFromConnection(candidate) <= maxRadius &&
+      connection.canConnectWithReasonTo(candidate).union(allowedConnectionReasons) ==
+        allowedConnectionReasons
+  }
+}
+
 // MARK: - Class - ConnectionManager.YSortedList
 
 extension ConnectionManager {
@@ -463,11 +618,15 @@ extension ConnectionManager {
   Connections are not ordered by their x position and multiple connections may be at the same
   y position.
   */
-  internal final class YSortedList {
+  internal final class YSortedList: ConnectionIndex {
     // MARK: - Properties
 
     fileprivate var _connections = [Connection]()
 
+    internal var connections: [Connection] {
+      return _connections
+    }
+
     internal subscript(index: Int) -> Connection {
       get {
         return _connections[index]
@@ -643,23 +802,10 @@ extension ConnectionManager {
         let closestIndex = findPosition(forConnection: connection)
 
         // Walk forward and back on the y axis looking for the closest x,y point.
-        // If both connections are connected, that's probably fine.  But if
-        // either one of them is unconnected, then there could be confusion.
         var pointerMin = closestIndex - 1
         while (pointerMin >= 0 && isInYRange(forIndex: pointerMin, baseY, maxRadius)) {
           let temp = _connections[pointerMin]
-          let connectReason = connection.canConnectWithReasonTo(temp)
-          // We use Connection rather than ConnectionValidator here, because neighbors are
-          // used to check for bumping like blocks away from each other. Two blocks might
-          // be unable to connect, but we want to make sure their blocks don't obscure one
-          // another, so neighbors returns anything that looks like it could connect.
-          let allowedConnectionReasons: Connection.CheckResult = [
-            .CanConnect, .ReasonMustDisconnect, .ReasonTypeChecksFailed,
-            .ReasonCannotSetShadowForTarget]
-          if ((!connection.connected || !temp.connected) &&
-            connection.distanceFromConnection(temp) <= maxRadius &&
-            connectReason.union(allowedConnectionReasons) == allowedConnectionReasons)
-          {
+          if ConnectionManager.isNeighbor(temp, of: connection, maxRadius: maxRadius) {
             neighbors.append(temp)
           }
           pointerMin -= 1
@@ -669,14 +815,7 @@ extension ConnectionManager {
         while (pointerMax < _connections.count &&
           isInYRange(forIndex: pointerMax, baseY, maxRadius)) {
             let temp = _connections[pointerMax]
-            let connectReason = connection.canConnectWithReasonTo(temp)
-            let allowedConnectionReasons: Connection.CheckResult = [
-              .CanConnect, .ReasonMustDisconnect, .ReasonTypeChecksFailed,
-              .ReasonCannotSetShadowForTarget]
-            if ((!connection.connected || !temp.connected) &&
-              connection.distanceFromConnection(temp) <= maxRadius &&
-              connectReason.union(allowedConnectionReasons) == allowedConnectionReasons)
-            {
+            if ConnectionManager.isNeighbor(temp, of: connection, maxRadius: maxRadius) {
               neighbors.append(temp)
             }
             pointerMax += 1
@@ -707,5 +846,218 @@ extension ConnectionManager {
       // Finally, remove all connections from this list
       removeAllConnections()
     }
+
+    internal func transferConnections(toIndex index: ConnectionIndex) {
+      if let list = index as? YSortedList {
+        transferConnections(toList: list)
+        return
+      }
+
+      for connection in _connections {
+        index.addConnection(connection)
+      }
+      removeAllConnections()
+    }
+  }
+}
+
+// MARK: - Class - ConnectionManager.Grid
+
+extension ConnectionManager {
+  /**
+   Uniform grid of connections, bucketed by position into square cells. This is optimized for
+   quickly finding nearby connections on large workspaces, since searches only visit the cells
+   that overlap the search radius, instead of every connection within the radius' y-band.
+
+   Searches return the same connections as `YSortedList`, with the exception that ties between
+   equidistant connections may be resolved differently.
+   */
+  internal final class Grid: ConnectionIndex {
+    // MARK: - Struct - Cell
+
+    /// Coordinates of a single cell in the grid
+    fileprivate struct Cell: Hashable {
+      let column: Int
+      let row: Int
+
+      var hashValue: Int {
+        return column.hashValue ^ (row.hashValue &* 31)
+      }
+
+      static func ==(lhs: Cell, rhs: Cell) -> Bool {
+        return lhs.column == rhs.column && lhs.row == rhs.row
+      }
+    }
+
+    // MARK: - Properties
+
+    /// The width/height of each cell, specified as a Workspace coordinate system unit
+    internal let cellSize: CGFloat
+
+    /// Connections bucketed by cell
+    fileprivate var _cells = [Cell: [Connection]]()
+
+    /// The cell that each connection was placed in, keyed by connection uuid. This is tracked
+    /// separately so connections can be found even if their position changed without this grid
+    /// being notified (ie. while the owning group was in drag mode).
+    fileprivate var _cellsByConnection = [String: Cell]()
+
+    internal var connections: [Connection] {
+      var connections = [Connection]()
+      connections.reserveCapacity(count)
+      for bucket in _cells.values {
+        connections.append(contentsOf: bucket)
+      }
+      return connections
+    }
+
+    internal var count: Int {
+      return _cellsByConnection.count
+    }
+
+    internal var isEmpty: Bool {
+      return _cellsByConnection.isEmpty
+    }
+
+    // MARK: - Initializers
+
+    /**
+     Creates an empty grid.
+
+     - parameter cellSize: The width/height of each cell, specified as a Workspace coordinate
+     system unit. This value must be greater than `0`.
+     */
+    internal init(cellSize: CGFloat) {
+      bky_assert(cellSize > 0, message: "`cellSize` must be greater than 0")
+      self.cellSize = max(cellSize, 1)
+    }
+
+    // MARK: - Internal
+
+    internal func addConnection(_ connection: Connection) {
+      if _cellsByConnection[connection.uuid] != nil {
+        return
+      }
+
+      let cell = self.cell(forPosition: connection.position)
+      _cellsByConnection[connection.uuid] = cell
+
+      if _cells[cell] == nil {
+        _cells[cell] = [connection]
+      } else {
+        _cells[cell]?.append(connection)
+      }
+    }
+
+    internal func removeConnection(_ connection: Connection) {
+      guard let cell = _cellsByConnection.removeValue(forKey: connection.uuid),
+        var bucket = _cells[cell],
+        let index = bucket.index(where: { $0 === connection }) else {
+        return
+      }
+
+      bucket.remove(at: index)
+      _cells[cell] = bucket.isEmpty ? nil : bucket
+    }
+
+    internal func removeAllConnections() {
+      _cells.removeAll()
+      _cellsByConnection.removeAll()
+    }
+
+    internal func contains(_ connection: Connection) -> Bool {
+      return _cellsByConnection[connection.uuid] != nil
+    }
+
+    internal func searchForClosestValidConnection(
+      to connection: Connection, maxRadius: CGFloat, validator: ConnectionValidator)
+      -> Connection?
+    {
+      var bestConnection: Connection?
+      var bestRadius = maxRadius
+
+      forEachConnection(near: connection.position, maxRadius: maxRadius) { candidate in
+        let distance = connection.distanceFromConnection(candidate)
+        if distance <= bestRadius && validator.canConnect(connection, toConnection: candidate) {
+          bestConnection = candidate
+          bestRadius = distance
+        }
+      }
+
+      return bestConnection
+    }
+
+    internal func neighbors(forConnection connection: Connection, maxRadius: CGFloat)
+      -> [Connection]
+    {
+      var neighbors = [Connection]()
+
+      forEachConnection(near: connection.position, maxRadius: maxRadius) { candidate in
+        if ConnectionManager.isNeighbor(candidate, of: connection, maxRadius: maxRadius) {
+          neighbors.append(candidate)
+        }
+      }
+
+      return neighbors
+    }
+
+    internal func transferConnections(toIndex index: ConnectionIndex) {
+      for bucket in _cells.values {
+        for connection in bucket {
+          index.addConnection(connection)
+        }
+      }
+      removeAllConnections()
+    }
+
+    // MARK: - Private
+
+    fileprivate func cell(forPosition position: WorkspacePoint) -> Cell {
+      return Cell(column: coordinate(position.x), row: coordinate(position.y))
+    }
+
+    fileprivate func coordinate(_ value: CGFloat) -> Int {
+      // Clamp the value so that it can always be safely converted to an `Int`
+      let clamped = min(max((value / cellSize).rounded(.down), CGFloat(Int32.min)),
+                        CGFloat(Int32.max))
+      return Int(clamped)
+    }
+
+    /**
+     Calls a closure for every connection inside the cells that overlap the square bounding a
+     search circle. Callers are still responsible for checking the actual distance.
+
+     - parameter position: The center of the search.
+     - parameter maxRadius: The radius of the search.
+     - parameter body: The closure to call for each connection.
+     */
+    fileprivate func forEachConnection(
+      near position: WorkspacePoint, maxRadius: CGFloat, _ body: (Connection) -> Void)
+    {
+      if _cells.isEmpty || maxRadius < 0 {
+        return
+      }
+
+      let minCell = cell(forPosition:
+        WorkspacePoint(x: position.x - maxRadius, y: position.y - maxRadius))
+      let maxCell = cell(forPosition:
+        WorkspacePoint(x: position.x + maxRadius, y: position.y + maxRadius))
+      let columns = maxCell.column - minCell.column + 1
+      let rows = maxCell.row - minCell.row + 1
+
+      if columns >= _cells.count || rows >= _cells.count || columns * rows >= _cells.count {
+        // It's cheaper to simply visit every occupied cell
+        for bucket in _cells.values {
+          bucket.forEach(body)
+        }
+        return
+      }
+
+      for column in minCell.column ... maxCell.column {
+        for row in minCell.row ... maxCell.row {
+          _cells[Cell(column: column, row: row)]?.forEach(body)
+        }
+      }
+    }
   }
 }
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Describes which events an `EventManagerListener` should receive from an `EventManager`.
+
+ Each criteria is optional. A `nil` criteria matches every event, while a non-`nil` criteria only
+ matches events whose value is contained in that set. An event must match every criteria in order
+ to be delivered.
+ */
+@objc(BKYEventFilter)
+@objcMembers public final class EventFilter: NSObject {
+  // MARK: - Properties
+
+  /// The event types to match (eg. `BlocklyEvent.Move.EVENT_TYPE`), or `nil` to match all types.
+  public let eventTypes: Set<BlocklyEvent.EventType>?
+
+  /// The workspace IDs to match, or `nil` to match events from all workspaces.
+  public let workspaceIDs: Set<String>?
+
+  /// The block IDs to match, or `nil` to match events for any block (or no block at all).
+  /// `BlocklyEvent.Create` and `BlocklyEvent.Delete` events match if any block in their tree
+  /// matches.
+  public let blockIDs: Set<String>?
+
+  // MARK: - Initializers
+
+  /**
+   Creates a filter.
+
+   - parameter eventTypes: The event types to match, or `nil` to match all types.
+   - parameter workspaceIDs: The workspace IDs to match, or `nil` to match all workspaces.
+   - parameter blockIDs: The block IDs to match, or `nil` to match any block.
+   */
+  public init(
+    eventTypes: Set<BlocklyEvent.EventType>? = nil, workspaceIDs: Set<String>? = nil,
+    blockIDs: Set<String>? = nil)
+  {
+    self.eventTypes = eventTypes
+    self.workspaceIDs = workspaceIDs
+    self.blockIDs = blockIDs
+    super.init()
+  }
+
+  // MARK: - Public
+
+  /**
+   Returns whether an event matches this filter.
+
+   - parameter event: The event to check.
+   - returns: `true` if the event matches every criteria of this filter, `false` otherwise.
+   */
+  public func matches(_ event: BlocklyEvent) -> Bool {
+    if let eventTypes = self.eventTypes, !eventTypes.contains(event.type) {
+      return false
+    }
+    if let workspaceIDs = self.workspaceIDs, !workspaceIDs.contains(event.workspaceID) {
+      return false
+    }
+    if let blockIDs = self.blockIDs {
+      if let blockID = event.blockID, blockIDs.contains(blockID) {
+        return true
+      }
+      if let createEvent = event as? BlocklyEvent.Create {
+        return createEvent.blockIDs.contains(where: { blockIDs.contains($0) })
+      }
+      if let deleteEvent = event as? BlocklyEvent.Delete {
+        return deleteEvent.blockIDs.contains(where: { blockIDs.contains($0) })
+      }
+      return false
+    }
+    return true
+  }
+}
@@ -62,8 +62,15 @@ public protocol EventManagerListener: class {
     }
   }
 
-  /// Objects listening to event fires.
-  private var _listeners = WeakSet<EventManagerListener>()
+  /// Subscriptions of all objects listening to event fires, in the order they were added.
+  private var _subscriptions = [Subscription]()
+
+  /// For every event type that is matched by a filter, the subscriptions that may match events of
+  /// that type (including subscriptions that match any type), in the order they were added.
+  private var _subscriptionsByEventType = [BlocklyEvent.EventType: [Subscription]]()
+
+  /// Subscriptions that match events of any type, in the order they were added.
+  private var _untypedSubscriptions = [Subscription]()
 
   /// Flag indicating if events are currently being fired.
   private var _firingEvents: Bool = false
@@ -124,8 +131,12 @@ public protocol EventManagerListener: class {
 
     // Fire events
     for event in eventQueue {
-      for listener in _listeners {
-        listener.eventManager(self, didFireEvent: event)
+      for subscription in subscriptions(forEventType: event.type) {
+        if let listener = subscription.listener,
+          subscription.filter?.matches(event) ?? true
+        {
+          listener.eventManager(self, didFireEvent: event)
+        }
       }
     }
 
@@ -229,12 +240,31 @@ public protocol EventManagerListener: class {
   // MARK: - Listeners
 
   /**
-   Adds a listener to `EventManager`.
+   Adds a listener to `EventManager`, which receives every event that is fired.
 
    - parameter listener: The `EventManagerListener` to add.
    */
   public func addListener(_ listener: EventManagerListener) {
-    _listeners.add(listener)
+    addListener(listener, filter: nil)
+  }
+
+  /**
+   Adds a listener to `EventManager`, which only receives events matching a given filter.
+
+   If the listener has already been added, its filter is replaced.
+
+   - parameter listener: The `EventManagerListener` to add.
+   - parameter filter: The filter that events must match in order to be sent to the listener. If
+   `nil`, the listener receives every event that is fired.
+   */
+  public func addListener(_ listener: EventManagerListener, filter: EventFilter?) {
+    let subscription = Subscription(listener: listener, filter: filter)
+
+    _subscriptions = _subscriptions.filter {
+      $0.listener != nil && $0.listener !== listener
+    }
+    _subscriptions.append(subscription)
+    rebuildDispatchTables()
   }
 
   /**
@@ -243,6 +273,71 @@ public protocol EventManagerListener: class {
    - parameter listener: The `EventManagerListener` to remove.
    */
   public func removeListener(_ listener: EventManagerListener) {
-    _listeners.remove(listener)
+    _subscriptions = _subscriptions.filter {
+      $0.listener != nil && $0.listener !== listener
+    }
+    rebuildDispatchTables()
+  }
+
+  // MARK: - Dispatch Tables
+
+  /**
+   Rebuilds the tables used to look up subscriptions by event type, from `_subscriptions`.
+
+   Subscriptions that match any event type are added to the list of every event type, so that
+   firing an event only requires a single lookup.
+   */
+  private func rebuildDispatchTables() {
+    _subscriptionsByEventType.removeAll()
+    _untypedSubscriptions.removeAll()
+
+    // Create a list for every event type that is matched by a filter
+    for subscription in _subscriptions {
+      for eventType in subscription.filter?.eventTypes ?? [] {
+        _subscriptionsByEventType[eventType] = []
+      }
+    }
+    let eventTypes = Array(_subscriptionsByEventType.keys)
+
+    // Fill the lists in the order that subscriptions were added
+    for subscription in _subscriptions {
+      if let filterEventTypes = subscription.filter?.eventTypes {
+        for eventType in filterEventTypes {
+          _subscriptionsByEventType[eventType]?.append(subscription)
+        }
+      } else {
+        _untypedSubscriptions.append(subscription)
+        for eventType in eventTypes {
+          _subscriptionsByEventType[eventType]?.append(subscription)
+        }
+      }
+    }
+  }
+
+  /**
+   Returns all subscriptions that may match events of a given type, in the order they were added.
+
+   - parameter eventType: The event type.
+   - returns: The list of subscriptions.
+   */
+  private func subscriptions(forEventType eventType: BlocklyEvent.EventType) -> [Subscription] {
+    return _subscriptionsByEventType[eventType] ?? _untypedSubscriptions
+  }
+}
+
+extension EventManager {
+  /**
+   A listener that has been added to an `EventManager`, along with its filter.
+   */
+  fileprivate final class Subscription {
+    /// The listener.
+    weak var listener: EventManagerListener?
+    /// The filter that events must match, or `nil` if all events are sent to the listener.
+    let filter: EventFilter?
+
+    init(listener: EventManagerListener, filter: EventFilter?) {
+      self.listener = listener
+      self.filter = filter
+    }
   }
 }
@@ -74,7 +74,9 @@ import Foundation
   public override init() {
     super.init()
 
-    EventManager.shared.addListener(self)
+    EventManager.shared.addListener(self, filter: EventFilter(eventTypes: [
+      BlocklyEvent.Change.EVENT_TYPE, BlocklyEvent.Create.EVENT_TYPE, BlocklyEvent.Move.EVENT_TYPE
+    ]))
   }
 
   deinit {
@@ -0,0 +1,603 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Delegate for applying the changes of a `WorkspaceHistory` to a workspace.
+ */
+@objc(BKYWorkspaceHistoryDelegate)
+public protocol WorkspaceHistoryDelegate: class {
+  /**
+   Applies a recorded event to the workspace.
+
+   - parameter history: The `WorkspaceHistory` that is undoing or redoing the event.
+   - parameter event: The event to apply.
+   - parameter runForward: `true` if the event should be run forward (for redo operations), or
+   `false` if it should be run backward (for undo operations).
+   */
+  func workspaceHistory(
+    _ history: WorkspaceHistory, applyEvent event: BlocklyEvent, runForward: Bool)
+
+  /**
+   Replaces all blocks in the workspace with the contents of a checkpoint.
+
+   - parameter history: The `WorkspaceHistory` that is restoring the checkpoint.
+   - parameter snapshot: The checkpoint, created by `Workspace.snapshotData()`.
+   - parameter runForward: `true` if the checkpoint is later in the history than the workspace
+   (ie. restoring it redoes changes), or `false` if it is earlier (ie. restoring it undoes changes).
+   */
+  func workspaceHistory(
+    _ history: WorkspaceHistory, restoreCheckpoint snapshot: Data, runForward: Bool)
+
+  /**
+   Called before the history starts applying changes for an undo, redo or jump through the
+   history. Every event applied and checkpoint restored until
+   `workspaceHistoryDidApplyChanges(_:)` is called belongs to the same operation, so they can be
+   applied as a single transaction (eg. inside `WorkspaceLayoutCoordinator.beginBatchUpdates()`).
+
+   - parameter history: The `WorkspaceHistory` that will apply changes.
+   */
+  @objc optional func workspaceHistoryWillApplyChanges(_ history: WorkspaceHistory)
+
+  /**
+   Called after the history has finished applying changes for an undo, redo or jump through the
+   history.
+
+   - parameter history: The `WorkspaceHistory` that applied changes.
+   */
+  @objc optional func workspaceHistoryDidApplyChanges(_ history: WorkspaceHistory)
+}
+
+/**
+ Records the events of a workspace so they can be undone and redone, while keeping the memory
+ used by the history within a budget.
+
+ Events are recorded in steps, where each step holds the events of one event group (or a single
+ event, if it doesn't belong to a group). Every `checkpointInterval` steps, a binary snapshot of
+ the workspace is captured as a checkpoint (see `WorkspaceSnapshot`). Checkpoints are used to:
+ - Jump long distances through the history, by restoring the closest checkpoint and only replaying
+ the steps between that checkpoint and the destination.
+ - Compact old steps once the history exceeds `memoryBudget`. The steps between two checkpoints
+ are collapsed into a single step that is undone or redone by restoring a checkpoint, which means
+ older changes can only be undone at the granularity of checkpoints. If the history is still too
+ large, the oldest steps are dropped entirely.
+
+ - note: Checkpoints are captured once all pending events in `EventManager.shared` have been fired,
+ so the workspace is guaranteed to match the recorded events.
+ - note: This class is not thread-safe and should only be accessed from the main thread.
+ */
+@objc(BKYWorkspaceHistory)
+@objcMembers public final class WorkspaceHistory: NSObject {
+  // MARK: - Structs
+
+  /**
+   Describes the memory used by a `WorkspaceHistory`.
+   */
+  public struct MemoryUsage {
+    /// The number of events held by the history.
+    public let eventCount: Int
+    /// The estimated number of bytes used by all events.
+    public let eventByteCount: Int
+    /// The number of checkpoints held by the history.
+    public let checkpointCount: Int
+    /// The number of bytes used by all checkpoints.
+    public let checkpointByteCount: Int
+
+    /// The estimated number of bytes used by the history.
+    public var totalByteCount: Int {
+      return eventByteCount + checkpointByteCount
+    }
+  }
+
+  /// A single undoable step of the history.
+  fileprivate final class Step {
+    /// The group ID of the events in this step.
+    let groupID: String?
+    /// The events of this step, in chronological order, or `nil` if this step has been compacted
+    /// (and can only be applied by restoring a checkpoint).
+    var events: [BlocklyEvent]?
+    /// The estimated number of bytes used by `events`.
+    var byteCount = 0
+
+    init(groupID: String?, events: [BlocklyEvent]?) {
+      self.groupID = groupID
+      self.events = events
+      byteCount = events?.reduce(0) { $0 + WorkspaceHistory.estimatedByteCount(of: $1) } ?? 0
+    }
+  }
+
+  // MARK: - Properties
+
+  /// The workspace whose events are recorded.
+  public private(set) weak var workspace: Workspace?
+
+  /// The delegate used to apply changes to the workspace.
+  public weak var delegate: WorkspaceHistoryDelegate?
+
+  /// The maximum number of bytes that the history should use. Defaults to 4 MB.
+  public var memoryBudget = 4 * 1024 * 1024 {
+    didSet {
+      enforceMemoryBudget()
+    }
+  }
+
+  /// The number of steps between checkpoints. Defaults to `25`.
+  public var checkpointInterval = 25 {
+    didSet {
+      bky_assert(checkpointInterval > 0, message: "`checkpointInterval` must be positive.")
+    }
+  }
+
+  /// The cost of restoring a checkpoint, relative to replaying a single step. This is used to
+  /// decide whether jumping to a checkpoint is faster than replaying steps. Defaults to `10`.
+  public var checkpointRestoreCost = 10
+
+  /// The number of steps that can currently be undone.
+  public var undoableStepCount: Int {
+    return _cursor
+  }
+
+  /// The number of steps that can currently be redone.
+  public var redoableStepCount: Int {
+    return _steps.count - _cursor
+  }
+
+  /// Returns `true` if there is a step that can be undone.
+  public var canUndo: Bool {
+    return _cursor > 0
+  }
+
+  /// Returns `true` if there is a step that can be redone.
+  public var canRedo: Bool {
+    return _cursor < _steps.count
+  }
+
+  /// The memory currently used by the history.
+  public var memoryUsage: MemoryUsage {
+    return MemoryUsage(
+      eventCount: _steps.reduce(0) { $0 + ($1.events?.count ?? 0) },
+      eventByteCount: _eventByteCount,
+      checkpointCount: _checkpoints.count,
+      checkpointByteCount: _checkpointByteCount)
+  }
+
+  /// All events that can currently be undone, in chronological order. Compacted steps are not
+  /// included.
+  public var undoableEvents: [BlocklyEvent] {
+    return _steps[0 ..< _cursor].flatMap { $0.events ?? [] }
+  }
+
+  /// All events that can currently be redone, in chronological order. Compacted steps are not
+  /// included.
+  public var redoableEvents: [BlocklyEvent] {
+    return _steps[_cursor ..< _steps.count].flatMap { $0.events ?? [] }
+  }
+
+  /// The number of checkpoints that have been restored.
+  public private(set) var checkpointRestoreCount = 0
+
+  /// Flag indicating whether the history is currently applying changes to the workspace. Events
+  /// are not recorded while this is `true`.
+  public private(set) var isApplyingChanges = false
+
+  /// All recorded steps, from oldest to newest.
+  private var _steps = [Step]()
+
+  /// The number of steps (from the start of `_steps`) that are currently applied to the workspace.
+  private var _cursor = 0
+
+  /// Checkpoints, indexed by the number of steps that were applied when they were captured.
+  private var _checkpoints = [Int: Data]()
+
+  private var _eventByteCount = 0
+  private var _checkpointByteCount = 0
+
+  /// Flag indicating whether a checkpoint capture has been scheduled.
+  private var _checkpointScheduled = false
+
+  // MARK: - Initializers
+
+  /**
+   Creates an empty history.
+
+   - parameter workspace: [Optional] The workspace whose events should be recorded.
+   */
+  public init(workspace: Workspace? = nil) {
+    super.init()
+    reset(workspace: workspace)
+  }
+
+  // MARK: - Public
+
+  /**
+   Clears the history, starts recording events for a given workspace and captures its current
+   state as the initial checkpoint.
+
+   - parameter workspace: The workspace whose events should be recorded.
+   */
+  public func reset(workspace: Workspace?) {
+    self.workspace = workspace
+    _steps.removeAll()
+    _cursor = 0
+    _checkpoints.removeAll()
+    _eventByteCount = 0
+    _checkpointByteCount = 0
+    captureCheckpoint()
+  }
+
+  /**
+   Replaces all recorded steps with given events, without changing the workspace. Events are grouped
+   into steps the same way as `record(_:)` does, and the current state of the workspace is captured
+   as the checkpoint between the undoable and redoable steps.
+
+   - parameter undoableEvents: The events that can be undone, in chronological order.
+   - parameter redoableEvents: The events that can be redone, in chronological order.
+   */
+  public func reset(undoableEvents: [BlocklyEvent], redoableEvents: [BlocklyEvent]) {
+    _checkpoints.removeAll()
+    _checkpointByteCount = 0
+
+    _steps = makeSteps(forEvents: undoableEvents)
+    _cursor = _steps.count
+    _steps += makeSteps(forEvents: redoableEvents)
+    _eventByteCount = _steps.reduce(0) { $0 + $1.byteCount }
+
+    captureCheckpoint()
+    enforceMemoryBudget()
+  }
+
+  /**
+   Records an event that was fired for the workspace, and clears any steps that could be redone.
+
+   Events that don't belong to the workspace, or that are fired while the history is applying
+   changes, are ignored.
+
+   - parameter event: The event to record.
+   */
+  public func record(_ event: BlocklyEvent) {
+    guard !isApplyingChanges, let workspace = self.workspace, event.workspaceID == workspace.uuid
+      else {
+      return
+    }
+
+    removeRedoableSteps()
+
+    if let lastStep = _steps.last, var events = lastStep.events, lastStep.groupID == event.groupID {
+      // Try to merge this event with the last one in the history
+      if let lastEvent = events.last,
+        let mergedEvent = lastEvent.merged(withNextChronologicalEvent: event)
+      {
+        events.removeLast()
+        if !mergedEvent.isDiscardable() {
+          events.append(mergedEvent)
+        }
+      } else if event.groupID != nil {
+        events.append(event)
+      } else {
+        appendStep(Step(groupID: nil, events: [event]))
+        return
+      }
+
+      // The last step has changed, so any checkpoint captured after it is now stale
+      removeCheckpoint(at: _steps.count)
+
+      if events.isEmpty {
+        removeLastStep()
+      } else {
+        let byteCount = events.reduce(0) { $0 + WorkspaceHistory.estimatedByteCount(of: $1) }
+        _eventByteCount += byteCount - lastStep.byteCount
+        lastStep.byteCount = byteCount
+        lastStep.events = events
+        scheduleCheckpointIfNeeded()
+      }
+    } else {
+      appendStep(Step(groupID: event.groupID, events: [event]))
+    }
+
+    enforceMemoryBudget()
+  }
+
+  /**
+   Undoes the last step.
+   */
+  public func undo() {
+    move(toStep: _cursor - 1)
+  }
+
+  /**
+   Redoes the next step.
+   */
+  public func redo() {
+    move(toStep: _cursor + 1)
+  }
+
+  /**
+   Undoes or redoes steps until a given number of steps are applied.
+
+   If it's cheaper, the closest checkpoint is restored first, so only the steps between that
+   checkpoint and `step` are replayed.
+
+   - parameter step: The number of steps that should be applied, between `0` and
+   `undoableStepCount + redoableStepCount`.
+   */
+  public func move(toStep step: Int) {
+    guard 0 <= step && step <= _steps.count && step != _cursor else {
+      return
+    }
+
+    isApplyingChanges = true
+    delegate?.workspaceHistoryWillApplyChanges?(self)
+    defer {
+      delegate?.workspaceHistoryDidApplyChanges?(self)
+      isApplyingChanges = false
+    }
+
+    // Find the cheapest place to start replaying steps from
+    var startCheckpoint: Int?
+    var lowestCost = replayCost(from: _cursor, to: step)
+    for checkpoint in _checkpoints.keys {
+      let cost = checkpointRestoreCost + replayCost(from: checkpoint, to: step)
+      if cost < lowestCost {
+        lowestCost = cost
+        startCheckpoint = checkpoint
+      }
+    }
+
+    if let checkpoint = startCheckpoint {
+      restoreCheckpoint(at: checkpoint)
+    }
+
+    while _cursor > step {
+      let undoStep = _steps[_cursor - 1]
+      if let events = undoStep.events {
+        for event in events.reversed() {
+          delegate?.workspaceHistory(self, applyEvent: event, runForward: false)
+        }
+        _cursor -= 1
+      } else {
+        restoreCheckpoint(at: _cursor - 1)
+      }
+    }
+
+    while _cursor < step {
+      let redoStep = _steps[_cursor]
+      if let events = redoStep.events {
+        for event in events {
+          delegate?.workspaceHistory(self, applyEvent: event, runForward: true)
+        }
+        _cursor += 1
+      } else {
+        restoreCheckpoint(at: _cursor + 1)
+      }
+    }
+  }
+
+  /**
+   Captures the current state of the workspace as a checkpoint for the current step, if all
+   pending events have been fired.
+   */
+  public func captureCheckpoint() {
+    guard let workspace = self.workspace,
+      EventManager.shared.pendingEvents.isEmpty,
+      _checkpoints[_cursor] == nil else
+    {
+      return
+    }
+
+    do {
+      let snapshot = try workspace.snapshotData()
+      _checkpoints[_cursor] = snapshot
+      _checkpointByteCount += snapshot.count
+    } catch let error {
+      bky_print("Could not capture a checkpoint of the workspace: \(error)")
+    }
+
+    enforceMemoryBudget()
+  }
+
+  // MARK: - Memory Estimation
+
+  /**
+   Returns the estimated number of bytes needed to store an event.
+
+   - parameter event: The event.
+   - returns: The estimated number of bytes.
+   */
+  public static func estimatedByteCount(of event: BlocklyEvent) -> Int {
+    // Rough size of an event object, plus the strings it always holds
+    var byteCount = 64 + event.type.utf8.count + event.workspaceID.utf8.count +
+      (event.blockID?.utf8.count ?? 0) + (event.groupID?.utf8.count ?? 0)
+
+    if let createEvent = event as? BlocklyEvent.Create {
+      byteCount += createEvent.estimatedXMLByteCount +
+        createEvent.blockIDs.reduce(0) { $0 + $1.utf8.count }
+    } else if let deleteEvent = event as? BlocklyEvent.Delete {
+      byteCount += deleteEvent.estimatedXMLByteCount +
+        deleteEvent.blockIDs.reduce(0) { $0 + $1.utf8.count }
+    } else if let changeEvent = event as? BlocklyEvent.Change {
+      byteCount += changeEvent.element.utf8.count + (changeEvent.fieldName?.utf8.count ?? 0) +
+        (changeEvent.oldValue?.utf8.count ?? 0) + (changeEvent.newValue?.utf8.count ?? 0)
+    } else if let moveEvent = event as? BlocklyEvent.Move {
+      byteCount += 32 + (moveEvent.oldParentID?.utf8.count ?? 0) +
+        (moveEvent.newParentID?.utf8.count ?? 0) + (moveEvent.oldInputName?.utf8.count ?? 0) +
+        (moveEvent.newInputName?.utf8.count ?? 0)
+    }
+
+    return byteCount
+  }
+
+  // MARK: - Private
+
+  private func makeSteps(forEvents events: [BlocklyEvent]) -> [Step] {
+    var steps = [Step]()
+    for event in events {
+      if let lastStep = steps.last, event.groupID != nil && lastStep.groupID == event.groupID {
+        lastStep.events?.append(event)
+        lastStep.byteCount += WorkspaceHistory.estimatedByteCount(of: event)
+      } else {
+        steps.append(Step(groupID: event.groupID, events: [event]))
+      }
+    }
+    return steps
+  }
+
+  private func appendStep(_ step: Step) {
+    _steps.append(step)
+    _cursor = _steps.count
+    _eventByteCount += step.byteCount
+    scheduleCheckpointIfNeeded()
+  }
+
+  private func removeLastStep() {
+    if let step = _steps.popLast() {
+      _eventByteCount -= step.byteCount
+      _cursor = min(_cursor, _steps.count)
+    }
+  }
+
+  private func removeRedoableSteps() {
+    while _steps.count > _cursor {
+      removeCheckpoint(at: _steps.count)
+      removeLastStep()
+    }
+  }
+
+  private func removeCheckpoint(at step: Int) {
+    if let snapshot = _checkpoints.removeValue(forKey: step) {
+      _checkpointByteCount -= snapshot.count
+    }
+  }
+
+  private func restoreCheckpoint(at step: Int) {
+    guard let snapshot = _checkpoints[step] else {
+      bky_assertionFailure("No checkpoint exists for step \(step).")
+      _cursor = step
+      return
+    }
+
+    delegate?.workspaceHistory(self, restoreCheckpoint: snapshot, runForward: step > _cursor)
+    checkpointRestoreCount += 1
+    _cursor = step
+  }
+
+  /**
+   Returns the cost of replaying all steps between two points in the history.
+   */
+  private func replayCost(from start: Int, to end: Int) -> Int {
+    var cost = 0
+    for i in min(start, end) ..< max(start, end) {
+      cost += _steps[i].events == nil ? checkpointRestoreCost : 1
+    }
+    return cost
+  }
+
+  /**
+   Schedules a checkpoint capture if the current step falls on a checkpoint interval. The capture
+   happens asynchronously, after the current batch of events has been fired.
+   */
+  private func scheduleCheckpointIfNeeded() {
+    guard _steps.count % checkpointInterval == 0 && !_checkpointScheduled else {
+      return
+    }
+
+    _checkpointScheduled = true
+    DispatchQueue.main.async { [weak self] in
+      guard let strongSelf = self else { return }
+      strongSelf._checkpointScheduled = false
+      if strongSelf._cursor == strongSelf._steps.count &&
+        strongSelf._cursor % strongSelf.checkpointInterval == 0
+      {
+        strongSelf.captureCheckpoint()
+      }
+    }
+  }
+
+  /**
+   Compacts or drops the oldest steps until the history fits inside `memoryBudget`.
+   */
+  private func enforceMemoryBudget() {
+    while _eventByteCount + _checkpointByteCount > memoryBudget {
+      if !compactOldestSegment() && !dropOldestStep() {
+        break
+      }
+    }
+  }
+
+  /**
+   Collapses the oldest uncompacted steps between two consecutive checkpoints into a single
+   compacted step.
+
+   - returns: `true` if steps were compacted, `false` if there was nothing left to compact.
+   */
+  private func compactOldestSegment() -> Bool {
+    let checkpoints = _checkpoints.keys.sorted()
+    guard checkpoints.count >= 2 else {
+      return false
+    }
+
+    for i in 0 ..< checkpoints.count - 1 {
+      let start = checkpoints[i]
+      let end = checkpoints[i + 1]
+      if (end - start == 1 && _steps[start].events == nil) || (start < _cursor && _cursor < end) {
+        // Skip steps that have already been compacted, and steps that the workspace is currently
+        // in the middle of (since compacting those would make its current state unreachable).
+        continue
+      }
+
+      // Replace the steps between both checkpoints with a single compacted step
+      for step in _steps[start ..< end] {
+        _eventByteCount -= step.byteCount
+      }
+      _steps.replaceSubrange(start ..< end, with: [Step(groupID: nil, events: nil)])
+
+      let removedStepCount = end - start - 1
+      if removedStepCount > 0 {
+        shiftCheckpoints(after: start, by: -removedStepCount)
+        if _cursor >= end {
+          _cursor -= removedStepCount
+        }
+      }
+      return true
+    }
+
+    return false
+  }
+
+  /**
+   Drops the oldest step, along with its checkpoint.
+
+   - returns: `true` if a step was dropped, `false` if no step could be dropped.
+   */
+  private func dropOldestStep() -> Bool {
+    guard _cursor > 0 && !_steps.isEmpty else {
+      return false
+    }
+
+    _eventByteCount -= _steps.removeFirst().byteCount
+    removeCheckpoint(at: 0)
+    shiftCheckpoints(after: 0, by: -1)
+    _cursor -= 1
+    return true
+  }
+
+  private func shiftCheckpoints(after step: Int, by offset: Int) {
+    var shiftedCheckpoints = [Int: Data]()
+    for (key, snapshot) in _checkpoints {
+      shiftedCheckpoints[key > step ? key + offset : key] = snapshot
+    }
+    _checkpoints = shiftedCheckpoints
+  }
+}
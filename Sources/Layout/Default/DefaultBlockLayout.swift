@@ -313,6 +313,13 @@ import Foundation
     // Update the size required for this block
     self.contentSize = requiredContentSize()
 
+    // Connection positions are applied when `absolutePosition` is set, and they may have changed
+    // without affecting the size/position of this block or its inputs
+    setNeedsViewPositionRefresh()
+    for layout in layouts {
+      layout.setNeedsViewPositionRefresh()
+    }
+
     // Force this block to be redisplayed
     sendChangeEvent(withFlags: Layout.Flag_NeedsDisplay)
   }
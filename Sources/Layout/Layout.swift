@@ -96,17 +96,34 @@ position and size.
   public fileprivate(set) final var childLayouts = Set<Layout>()
 
   /// Position relative to `self.parentLayout`
-  internal final var relativePosition: WorkspacePoint = WorkspacePoint.zero
+  internal final var relativePosition: WorkspacePoint = WorkspacePoint.zero {
+    didSet {
+      if relativePosition != oldValue {
+        setNeedsViewPositionRefresh()
+      }
+    }
+  }
   /// Content size of this layout
   internal final var contentSize: WorkspaceSize = WorkspaceSize.zero {
     didSet {
       updateTotalSize()
+
+      if contentSize != oldValue {
+        // In RTL, the view frames of child layouts are calculated relative to this size
+        _childViewPositionsNeedRefresh = true
+        setNeedsViewPositionRefresh()
+      }
     }
   }
   /// Inline edge insets for the layout.
   internal final var edgeInsets: WorkspaceEdgeInsets = WorkspaceEdgeInsets.zero {
     didSet {
       updateTotalSize()
+
+      if edgeInsets.top != oldValue.top || edgeInsets.leading != oldValue.leading ||
+        edgeInsets.bottom != oldValue.bottom || edgeInsets.trailing != oldValue.trailing {
+        setNeedsViewPositionRefresh()
+      }
     }
   }
 
@@ -121,7 +138,14 @@ position and size.
 
   /// An offset that should be applied to the positions of `childLayouts`, specified in the
   /// Workspace coordinate system.
-  internal final var childContentOffset: WorkspacePoint = WorkspacePoint.zero
+  internal final var childContentOffset: WorkspacePoint = WorkspacePoint.zero {
+    didSet {
+      if childContentOffset != oldValue {
+        _childViewPositionsNeedRefresh = true
+        setNeedsViewPositionRefresh()
+      }
+    }
+  }
 
   /**
   UIView frame for this layout relative to its parent *view* node's layout. For example, the parent
@@ -141,6 +165,21 @@ position and size.
   /// A set of Layout hierarchy listeners on this instance
   public final var hierarchyListeners = WeakSet<LayoutHierarchyListener>()
 
+  /// Statistics for the last view position refresh pass that was started from this layout.
+  public internal(set) final var lastViewPositionRefresh = ViewPositionRefreshStatistics()
+
+  /// Flag indicating that `absolutePosition` and `viewFrame` need to be recalculated for this
+  /// layout on the next view position refresh pass.
+  fileprivate final var _viewPositionNeedsRefresh = true
+
+  /// Flag indicating that this layout's children need to be repositioned on the next view
+  /// position refresh pass, because `contentSize` or `childContentOffset` has changed.
+  fileprivate final var _childViewPositionsNeedRefresh = false
+
+  /// Flag indicating that at least one layout under this layout's tree needs its view position
+  /// refreshed.
+  fileprivate final var _descendantViewPositionsNeedRefresh = false
+
   // MARK: - Initializers
 
   /**
@@ -177,6 +216,11 @@ position and size.
   of `self.parentLayout`.
   */
   open func updateLayoutDownTree() {
+    if let transaction = engine.transaction {
+      transaction.setNeedsFullLayout(self)
+      return
+    }
+
     performLayout(includeChildren: true)
     refreshViewPositionsForTree()
   }
@@ -187,15 +231,45 @@ position and size.
   each layout in the tree is re-calculated.
   */
   public final func updateLayoutUpTree() {
+    if let transaction = engine.transaction {
+      // Defer this work until the transaction is committed
+      transaction.setNeedsLayoutUpTree(self)
+      return
+    }
+
     // Re-position content at this level
     performLayout(includeChildren: false)
 
+    // Subclasses may have recalculated internal state that depends on `absolutePosition`
+    // (eg. connection positions), so always refresh the view position at this level.
+    setNeedsViewPositionRefresh()
+
     if let parentLayout = self.parentLayout {
       // Recursively do the same thing up the tree hierarchy
       parentLayout.updateLayoutUpTree()
     } else {
-      // The top of the tree has been reached. Re-calculate view positions for the entire tree.
-      refreshViewPositionsForTree()
+      // The top of the tree has been reached. Re-calculate view positions for all layouts in the
+      // tree that have changed.
+      refreshViewPositionsForTree(onlyIfNeeded: true)
+    }
+  }
+
+  /**
+   Marks this layout so that its `absolutePosition` and `viewFrame` are recalculated on the next
+   view position refresh pass.
+
+   This is done automatically when `relativePosition`, `contentSize`, `edgeInsets`, or
+   `childContentOffset` change. Subclasses should call this method if they've changed any other
+   state that is applied when `absolutePosition` is set.
+   */
+  public final func setNeedsViewPositionRefresh() {
+    _viewPositionNeedsRefresh = true
+
+    // Let all ancestors know that a layout in their tree needs to be refreshed
+    var parent = parentLayout
+    while let layout = parent, !layout._descendantViewPositionsNeedRefresh {
+      layout._descendantViewPositionsNeedRefresh = true
+      parent = layout.parentLayout
     }
   }
 
@@ -205,6 +279,12 @@ position and size.
   - parameter flags: `LayoutFlag` options to send with the change event
   */
   public final func sendChangeEvent(withFlags flags: LayoutFlag) {
+    if let transaction = engine.transaction ?? engine.committingTransaction {
+      // Accumulate this event until the transaction is committed
+      transaction.addChangeEvent(forLayout: self, flags: flags, animated: animateChangeEvent)
+      return
+    }
+
     // Send change event
     delegate?.layoutDidChange(self, withFlags: flags, animated: animateChangeEvent)
   }
@@ -303,6 +383,9 @@ position and size.
       layout.relativePosition = layout.absolutePosition - absolutePosition
       // With its new relative position, refresh the view positions for this part of the tree
       layout.refreshViewPositionsForTree()
+    } else {
+      // Make sure the new child gets positioned on the next refresh pass of this tree
+      layout.setNeedsViewPositionRefresh()
     }
 
     // Fire hierachy listeners
@@ -336,14 +419,23 @@ position and size.
 
   - parameter includeFields: If true, recursively update view frames for field layouts. If false,
   skip them.
+  - parameter onlyIfNeeded: If true, only layouts that have been marked via
+  `setNeedsViewPositionRefresh()` (or whose parent's position has changed) are updated. If false,
+  every layout in the tree is updated.
   */
-  internal final func refreshViewPositionsForTree(includeFields: Bool = true) {
+  internal final func refreshViewPositionsForTree(
+    includeFields: Bool = true, onlyIfNeeded: Bool = false)
+  {
+    var statistics = ViewPositionRefreshStatistics()
     refreshViewPositionsForTree(
       parentAbsolutePosition: (parentLayout?.absolutePosition ?? WorkspacePoint.zero),
       parentContentSize: (parentLayout?.contentSize ?? self.contentSize),
       contentOffset: (parentLayout?.childContentOffset ?? WorkspacePoint.zero),
       rtl: self.engine.rtl,
-      includeFields: includeFields)
+      includeFields: includeFields,
+      force: !onlyIfNeeded,
+      statistics: &statistics)
+    lastViewPositionRefresh = statistics
   }
 
   // MARK: - Private
@@ -361,6 +453,9 @@ position and size.
   - parameter rtl: Flag for if the layout should be positioned in RTL mode.
   - parameter includeFields: If true, recursively update view positions for field layouts. If false,
   skip them.
+  - parameter force: If true, view positions are updated for this layout and all of its
+  descendants. If false, they are only updated for layouts that need it.
+  - parameter statistics: Statistics that are updated as layouts are visited.
   - note: All parent parameters are defined in the method signature so we can eliminate direct
   references to `self.parentLayout` inside this method. This results in better performance.
   */
@@ -369,12 +464,24 @@ position and size.
     parentAbsolutePosition: WorkspacePoint,
     parentContentSize: WorkspaceSize,
     contentOffset: WorkspacePoint,
-    rtl: Bool, includeFields: Bool)
+    rtl: Bool, includeFields: Bool, force: Bool,
+    statistics: inout ViewPositionRefreshStatistics)
   {
-    // TODO(#29): Optimize this method so it only recalculates view positions for layouts that
-    // are "dirty"
+    statistics.visitedCount += 1
+
+    if !force && !_viewPositionNeedsRefresh {
+      // Nothing has changed at this level, but something may have changed further down the tree
+      if _descendantViewPositionsNeedRefresh {
+        refreshChildViewPositions(
+          rtl: rtl, includeFields: includeFields, force: false, statistics: &statistics)
+      }
+      return
+    }
+
+    statistics.refreshedCount += 1
 
     // Update the layout's absolute position in the workspace
+    let oldAbsolutePosition = self.absolutePosition
     self.absolutePosition = WorkspacePoint(
       x: parentAbsolutePosition.x + relativePosition.x + edgeInsets.leading,
       y: parentAbsolutePosition.y + relativePosition.y + edgeInsets.top)
@@ -400,7 +507,34 @@ position and size.
       self.viewFrame =
         CGRect(x: viewFrameOrigin.x, y: viewFrameOrigin.y,
                width: viewSize.width, height: viewSize.height)
+
+      _viewPositionNeedsRefresh = false
+    }
+
+    // Children only need to be repositioned if something they depend on has changed
+    let forceChildren = force || _childViewPositionsNeedRefresh ||
+      self.absolutePosition != oldAbsolutePosition
+
+    if forceChildren || _descendantViewPositionsNeedRefresh {
+      refreshChildViewPositions(
+        rtl: rtl, includeFields: includeFields, force: forceChildren, statistics: &statistics)
     }
+  }
+
+  /**
+  Refreshes view positions for the trees of all child layouts.
+
+  - parameter rtl: Flag for if the layout should be positioned in RTL mode.
+  - parameter includeFields: If true, recursively update view positions for field layouts. If false,
+  skip them.
+  - parameter force: If true, view positions are updated for all child layouts and their
+  descendants. If false, they are only updated for layouts that need it.
+  - parameter statistics: Statistics that are updated as layouts are visited.
+  */
+  fileprivate final func refreshChildViewPositions(
+    rtl: Bool, includeFields: Bool, force: Bool, statistics: inout ViewPositionRefreshStatistics)
+  {
+    var pendingRefresh = false
 
     for layout in self.childLayouts {
       // Automatically skip if this is a field and we're not allowing them
@@ -410,9 +544,20 @@ position and size.
           parentContentSize: self.contentSize,
           contentOffset: self.childContentOffset,
           rtl: rtl,
-          includeFields: includeFields)
+          includeFields: includeFields,
+          force: force,
+          statistics: &statistics)
+      } else if force {
+        // This field was skipped, so it still needs to be refreshed on a future pass
+        layout._viewPositionNeedsRefresh = true
       }
+
+      pendingRefresh = pendingRefresh ||
+        layout._viewPositionNeedsRefresh || layout._descendantViewPositionsNeedRefresh
     }
+
+    _childViewPositionsNeedRefresh = false
+    _descendantViewPositionsNeedRefresh = pendingRefresh
   }
 
   /**
@@ -471,6 +616,20 @@ extension Layout {
   }
 }
 
+// MARK: - View Position Refresh Statistics
+
+/**
+ Statistics for a single view position refresh pass over a `Layout` tree.
+ */
+public struct ViewPositionRefreshStatistics {
+  /// The number of layouts that were visited during the pass
+  public internal(set) var visitedCount: Int = 0
+
+  /// The number of layouts whose `absolutePosition` and `viewFrame` were recalculated during the
+  /// pass
+  public internal(set) var refreshedCount: Int = 0
+}
+
 // MARK: - Layout Flag
 
 /**
@@ -126,6 +126,14 @@ import Foundation
   /// [`Double`] The animation duration to use when running animatable code inside a `LayoutView`.
   public static let ViewAnimationDuration = LayoutConfig.newPropertyKey()
 
+  /// [`Float`] The workspace scale below which block groups are rendered as silhouettes, without
+  /// any field views. See `WorkspaceView.reducesDetailWhenZoomedOut`.
+  public static let SilhouetteDetailScale = LayoutConfig.newPropertyKey()
+
+  /// [`Float`] The workspace scale below which block groups are rendered as silhouettes and cached
+  /// as bitmaps. See `WorkspaceView.reducesDetailWhenZoomedOut`.
+  public static let RasterizedDetailScale = LayoutConfig.newPropertyKey()
+
   /// [`[String]`] The variable blocks to be created in the toolbox when a variable is created.
   public static let VariableBlocks = LayoutConfig.newPropertyKey()
 
@@ -246,6 +254,9 @@ import Foundation
 
     setDouble(0.3, for: LayoutConfig.ViewAnimationDuration)
 
+    setFloat(0.4, for: LayoutConfig.SilhouetteDetailScale)
+    setFloat(0.25, for: LayoutConfig.RasterizedDetailScale)
+
     setStringArray(["variables_get"], for: LayoutConfig.VariableBlocks)
     setStringArray(["variables_set", "math_change"], for: LayoutConfig.UniqueVariableBlocks)
 
@@ -454,6 +465,11 @@ import Foundation
    - parameter key: The `PropertyKey` (e.g. `LayoutConfig.GlobalFont`)
    */
   public func setFontCreator(_ fontCreator: @escaping FontCreator, for key: PropertyKey) {
+    if _fonts[key] != nil {
+      // A font is being replaced, so measurements of text using the old font are no longer needed
+      TextMeasurement.removeAllCachedMeasurements()
+    }
+
     _fonts[key] =
       ScaledFont(creator: fontCreator, fontScale: _scale, popoverFontScale: _popoverScale)
   }
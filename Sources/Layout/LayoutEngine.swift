@@ -68,6 +68,13 @@ import Foundation
   /// The UI configuration to use for this layout engine
   public final var config: LayoutConfig
 
+  /// The layout transaction that is currently open on this engine, or `nil` if there is none
+  internal fileprivate(set) final var transaction: LayoutTransaction?
+
+  /// The layout transaction whose deferred work is currently being performed, or `nil` if there is
+  /// none. Change events sent during this work are merged into its accumulated change events.
+  internal fileprivate(set) final var committingTransaction: LayoutTransaction?
+
   // MARK: - Initializers
 
   /**
@@ -221,4 +228,59 @@ import Foundation
                     height: viewUnitFromWorkspaceUnit(size.height))
     }
   }
+
+  /**
+   Opens a layout transaction for all `Layout` instances associated with this engine. Until the
+   transaction is committed, layout updates, canvas size updates, and layout change events are
+   deferred.
+
+   Transactions may be nested, in which case deferred work is only performed once the outermost
+   transaction has been committed.
+   */
+  public final func beginTransaction() {
+    if transaction == nil {
+      transaction = LayoutTransaction()
+    }
+    transaction?.depth += 1
+  }
+
+  /**
+   Commits the transaction that was opened by the most recent call to `beginTransaction()`. If this
+   was the outermost transaction, all deferred work is performed, once per affected layout.
+   */
+  public final func commitTransaction() {
+    guard let transaction = self.transaction else {
+      bky_assertionFailure("`commitTransaction()` was called without a matching " +
+        "`beginTransaction()`.")
+      return
+    }
+
+    transaction.depth -= 1
+
+    if transaction.depth == 0 {
+      // Close the transaction before committing it, so the deferred work is performed immediately
+      self.transaction = nil
+      committingTransaction = transaction
+      transaction.commit()
+      committingTransaction = nil
+
+      // Send change events only once all deferred work has been performed, so each layout is
+      // notified once
+      transaction.sendChangeEvents()
+    }
+  }
+
+  /**
+   Executes a given code block inside a layout transaction (see `beginTransaction()`).
+
+   - parameter updates: The code block to execute.
+   - rethrows: Any error thrown by `updates`. The transaction is still committed in this case.
+   */
+  public final func performTransaction(_ updates: () throws -> Void) rethrows {
+    beginTransaction()
+    defer {
+      commitTransaction()
+    }
+    try updates()
+  }
 }
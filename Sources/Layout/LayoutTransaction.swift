@@ -0,0 +1,190 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Records layout work that has been deferred while a transaction is open on a `LayoutEngine`, so
+ that it can be performed once when the transaction is committed.
+
+ While a transaction is open:
+ - `Layout.updateLayoutUpTree()` only records the layout as needing an update
+ - `Layout.updateLayoutDownTree()` only records the layout as needing a full layout
+ - `WorkspaceLayout.updateCanvasSize()` only records the workspace layout as needing a canvas update
+ - `Layout.sendChangeEvent(withFlags:)` accumulates flags per layout instead of notifying its
+ delegate. This continues while the transaction is being committed, so that each layout is only
+ notified once.
+
+ - note: Layout values (eg. `absolutePosition`, `contentSize`) may be stale until the transaction
+ has been committed.
+ */
+internal final class LayoutTransaction {
+  // MARK: - Properties
+
+  /// The number of times the transaction has been opened, without being committed
+  internal var depth = 0
+
+  /// Layouts that need `performLayout(includeChildren: true)` to be called on them
+  fileprivate var _layoutsNeedingFullLayout = Set<Layout>()
+
+  /// Layouts that, along with all of their ancestors, need `performLayout(includeChildren: false)`
+  /// to be called on them
+  fileprivate var _layoutsNeedingUpdate = Set<Layout>()
+
+  /// Workspace layouts that need `updateCanvasSize()` to be called on them
+  fileprivate var _workspaceLayoutsNeedingCanvasUpdate = Set<WorkspaceLayout>()
+
+  /// Change events that have been accumulated for each layout
+  fileprivate var _pendingChangeEvents = [Layout: (flags: LayoutFlag, animated: Bool)]()
+
+  // MARK: - Internal
+
+  internal func setNeedsFullLayout(_ layout: Layout) {
+    _layoutsNeedingFullLayout.insert(layout)
+  }
+
+  internal func setNeedsLayoutUpTree(_ layout: Layout) {
+    _layoutsNeedingUpdate.insert(layout)
+  }
+
+  internal func setNeedsCanvasUpdate(_ workspaceLayout: WorkspaceLayout) {
+    _workspaceLayoutsNeedingCanvasUpdate.insert(workspaceLayout)
+  }
+
+  internal func addChangeEvent(forLayout layout: Layout, flags: LayoutFlag, animated: Bool) {
+    if let pending = _pendingChangeEvents[layout] {
+      _pendingChangeEvents[layout] =
+        (flags: pending.flags.union(flags), animated: pending.animated || animated)
+    } else {
+      _pendingChangeEvents[layout] = (flags: flags, animated: animated)
+    }
+  }
+
+  /**
+   Performs all layout work that was deferred during this transaction. Each affected layout is laid
+   out once, in bottom-up order, and view positions are refreshed once per affected tree.
+
+   Layouts that were detached from their workspace layout during the transaction (eg. block group
+   layouts that were removed) are skipped.
+
+   - note: This must be called after the transaction has been closed on its `LayoutEngine`, so
+   that the work performed here is not deferred again. Change events sent by this work should be
+   accumulated by this transaction, and are only sent by `sendChangeEvents()`.
+   */
+  internal func commit() {
+    // Whether each visited layout belongs to a tree headed by a workspace layout
+    var attachedLayouts = [Layout: Bool]()
+
+    func isAttached(_ layout: Layout) -> Bool {
+      var path = [Layout]()
+      var current: Layout? = layout
+
+      while let node = current, attachedLayouts[node] == nil {
+        path.append(node)
+        current = node.parentLayout
+      }
+
+      let attached = current.flatMap { attachedLayouts[$0] } ?? (path.last is WorkspaceLayout)
+      for node in path {
+        attachedLayouts[node] = attached
+      }
+      return attached
+    }
+
+    // Perform full layouts, skipping layouts that are already covered by an ancestor's layout
+    let fullLayouts = _layoutsNeedingFullLayout.filter { layout in
+      guard isAttached(layout) else {
+        return false
+      }
+
+      var parent = layout.parentLayout
+      while let ancestor = parent {
+        if _layoutsNeedingFullLayout.contains(ancestor) {
+          return false
+        }
+        parent = ancestor.parentLayout
+      }
+      return true
+    }
+    for layout in fullLayouts {
+      layout.performLayout(includeChildren: true)
+    }
+
+    // Collect every layout between an updated layout and the root of its tree, along with its
+    // depth, so that each one is laid out exactly once.
+    var depths = [Layout: Int]()
+    var roots = Set<Layout>()
+
+    for layout in _layoutsNeedingUpdate where isAttached(layout) {
+      var path = [Layout]()
+      var current: Layout? = layout
+
+      while let node = current, depths[node] == nil {
+        path.append(node)
+        current = node.parentLayout
+      }
+
+      // Depth of the first node that was already visited (or -1 if the root was reached)
+      var depth = current.flatMap { depths[$0] } ?? -1
+      for node in path.reversed() {
+        depth += 1
+        depths[node] = depth
+      }
+
+      if current == nil, let root = path.last {
+        roots.insert(root)
+      }
+    }
+
+    // Lay out the deepest layouts first, since parents depend on the sizes of their children
+    for (layout, _) in depths.sorted(by: { $0.value > $1.value }) {
+      layout.performLayout(includeChildren: false)
+      layout.setNeedsViewPositionRefresh()
+    }
+
+    for root in roots {
+      root.refreshViewPositionsForTree(onlyIfNeeded: true)
+    }
+
+    // Full layouts may have been affected by changes that don't mark a layout as needing a view
+    // position refresh (eg. a scale change), so refresh their entire trees.
+    for layout in fullLayouts {
+      layout.refreshViewPositionsForTree()
+    }
+
+    for workspaceLayout in _workspaceLayoutsNeedingCanvasUpdate {
+      workspaceLayout.updateCanvasSize()
+    }
+
+    _layoutsNeedingFullLayout.removeAll()
+    _layoutsNeedingUpdate.removeAll()
+    _workspaceLayoutsNeedingCanvasUpdate.removeAll()
+  }
+
+  /**
+   Sends the change events that have been accumulated for each layout, merged into a single event
+   per layout.
+
+   - note: This must be called after `commit()`.
+   */
+  internal func sendChangeEvents() {
+    let pendingChangeEvents = _pendingChangeEvents
+    _pendingChangeEvents.removeAll()
+
+    for (layout, event) in pendingChangeEvents {
+      layout.delegate?.layoutDidChange(layout, withFlags: event.flags, animated: event.animated)
+    }
+  }
+}
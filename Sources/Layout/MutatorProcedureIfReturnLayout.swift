@@ -44,7 +44,9 @@ import Foundation
 
     updateHasReturnValue()
 
-    EventManager.shared.addListener(self)
+    // Only moves can change the grandparents of this block
+    EventManager.shared.addListener(
+      self, filter: EventFilter(eventTypes: [BlocklyEvent.Move.EVENT_TYPE]))
   }
 
   deinit {
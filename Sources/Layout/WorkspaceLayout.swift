@@ -213,10 +213,15 @@ import Foundation
    Updates the required size of this layout based on the current positions of all blocks.
    */
   open func updateCanvasSize() {
+    if let transaction = engine.transaction {
+      transaction.setNeedsCanvasUpdate(self)
+      return
+    }
+
     performLayout(includeChildren: false)
 
-    // View positions need to be refreshed for the entire tree since if the canvas size changes, the
-    // positions of block groups also change.
-    refreshViewPositionsForTree()
+    // If the canvas size changes, the positions of block groups also change. This is tracked
+    // automatically by `childContentOffset`, so only refresh view positions that need it.
+    refreshViewPositionsForTree(onlyIfNeeded: true)
   }
 }
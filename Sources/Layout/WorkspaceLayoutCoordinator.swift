@@ -109,6 +109,38 @@ import Foundation
 
   // MARK: - Public
 
+  /**
+   Opens a batch of updates for the workspace layout. Until `commitBatchUpdates()` is called, all
+   layout passes, view position refreshes, canvas size updates, and layout change events caused by
+   operations on this coordinator (eg. `connect`, `disconnect`, `addBlockTree`, `removeBlockTree`)
+   are deferred. When committed, each affected layout is laid out only once.
+
+   Batches may be nested. Deferred work is performed when the outermost batch is committed.
+
+   - note: Layout positions and sizes under the workspace layout may be stale until the batch has
+   been committed.
+   */
+  public final func beginBatchUpdates() {
+    workspaceLayout.engine.beginTransaction()
+  }
+
+  /**
+   Commits the batch of updates opened by the most recent call to `beginBatchUpdates()`.
+   */
+  public final func commitBatchUpdates() {
+    workspaceLayout.engine.commitTransaction()
+  }
+
+  /**
+   Executes a given code block as a single batch of updates (see `beginBatchUpdates()`).
+
+   - parameter updates: The code block to execute.
+   - rethrows: Any error thrown by `updates`. The batch is still committed in this case.
+   */
+  public final func performBatchUpdates(_ updates: () throws -> Void) rethrows {
+    try workspaceLayout.engine.performTransaction(updates)
+  }
+
   /**
    Adds a block tree (a block and its children) to the workspace handled by the workspace layout
    coordinator. The layout heirarchy is automatically updated to reflect this change.
@@ -746,6 +778,12 @@ import Foundation
 
 extension WorkspaceLayoutCoordinator: WorkspaceListener {
   public func workspace(_ workspace: Workspace, didAddBlockTrees blockTrees: [Block]) {
+    // Lay out all trees together
+    beginBatchUpdates()
+    defer {
+      commitBatchUpdates()
+    }
+
     for block in blockTrees {
       do {
         // Fire creation event for the root block
@@ -777,6 +815,12 @@ extension WorkspaceLayoutCoordinator: WorkspaceListener {
   }
 
   public func workspace(_ workspace: Workspace, didRemoveBlockTrees blockTrees: [Block]) {
+    // Lay out the workspace once, after all trees have been removed
+    beginBatchUpdates()
+    defer {
+      commitBatchUpdates()
+    }
+
     for block in blockTrees {
       do {
         // Fire delete event for the root block
@@ -811,6 +855,11 @@ extension WorkspaceLayoutCoordinator: NameManagerListener {
     }
 
     // Remove each block with matching variable fields.
+    beginBatchUpdates()
+    defer {
+      commitBatchUpdates()
+    }
+
     for block in blocks {
       do {
         try removeSingleBlock(block)
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Extends `Block` with iterative traversals of its tree.
+
+ Every traversal uses an explicit stack instead of recursion, so the depth of a tree (eg. a chain of
+ 10,000 statement blocks) is limited only by memory rather than by the call stack. Sequences are
+ lazy, so callers that only need part of a tree can stop early without visiting the rest of it.
+ */
+extension Block {
+  // MARK: - Enums
+
+  /// The action to take after visiting a block in `visitBlocksInTree(includingShadows:visitor:)`.
+  public enum TreeVisitorAction {
+    case
+      /// Continue the traversal into the children of the visited block.
+      visitChildren,
+      /// Continue the traversal, but skip the children of the visited block.
+      skipChildren,
+      /// End the traversal.
+      stop
+  }
+
+  // MARK: - Public
+
+  /**
+   Returns a lazy sequence of all blocks connected to this block through its inputs and next
+   connections, including this block.
+
+   Blocks are visited in pre-order: a block is followed by the blocks connected to its inputs (in
+   input order, with a real block before its input's shadow block), and then by the blocks
+   connected to its next connection.
+
+   - parameter includingShadows: `true` if shadow blocks (and their descendants) should be
+   included in the sequence. Defaults to `true`.
+   - returns: A sequence of all blocks in this block's tree.
+   */
+  public func blocksInTree(includingShadows: Bool = true) -> BlockTreeSequence {
+    return BlockTreeSequence(rootBlock: self, includesShadows: includingShadows)
+  }
+
+  /**
+   Returns a lazy sequence of all connections directly or indirectly connected to this block.
+
+   Each connection of a block is followed by the connections of the block that it targets, unless
+   it is the block's previous or output connection.
+
+   - parameter includingShadows: `true` if the connections of shadow blocks should be included in
+   the sequence. Defaults to `false`.
+   - returns: A sequence of all connections in this block's tree.
+   */
+  public func connectionsInTree(includingShadows: Bool = false) -> ConnectionTreeSequence {
+    return ConnectionTreeSequence(rootBlock: self, includesShadows: includingShadows)
+  }
+
+  /**
+   Visits all blocks in this block's tree, in the same order as `blocksInTree(includingShadows:)`.
+   The visitor can skip the children of a block, or end the traversal early.
+
+   - parameter includingShadows: `true` if shadow blocks (and their descendants) should be
+   visited. Defaults to `true`.
+   - parameter visitor: Called for each block in the tree. Returns the action to take after
+   visiting the block.
+   - throws:
+   Rethrows any error thrown by `visitor`, which ends the traversal.
+   */
+  public func visitBlocksInTree(
+    includingShadows: Bool = true, visitor: (Block) throws -> TreeVisitorAction) rethrows
+  {
+    var iterator = BlockTreeIterator(rootBlock: self, includesShadows: includingShadows)
+    while let block = iterator.next() {
+      switch try visitor(block) {
+      case .visitChildren:
+        break
+      case .skipChildren:
+        iterator.skipChildren()
+      case .stop:
+        return
+      }
+    }
+  }
+}
+
+// MARK: - BlockTreeSequence
+
+/**
+ A lazy, pre-order sequence of the blocks in a tree. See `Block.blocksInTree(includingShadows:)`.
+ */
+public struct BlockTreeSequence: Sequence {
+  /// The block at the root of the tree
+  public let rootBlock: Block
+
+  /// `true` if shadow blocks are included in the sequence
+  public let includesShadows: Bool
+
+  public func makeIterator() -> BlockTreeIterator {
+    return BlockTreeIterator(rootBlock: rootBlock, includesShadows: includesShadows)
+  }
+}
+
+/**
+ Iterates over the blocks in a tree in pre-order, using an explicit stack.
+ */
+public struct BlockTreeIterator: IteratorProtocol {
+  /// `true` if shadow blocks are included in the traversal
+  private let _includesShadows: Bool
+
+  /// Blocks that have yet to be visited. The next block to visit is at the end.
+  private var _stack: [Block]
+
+  /// The children of the last visited block, which are at the end of `_stack`
+  private var _lastChildCount = 0
+
+  fileprivate init(rootBlock: Block, includesShadows: Bool) {
+    _includesShadows = includesShadows
+    _stack = [rootBlock]
+  }
+
+  public mutating func next() -> Block? {
+    guard let block = _stack.popLast() else {
+      return nil
+    }
+
+    // Push children in reverse order, so they're popped in order
+    let count = _stack.count
+    if let nextShadowBlock = block.nextShadowBlock, _includesShadows {
+      _stack.append(nextShadowBlock)
+    }
+    if let nextBlock = block.nextBlock {
+      _stack.append(nextBlock)
+    }
+    for input in block.inputs.reversed() {
+      if let connectedShadowBlock = input.connectedShadowBlock, _includesShadows {
+        _stack.append(connectedShadowBlock)
+      }
+      if let connectedBlock = input.connectedBlock {
+        _stack.append(connectedBlock)
+      }
+    }
+    _lastChildCount = _stack.count - count
+
+    return block
+  }
+
+  /**
+   Skips the descendants of the block that was last returned by `next()`.
+   */
+  fileprivate mutating func skipChildren() {
+    _stack.removeLast(_lastChildCount)
+    _lastChildCount = 0
+  }
+}
+
+// MARK: - ConnectionTreeSequence
+
+/**
+ A lazy sequence of the connections in a tree. See `Block.connectionsInTree(includingShadows:)`.
+ */
+public struct ConnectionTreeSequence: Sequence {
+  /// The block at the root of the tree
+  public let rootBlock: Block
+
+  /// `true` if the connections of shadow blocks are included in the sequence
+  public let includesShadows: Bool
+
+  public func makeIterator() -> ConnectionTreeIterator {
+    return ConnectionTreeIterator(rootBlock: rootBlock, includesShadows: includesShadows)
+  }
+}
+
+/**
+ Iterates over the connections in a tree, using an explicit stack.
+ */
+public struct ConnectionTreeIterator: IteratorProtocol {
+  /// A block whose connections are being visited
+  private struct Frame {
+    let block: Block
+    var connectionIndex: Int
+  }
+
+  /// `true` if the connections of shadow blocks are included in the traversal
+  private let _includesShadows: Bool
+
+  /// Blocks whose connections are being visited. The block being visited is at the end.
+  private var _stack: [Frame]
+
+  fileprivate init(rootBlock: Block, includesShadows: Bool) {
+    _includesShadows = includesShadows
+    _stack = [Frame(block: rootBlock, connectionIndex: 0)]
+  }
+
+  public mutating func next() -> Connection? {
+    while let frame = _stack.last {
+      let connections = frame.block.directConnections
+      guard frame.connectionIndex < connections.count else {
+        _stack.removeLast()
+        continue
+      }
+
+      let connection = connections[frame.connectionIndex]
+      _stack[_stack.count - 1].connectionIndex += 1
+
+      if connection !== frame.block.previousConnection &&
+        connection !== frame.block.outputConnection
+      {
+        // Visit the connections of the target block(s) before the remaining connections of this
+        // block. The shadow block is pushed first, so that it's visited after the real block.
+        if let shadowBlock = connection.shadowBlock, _includesShadows {
+          _stack.append(Frame(block: shadowBlock, connectionIndex: 0))
+        }
+        if let targetBlock = connection.targetBlock {
+          _stack.append(Frame(block: targetBlock, connectionIndex: 0))
+        }
+      }
+
+      return connection
+    }
+
+    return nil
+  }
+}
@@ -251,21 +251,11 @@ public protocol BlockListener: class {
   /**
    Returns a list of all connections directly or indirectly connected to this block.
 
+   - note: To avoid creating an array, iterate over `connectionsInTree()` instead.
    - returns: A list of all connections directly or indirectly connected to this block.
    */
   public func allConnectionsForTree() -> [Connection] {
-    var connections = [Connection]()
-
-    for connection in self.directConnections {
-      connections.append(connection)
-
-      if connection != self.previousConnection && connection != self.outputConnection &&
-        connection.targetBlock != nil {
-          connections.append(contentsOf: connection.targetBlock!.allConnectionsForTree())
-      }
-    }
-
-    return connections
+    return Array(connectionsInTree())
   }
 
   /**
@@ -308,32 +298,11 @@ public protocol BlockListener: class {
    Follows all input and next connections starting from this block and returns all blocks connected
    to this block, including this block.
 
+   - note: To avoid creating an array, iterate over `blocksInTree()` instead.
    - returns: A list of all blocks connected to this block, including this block.
    */
   public func allBlocksForTree() -> [Block] {
-    var blocks = [self]
-
-    // Follow input connections
-    for input in self.inputs {
-      if let connectedBlock = input.connectedBlock {
-        blocks.append(contentsOf: connectedBlock.allBlocksForTree())
-      }
-      if let connectedShadowBlock = input.connectedShadowBlock {
-        blocks.append(contentsOf: connectedShadowBlock.allBlocksForTree())
-      }
-    }
-
-    // Follow next connection
-    if let nextBlock = self.nextBlock {
-      blocks.append(contentsOf: nextBlock.allBlocksForTree())
-    }
-
-    // Follow next shadow connection
-    if let nextShadowBlock = self.nextShadowBlock {
-      blocks.append(contentsOf: nextShadowBlock.allBlocksForTree())
-    }
-
-    return blocks
+    return Array(blocksInTree())
   }
 
   /**
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ A persistent, on-disk cache of block definitions that have already been loaded by a
+ `BlockFactory`.
+
+ The cache stores each block definition individually, indexed by its block name, along with an
+ invalidation key that is derived from the contents of the JSON files it was built from. When
+ `BlockFactory.load(fromJSONPaths:bundle:cache:)` finds a cache whose key matches its source files,
+ it skips parsing and validating those files altogether. Each cached definition is only turned into
+ a `BlockBuilder` the first time that block is requested from the factory.
+
+ - note: Only raw block definitions are cached. Messages (eg. "%{BKY_COLOUR_HUE}"), mutators and
+ block extensions are resolved when a definition is turned into a `BlockBuilder`, so a cache remains
+ valid when the app's locale changes.
+ */
+@objc(BKYBlockDefinitionCache)
+@objcMembers public final class BlockDefinitionCache: NSObject {
+  // MARK: - Constants
+
+  /// The version of the cache file format. Cache files with a different version are ignored.
+  public static let FormatVersion = 1
+
+  /// Keys used inside the cache file.
+  fileprivate static let KEY_FORMAT_VERSION = "formatVersion"
+  fileprivate static let KEY_INVALIDATION_KEY = "key"
+  fileprivate static let KEY_DEFINITIONS = "definitions"
+
+  // MARK: - Properties
+
+  /// The location of the cache file.
+  public let fileURL: URL
+
+  /// The number of times that cached definitions were successfully read from `fileURL`.
+  public private(set) var hitCount = 0
+
+  /// The number of times that no usable definitions could be read from `fileURL` (ie. the file was
+  /// missing, corrupt, written with a different `FormatVersion` or built from different sources).
+  public private(set) var missCount = 0
+
+  // MARK: - Initializers
+
+  /**
+   Creates a cache that is stored at a given file location.
+
+   - parameter fileURL: The location of the cache file. Any intermediate directories are created
+   when the cache is first written.
+   */
+  public init(fileURL: URL) {
+    self.fileURL = fileURL
+    super.init()
+  }
+
+  /**
+   Creates a cache that is stored inside the user's caches directory.
+
+   - parameter name: The name of the cache file.
+   */
+  public convenience init(name: String) {
+    let cachesURL = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first ??
+      URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+    self.init(fileURL: cachesURL
+      .appendingPathComponent("Blockly", isDirectory: true)
+      .appendingPathComponent(name))
+  }
+
+  // MARK: - Public
+
+  /**
+   Computes the invalidation key for a list of block definition sources.
+
+   The key is a hash of `FormatVersion` and the contents of every source, in order (since later
+   sources may override block definitions from earlier ones). It is not a cryptographic hash and
+   should only be used to detect stale caches.
+
+   - parameter sources: The contents of each block definition file, in the order they are loaded.
+   - returns: The invalidation key.
+   */
+  public static func makeInvalidationKey(forSources sources: [Data]) -> String {
+    // 64-bit FNV-1a
+    var hash: UInt64 = 0xcbf29ce484222325
+    let prime: UInt64 = 0x100000001b3
+
+    func combine(_ value: UInt64) {
+      var value = value
+      for _ in 0 ..< 8 {
+        hash = (hash ^ (value & 0xff)) &* prime
+        value >>= 8
+      }
+    }
+
+    combine(UInt64(FormatVersion))
+    combine(UInt64(sources.count))
+    for source in sources {
+      // Mix in the length of each source, so moving bytes between sources changes the key
+      combine(UInt64(source.count))
+      source.withUnsafeBytes { (bytes: UnsafePointer<UInt8>) in
+        for i in 0 ..< source.count {
+          hash = (hash ^ UInt64(bytes[i])) &* prime
+        }
+      }
+    }
+
+    return String(format: "%016llx", hash)
+  }
+
+  /**
+   Deletes the cache file, if it exists.
+
+   - throws:
+   `Error`: Thrown if the file exists but could not be deleted.
+   */
+  public func invalidate() throws {
+    if FileManager.default.fileExists(atPath: fileURL.path) {
+      try FileManager.default.removeItem(at: fileURL)
+    }
+  }
+
+  // MARK: - Internal
+
+  /**
+   Reads the cached block definitions from disk.
+
+   - parameter key: The invalidation key of the sources that are being loaded.
+   - returns: The serialized JSON definition of each block, indexed by block name, or `nil` if the
+   cache file could not be read or was not built with the same `key` and `FormatVersion`.
+   */
+  internal func definitions(forKey key: String) -> [String: Data]? {
+    guard
+      let data = try? Data(contentsOf: fileURL),
+      let plist = try? PropertyListSerialization.propertyList(from: data, format: nil),
+      let contents = plist as? [String: Any],
+      contents[BlockDefinitionCache.KEY_FORMAT_VERSION] as? Int ==
+        BlockDefinitionCache.FormatVersion,
+      contents[BlockDefinitionCache.KEY_INVALIDATION_KEY] as? String == key,
+      let definitions = contents[BlockDefinitionCache.KEY_DEFINITIONS] as? [String: Data] else
+    {
+      missCount += 1
+      return nil
+    }
+
+    hitCount += 1
+    return definitions
+  }
+
+  /**
+   Writes block definitions to disk, replacing any existing cache file.
+
+   - parameter definitions: The serialized JSON definition of each block, indexed by block name.
+   - parameter key: The invalidation key of the sources that the definitions were loaded from.
+   - throws:
+   `Error`: Thrown if the cache could not be serialized or written to disk.
+   */
+  internal func store(definitions: [String: Data], forKey key: String) throws {
+    let contents: [String: Any] = [
+      BlockDefinitionCache.KEY_FORMAT_VERSION: BlockDefinitionCache.FormatVersion,
+      BlockDefinitionCache.KEY_INVALIDATION_KEY: key,
+      BlockDefinitionCache.KEY_DEFINITIONS: definitions
+    ]
+    let data = try PropertyListSerialization.data(
+      fromPropertyList: contents, format: .binary, options: 0)
+
+    try FileManager.default.createDirectory(
+      at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+    try data.write(to: fileURL, options: .atomic)
+  }
+}
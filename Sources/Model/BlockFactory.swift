@@ -27,6 +27,15 @@ import Foundation
  */
 @objc(BKYBlockFactory)
 @objcMembers public class BlockFactory : NSObject {
+  // MARK: - Enums
+
+  /// A block definition that has been loaded, but not turned into a `BlockBuilder` yet.
+  private enum PendingDefinition {
+    /// A parsed JSON block definition.
+    case json([String: Any])
+    /// A serialized JSON block definition, read from a `BlockDefinitionCache`.
+    case serialized(Data)
+  }
 
   // MARK: - Properties
 
@@ -39,6 +48,35 @@ import Foundation
   /// Dictionary of `BlockBuilder` objects indexed by their block name
   private var blockBuilders = Dictionary<String, BlockBuilder>()
 
+  /// Block definitions that have not been turned into `BlockBuilder` objects yet, indexed by their
+  /// block name
+  private var pendingDefinitions = Dictionary<String, PendingDefinition>()
+
+  /**
+   If `true`, loading JSON block definitions only indexes them by their block name. Each definition
+   is then turned into a `BlockBuilder` the first time it is requested via `blockBuilder(forName:)`
+   or `makeBlock(name:)`. This makes loading faster when only a fraction of the loaded block types
+   are used, at the cost of reporting invalid block definitions on first use, rather than when
+   they are loaded: `makeBlock(name:)` throws for an invalid definition, and
+   `blockBuilder(forName:)` returns `nil` for it.
+
+   If `false`, every block definition is turned into a `BlockBuilder` and validated when it is
+   loaded.
+
+   Defaults to `false`.
+   */
+  public var loadsBlockBuildersLazily = false
+
+  /// The number of `BlockBuilder` objects that have been built from JSON block definitions by this
+  /// factory.
+  public private(set) var builtBlockBuilderCount = 0
+
+  /// The number of loaded block definitions that have not been turned into `BlockBuilder` objects
+  /// yet.
+  public var pendingBlockBuilderCount: Int {
+    return pendingDefinitions.count
+  }
+
   // MARK: - Public
 
   /**
@@ -65,6 +103,9 @@ import Foundation
   /**
    Loads block builders from a list of files containing JSON block definitions.
 
+   If `loadsBlockBuildersLazily` is `true`, block builders are only built from these definitions
+   as they are requested.
+
    - note: This method will overwrite any existing block builders that contain the same name.
    - parameter jsonPaths: List of paths to files containing JSON block definitions.
    - parameter bundle: The bundle containing the JSON paths. If `nil` is specified,
@@ -83,16 +124,74 @@ import Foundation
       let jsonString = try String(contentsOfFile: path, encoding: String.Encoding.utf8)
       let json = try JSONHelper.makeJSONArray(string: jsonString)
       for blockJson in json {
-        let blockBuilder = try Block.makeBuilder(
-          json: blockJson as! [String : Any], mutators: mutators, extensions: blockExtensions)
+        try loadDefinition(json: blockJson as! [String : Any])
+      }
+    }
+  }
+
+  /**
+   Loads block builders from a list of files containing JSON block definitions, using a persistent
+   cache to avoid parsing and validating those files on subsequent launches.
+
+   If `cache` was built from files with identical contents, its block definitions are loaded
+   instead, and each one is only turned into a `BlockBuilder` the first time it is requested (via
+   `blockBuilder(forName:)` or `makeBlock(name:)`). Otherwise, the files are loaded normally (see
+   `load(fromJSONPaths:bundle:)`) and `cache` is rebuilt from them.
+
+   - note: This method will overwrite any existing block builders that contain the same name.
+   - parameter jsonPaths: List of paths to files containing JSON block definitions.
+   - parameter bundle: The bundle containing the JSON paths. If `nil` is specified,
+   `NSBundle.mainBundle()` is used by default.
+   - parameter cache: The cache to read block definitions from, or to rebuild if it is stale.
+   - throws:
+   `BlocklyError`: Thrown if a JSON file could not be found or read, or if the JSON contains
+   invalid block definition(s).
+   */
+  public func load(
+    fromJSONPaths jsonPaths: [String], bundle: Bundle? = nil, cache: BlockDefinitionCache) throws
+  {
+    let aBundle = (bundle ?? Bundle.main)
+    var sources = [Data]()
 
-        // Ensure the builder is valid
-        _ = try blockBuilder.makeBlock()
+    // The files still need to be read to compute the cache's invalidation key, but reading them is
+    // cheap compared to parsing them.
+    for jsonPath in jsonPaths {
+      guard let path = aBundle.path(forResource: jsonPath, ofType: nil) else {
+        throw BlocklyError(.fileNotFound, "Could not find \"\(jsonPath)\" in bundle [\(aBundle)]")
+      }
+      sources.append(try Data(contentsOf: URL(fileURLWithPath: path)))
+    }
 
-        // Save the block builder
-        setBlockBuilder(blockBuilder, forName: blockBuilder.name)
+    let key = BlockDefinitionCache.makeInvalidationKey(forSources: sources)
+
+    if let definitions = cache.definitions(forKey: key) {
+      for (name, definition) in definitions {
+        blockBuilders[name] = nil
+        pendingDefinitions[name] = .serialized(definition)
+      }
+      return
+    }
+
+    var definitions = [String: Data]()
+
+    for source in sources {
+      guard let jsonString = String(data: source, encoding: .utf8) else {
+        throw BlocklyError(.jsonParsing, "Could not read block definition file as UTF-8.")
+      }
+      let json = try JSONHelper.makeJSONArray(string: jsonString)
+      for blockJson in json {
+        let blockJson = blockJson as! [String : Any]
+        let name = try loadDefinition(json: blockJson)
+        definitions[name] = try JSONSerialization.data(withJSONObject: blockJson)
       }
     }
+
+    do {
+      try cache.store(definitions: definitions, forKey: key)
+    } catch let error {
+      // The block builders have been loaded, so the cache simply won't be used next time
+      bky_print("Could not write block definition cache to \(cache.fileURL): \(error)")
+    }
   }
 
   /**
@@ -105,6 +204,7 @@ import Foundation
   public func setBlockBuilder(_ blockBuilder: BlockBuilder, forName name: String) {
     blockBuilder.name = name
     blockBuilders[name] = blockBuilder
+    pendingDefinitions[name] = nil
   }
 
   /**
@@ -112,10 +212,16 @@ import Foundation
 
    - parameter name: The block name to search for the block builder.
    - returns: The `BlockBuilder` matching the given `name` or `nil` if no block builder could be
-   found.
+   found, or if its lazily loaded definition is invalid (see `loadsBlockBuildersLazily`). Use
+   `makeBlock(name:)` to find out why a definition is invalid.
    */
   public func blockBuilder(forName name: String) -> BlockBuilder? {
-    return blockBuilders[name]
+    do {
+      return try materializedBlockBuilder(forName: name)
+    } catch let error {
+      bky_print("Could not create block builder for \"\(name)\": \(error)")
+      return nil
+    }
   }
 
   /**
@@ -173,7 +279,7 @@ import Foundation
    - returns: A new `Block`.
    */
   public func makeBlock(name: String, shadow: Bool, uuid: String? = nil) throws -> Block {
-    guard let blockBuilder = blockBuilders[name] else {
+    guard let blockBuilder = try materializedBlockBuilder(forName: name) else {
       throw BlocklyError(.illegalArgument,
                          "No block named '\(name)' has been added to this block factory.")
     }
@@ -199,4 +305,91 @@ import Foundation
     try workspace.addBlockTree(block)
     return block
   }
+
+  // MARK: - Private
+
+  /**
+   Adds a JSON block definition to the factory. If `loadsBlockBuildersLazily` is `true`, the
+   definition is indexed by its block name. Otherwise, a block builder is created from it,
+   validated, and saved to the factory.
+
+   - parameter json: The JSON block definition.
+   - throws:
+   `BlocklyError`: Thrown if the JSON contains an invalid block definition.
+   - returns: The block name of the definition.
+   */
+  @discardableResult
+  private func loadDefinition(json: [String: Any]) throws -> String {
+    if loadsBlockBuildersLazily {
+      guard let name = json["type"] as? String else {
+        throw BlocklyError(.invalidBlockDefinition, "Block definition is missing a \"type\".")
+      }
+      blockBuilders[name] = nil
+      pendingDefinitions[name] = .json(json)
+      return name
+    }
+
+    let blockBuilder = try makeBlockBuilder(json: json)
+
+    // Ensure the builder is valid
+    _ = try blockBuilder.makeBlock()
+
+    // Save the block builder
+    setBlockBuilder(blockBuilder, forName: blockBuilder.name)
+    return blockBuilder.name
+  }
+
+  /**
+   Creates a block builder from a JSON block definition, using the factory's mutators and block
+   extensions.
+
+   - parameter json: The JSON block definition.
+   - throws:
+   `BlocklyError`: Thrown if the JSON contains an invalid block definition.
+   - returns: The new block builder.
+   */
+  private func makeBlockBuilder(json: [String: Any]) throws -> BlockBuilder {
+    let blockBuilder = try Block.makeBuilder(
+      json: json, mutators: mutators, extensions: blockExtensions)
+    builtBlockBuilderCount += 1
+    return blockBuilder
+  }
+
+  /**
+   Returns the block builder for a given block name, creating it from its pending definition if it
+   hasn't been created yet.
+
+   - parameter name: The block name to search for the block builder.
+   - throws:
+   `BlocklyError`: Thrown if the pending definition could not be turned into a block builder. The
+   definition is kept, so later lookups report the same error.
+   - returns: The `BlockBuilder` matching the given `name` or `nil` if no block builder could be
+   found.
+   */
+  private func materializedBlockBuilder(forName name: String) throws -> BlockBuilder? {
+    if let blockBuilder = blockBuilders[name] {
+      return blockBuilder
+    }
+    guard let definition = pendingDefinitions[name] else {
+      return nil
+    }
+
+    let json: [String: Any]
+    switch definition {
+    case .json(let value):
+      json = value
+    case .serialized(let data):
+      guard let value = try JSONSerialization.jsonObject(with: data) as? [String: Any] else {
+        throw BlocklyError(.jsonInvalidTypecast,
+          "Could not convert cached definition of \"\(name)\" to Dictionary<String, Any>")
+      }
+      json = value
+    }
+
+    // Any problems with the definition surface when the first block is made from this builder, so
+    // skip validating it here
+    let blockBuilder = try makeBlockBuilder(json: json)
+    setBlockBuilder(blockBuilder, forName: name)
+    return blockBuilder
+  }
 }
@@ -29,11 +29,33 @@ extension BlocklyEvent {
     public static let EVENT_TYPE = "create"
 
     /// The XML serialization of all blocks created by this event.
-    public let xml: String
+    /// - note: The XML is only rendered the first time this property is read, from a snapshot of
+    /// the blocks taken when the event was created.
+    public var xml: String {
+      if let xml = _xml {
+        return xml
+      }
+      let xml = _snapshot?.xmlString() ?? ""
+      _xml = xml
+      _snapshot = nil
+      return xml
+    }
 
     /// The list of block ids for all blocks created by this event.
     public let blockIDs: [String]
 
+    /// The XML serialization of all blocks created by this event, if it has been rendered.
+    private var _xml: String?
+
+    /// Snapshot of all blocks created by this event, used to render `xml`.
+    private var _snapshot: BlockXMLSnapshot?
+
+    /// The estimated number of bytes used to store the blocks created by this event, whether
+    /// they're stored as a snapshot or as rendered XML.
+    internal var estimatedXMLByteCount: Int {
+      return _xml?.utf8.count ?? _snapshot?.estimatedByteCount ?? 0
+    }
+
     // MARK: - Initializers
 
     /**
@@ -45,8 +67,9 @@ extension BlocklyEvent {
      `BlocklyError`: Thrown if the given block tree could not be serialized into xml.
      */
     public init(workspace: Workspace, block: Block) throws {
-      xml = try block.toXML()
-      blockIDs = block.allBlocksForTree().map { $0.uuid }
+      let snapshot = try BlockXMLSnapshot(block: block)
+      _snapshot = snapshot
+      blockIDs = snapshot.allBlockUUIDs
 
       super.init(
         type: Create.EVENT_TYPE, workspaceID: workspace.uuid, groupID: nil, blockID: block.uuid)
@@ -60,7 +83,7 @@ extension BlocklyEvent {
      `BlocklyError`: Thrown when the JSON could not be parsed into a `BlocklyEvent.Create` object.
      */
     public init(json: [String: Any]) throws {
-      xml = json[BlocklyEvent.JSON_XML] as? String ?? ""
+      _xml = json[BlocklyEvent.JSON_XML] as? String ?? ""
       blockIDs = json[BlocklyEvent.JSON_IDS] as? [String] ?? []
       try super.init(type: BlocklyEvent.Create.EVENT_TYPE, json: json)
 
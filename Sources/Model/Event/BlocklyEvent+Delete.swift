@@ -28,11 +28,33 @@ extension BlocklyEvent {
     public static let EVENT_TYPE = "delete"
 
     /// The XML serialization of all blocks deleted by this event.
-    public let oldXML: String
+    /// - note: The XML is only rendered the first time this property is read, from a snapshot of
+    /// the blocks taken when the event was created.
+    public var oldXML: String {
+      if let oldXML = _oldXML {
+        return oldXML
+      }
+      let oldXML = _snapshot?.xmlString() ?? ""
+      _oldXML = oldXML
+      _snapshot = nil
+      return oldXML
+    }
 
     /// The list of all block ids for all blocks deleted by this event.
     public let blockIDs: [String]
 
+    /// The XML serialization of all blocks deleted by this event, if it has been rendered.
+    private var _oldXML: String?
+
+    /// Snapshot of all blocks deleted by this event, used to render `oldXML`.
+    private var _snapshot: BlockXMLSnapshot?
+
+    /// The estimated number of bytes used to store the blocks deleted by this event, whether
+    /// they're stored as a snapshot or as rendered XML.
+    internal var estimatedXMLByteCount: Int {
+      return _oldXML?.utf8.count ?? _snapshot?.estimatedByteCount ?? 0
+    }
+
     // MARK: - Initializers
 
     /**
@@ -44,8 +66,9 @@ extension BlocklyEvent {
      `BlocklyError`: Thrown if the given block tree could not be serialized into xml.
      */
     public init(workspace: Workspace, block: Block) throws {
-      oldXML = try block.toXML()
-      blockIDs = block.allBlocksForTree().map { $0.uuid }
+      let snapshot = try BlockXMLSnapshot(block: block)
+      _snapshot = snapshot
+      blockIDs = snapshot.allBlockUUIDs
 
       super.init(
         type: Delete.EVENT_TYPE, workspaceID: workspace.uuid, groupID: nil, blockID: block.uuid)
@@ -59,7 +82,7 @@ extension BlocklyEvent {
      `BlocklyError`: Thrown when the JSON could not be parsed into a `BlocklyEvent.Delete` object.
      */
     public init(json: [String: Any]) throws {
-      oldXML = json[BlocklyEvent.JSON_OLD_VALUE] as? String ?? "" // Not usually used.
+      _oldXML = json[BlocklyEvent.JSON_OLD_VALUE] as? String ?? "" // Not usually used.
       blockIDs = json[BlocklyEvent.JSON_IDS] as? [String] ?? []
 
       try super.init(type: BlocklyEvent.Delete.EVENT_TYPE, json: json)
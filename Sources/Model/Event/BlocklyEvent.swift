@@ -169,29 +169,93 @@ extension Array where Element: BlocklyEvent {
   }
 
   /**
-   Merges all events in the array, from beginning to end, by repeatedly calling
-   `merged(withNextChronologicalEvent:)` on adjacent events.
+   Merges all events in the array, from beginning to end, by calling
+   `merged(withNextChronologicalEvent:)` on events that affect the same block.
+
+   Events don't need to be adjacent in order to be merged. For example, the `BlocklyEvent.Move`
+   events of a block that is dragged around are merged even if `BlocklyEvent.Change` events for
+   the same block were fired in between. The merged event takes the position of the earliest event
+   it was merged from.
+
+   To preserve the causal order of events, events are only merged if:
+   - They share the same workspace, group, block and type, and in the case of `BlocklyEvent.Change`
+   events, the same element and field name.
+   - No `BlocklyEvent.Create`, `BlocklyEvent.Delete` or block mutation event was fired between
+   them, since those events can change which blocks and inputs exist.
+   - No event for the same block was fired between them in a different group.
+   - In the case of `BlocklyEvent.Move` events, no other block was connected to or disconnected
+   from a parent between them. Otherwise, merging would move a connection change past another
+   block's connection change, and undoing or redoing it would target an occupied input.
+
+   Only the last matching event is considered for each merge, so this runs in linear time, relative
+   to the number of events.
 
    - returns: An array of merged events.
    - note: This method assumes that the array is sorted in chronological
    order.
    */
   public func merged() -> [BlocklyEvent] {
-    var mergedEvents = self
-
-    var i = 0
-    while (i + 1) < mergedEvents.count {
-      let event1 = mergedEvents[i]
-      let event2 = mergedEvents[i + 1]
-
-      if let mergedEvent = event1.merged(withNextChronologicalEvent: event2) {
-        // Replace event1 and event2 with merged event. Don't iterate `i` since this new merged
-        // event could be merged with the next event.
-        mergedEvents.removeSubrange(i...(i + 1))
-        mergedEvents.insert(mergedEvent as! Element, at: i)
+    var mergedEvents = [BlocklyEvent]()
+    mergedEvents.reserveCapacity(count)
+
+    // Index inside `mergedEvents` of the last event that a later event may be merged into, keyed
+    // by workspace, group, block, event type, change element and field name.
+    var mergeCandidates = [String: Int]()
+    // The group and generation of the last event for each block. The generation is bumped whenever
+    // events for a block switch to a different group, which stops earlier events from merging.
+    var blockGenerations = [String: (groupID: String?, generation: Int)]()
+    // Bumped whenever an event is fired that nothing can be merged across.
+    var epoch = 0
+    // Bumped whenever a different block than the last one changes its parent, which stops move
+    // events from being merged across another block's connection change.
+    var connectionEpoch = 0
+    var lastConnectionBlockKey: String?
+
+    for event in self {
+      if event is BlocklyEvent.Create || event is BlocklyEvent.Delete ||
+        (event as? BlocklyEvent.Change)?.element == BlocklyEvent.Change.elementMutate
+      {
+        mergedEvents.append(event)
+        epoch += 1
+        continue
+      }
+
+      guard let blockID = event.blockID else {
+        mergedEvents.append(event)
+        continue
+      }
+
+      let blockKey = event.workspaceID + "\n" + blockID
+      var generation = 0
+      if let last = blockGenerations[blockKey] {
+        generation = last.groupID == event.groupID ? last.generation : last.generation + 1
+      }
+      blockGenerations[blockKey] = (event.groupID, generation)
+
+      var moveEpoch = ""
+      if let moveEvent = event as? BlocklyEvent.Move {
+        if (moveEvent.oldParentID != nil || moveEvent.newParentID != nil) &&
+          lastConnectionBlockKey != blockKey
+        {
+          connectionEpoch += 1
+          lastConnectionBlockKey = blockKey
+        }
+        moveEpoch = String(connectionEpoch)
+      }
+
+      let changeEvent = event as? BlocklyEvent.Change
+      let key = [
+        blockKey, event.groupID ?? "", event.type, changeEvent?.element ?? "",
+        changeEvent?.fieldName ?? "", String(generation), String(epoch), moveEpoch
+      ].joined(separator: "\n")
+
+      if let index = mergeCandidates[key],
+        let mergedEvent = mergedEvents[index].merged(withNextChronologicalEvent: event)
+      {
+        mergedEvents[index] = mergedEvent
       } else {
-        // Events couldn't be merged, iterate to next event
-        i += 1
+        mergeCandidates[key] = mergedEvents.count
+        mergedEvents.append(event)
       }
     }
 
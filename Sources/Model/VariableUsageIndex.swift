@@ -0,0 +1,183 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Incrementally indexes the `FieldVariable` instances of a set of blocks by their variable name, so
+ that all usages of a variable can be found without scanning every block.
+
+ The index listens to each of its blocks and variable fields. It's updated when a variable field
+ changes its variable, and when a block is updated (eg. its inputs have been replaced by a
+ mutator).
+ */
+internal final class VariableUsageIndex: NSObject {
+  // MARK: - Properties
+
+  /// A variable field, along with the block that owns it
+  private struct Usage {
+    let field: FieldVariable
+    let block: Block
+  }
+
+  /// Usages of each variable name, keyed by the identity of their field
+  private var _usagesByName = [String: [ObjectIdentifier: Usage]]()
+
+  /// The variable name that each field is indexed under, keyed by the identity of the field
+  private var _namesByField = [ObjectIdentifier: String]()
+
+  /// The variable fields of each indexed block, keyed by the identity of the block
+  private var _fieldsByBlock = [ObjectIdentifier: [FieldVariable]]()
+
+  /// The number of distinct variable names currently in use
+  var variableNameCount: Int {
+    return _usagesByName.count
+  }
+
+  // MARK: - Public
+
+  /**
+   Adds the variable fields of a block to the index. If the block is already indexed, this does
+   nothing.
+
+   - parameter block: The block to add.
+   */
+  func addBlock(_ block: Block) {
+    guard _fieldsByBlock[ObjectIdentifier(block)] == nil else {
+      return
+    }
+
+    block.listeners.add(self)
+    indexFields(variableFields(of: block), of: block)
+  }
+
+  /**
+   Removes the variable fields of a block from the index.
+
+   - parameter block: The block to remove.
+   */
+  func removeBlock(_ block: Block) {
+    block.listeners.remove(self)
+    unindexFields(of: block)
+  }
+
+  /**
+   Returns all variable fields that use a given variable name.
+
+   - parameter name: The variable name.
+   - returns: The variable fields using `name`, in no particular order.
+   */
+  func fields(forName name: String) -> [FieldVariable] {
+    return _usagesByName[name]?.values.map { $0.field } ?? []
+  }
+
+  /**
+   Returns the blocks of all variable fields that use a given variable name. A block appears once
+   for each of its fields that uses the name.
+
+   - parameter name: The variable name.
+   - returns: The blocks using `name`, in no particular order.
+   */
+  func blocks(forName name: String) -> [Block] {
+    return _usagesByName[name]?.values.map { $0.block } ?? []
+  }
+
+  // MARK: - Private
+
+  private func variableFields(of block: Block) -> [FieldVariable] {
+    var fields = [FieldVariable]()
+    for input in block.inputs {
+      for case let field as FieldVariable in input.fields {
+        fields.append(field)
+      }
+    }
+    return fields
+  }
+
+  private func indexFields(_ fields: [FieldVariable], of block: Block) {
+    // Blocks without variable fields are still recorded, so they're only added once
+    _fieldsByBlock[ObjectIdentifier(block)] = fields
+
+    for field in fields {
+      field.listeners.add(self)
+      addUsage(Usage(field: field, block: block), forName: field.variable)
+    }
+  }
+
+  private func unindexFields(of block: Block) {
+    guard let fields = _fieldsByBlock.removeValue(forKey: ObjectIdentifier(block)) else {
+      return
+    }
+
+    for field in fields {
+      field.listeners.remove(self)
+      removeUsage(of: field)
+    }
+  }
+
+  private func addUsage(_ usage: Usage, forName name: String) {
+    let fieldID = ObjectIdentifier(usage.field)
+    _namesByField[fieldID] = name
+    _usagesByName[name, default: [:]][fieldID] = usage
+  }
+
+  @discardableResult
+  private func removeUsage(of field: FieldVariable) -> Usage? {
+    let fieldID = ObjectIdentifier(field)
+    guard let name = _namesByField.removeValue(forKey: fieldID) else {
+      return nil
+    }
+
+    let usage = _usagesByName[name]?.removeValue(forKey: fieldID)
+    if _usagesByName[name]?.isEmpty ?? false {
+      _usagesByName[name] = nil
+    }
+    return usage
+  }
+}
+
+// MARK: - FieldListener Implementation
+
+extension VariableUsageIndex: FieldListener {
+  func didUpdateField(_ field: Field) {
+    guard let variableField = field as? FieldVariable,
+      let name = _namesByField[ObjectIdentifier(variableField)],
+      name != variableField.variable,
+      let usage = removeUsage(of: variableField) else
+    {
+      return
+    }
+
+    // Move the field to its new variable name
+    addUsage(usage, forName: variableField.variable)
+  }
+}
+
+// MARK: - BlockListener Implementation
+
+extension VariableUsageIndex: BlockListener {
+  func didUpdateBlock(_ block: Block) {
+    // Only re-index the block if its variable fields have changed (eg. its inputs were replaced)
+    let fields = variableFields(of: block)
+    if let indexedFields = _fieldsByBlock[ObjectIdentifier(block)],
+      indexedFields.elementsEqual(fields, by: ===)
+    {
+      return
+    }
+
+    unindexFields(of: block)
+    indexFields(fields, of: block)
+  }
+}
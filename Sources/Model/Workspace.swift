@@ -99,6 +99,9 @@ Data structure that contains `Block` instances.
   /// The layout associated with this workspace
   public weak var layout: WorkspaceLayout?
 
+  /// Index of the variable fields of all blocks in this workspace, by variable name
+  fileprivate let _variableUsageIndex = VariableUsageIndex()
+
   /// Specifies the type of workspace this one is.
   internal enum WorkspaceType: Int {
     case
@@ -183,7 +186,7 @@ Data structure that contains `Block` instances.
           "A non-top level block tree cannot be added to the workspace.")
       }
 
-      for block in rootBlock.allBlocksForTree() {
+      for block in rootBlock.blocksInTree() {
         if allBlocks[block.uuid] != nil {
           throw BlocklyError(.illegalState,
             "A block cannot be added into the workspace with a uuid ('\(block.uuid)') " +
@@ -217,6 +220,7 @@ Data structure that contains `Block` instances.
     for (_, block) in newBlocks {
       block.editable = block.editable && !readOnly
       allBlocks[block.uuid] = block
+      _variableUsageIndex.addBlock(block)
     }
 
     // Notify delegate for each block addition, now that all of them have been added to the
@@ -254,15 +258,20 @@ Data structure that contains `Block` instances.
     // Fire listeners for block trees that will be removed from the workspace
     listeners.forEach { $0.workspace?(self, willRemoveBlockTrees: rootBlocks) }
 
+    // Listeners may have already removed some of these trees (eg. the callers of a procedure
+    // definition that is being removed), so only remove the ones that are left
+    let removedRootBlocks = rootBlocks.filter { containsBlock($0) }
+
     // Remove blocks at the same time
-    for rootBlock in rootBlocks {
-      for block in rootBlock.allBlocksForTree() {
+    for rootBlock in removedRootBlocks {
+      for block in rootBlock.blocksInTree() {
         allBlocks[block.uuid] = nil
+        _variableUsageIndex.removeBlock(block)
       }
     }
 
     // Fire listeners for all blocks that were removed
-    listeners.forEach { $0.workspace?(self, didRemoveBlockTrees: rootBlocks) }
+    listeners.forEach { $0.workspace?(self, didRemoveBlockTrees: removedRootBlocks) }
   }
 
   /**
@@ -319,10 +328,17 @@ Data structure that contains `Block` instances.
    */
   open func deactivateBlockTrees(forGroupsGreaterThan threshold: Int) {
     for rootBlock in topLevelBlocks() {
-      let blocks = rootBlock.allBlocksForTree()
-      let deactivated = blocks.count > threshold
+      // Only count as many blocks as needed to exceed the threshold
+      var blockCount = 0
+      for _ in rootBlock.blocksInTree() {
+        blockCount += 1
+        if blockCount > threshold {
+          break
+        }
+      }
+      let deactivated = blockCount > threshold
 
-      for block in blocks {
+      for block in rootBlock.blocksInTree() {
         block.disabled = deactivated
         block.editable = !deactivated && !readOnly
         block.movable = !deactivated
@@ -331,24 +347,24 @@ Data structure that contains `Block` instances.
   }
 
   /**
-   Finds all blocks that have a field using a specific variable name.
+   Finds all blocks that have a field using a specific variable name. A block is returned once for
+   each of its fields that uses the variable.
+
+   This is looked up from an index that is kept up-to-date as blocks are added to/removed from the
+   workspace and as variable fields change, so it only costs as much as the number of usages.
 
    - param name: The name to search
    */
   public func allVariableBlocks(forName name: String) -> [Block] {
-    var variableBlocks: [Block] = []
-    for (_, block) in allBlocks {
-      for input in block.inputs {
-        for field in input.fields {
-          if let varField = field as? FieldVariable,
-            varField.variable == name
-          {
-            variableBlocks.append(block)
-          }
-        }
-      }
-    }
+    return _variableUsageIndex.blocks(forName: name)
+  }
 
-    return variableBlocks
+  /**
+   Finds all variable fields in this workspace that use a specific variable name.
+
+   - param name: The name to search
+   */
+  public func allVariableFields(forName name: String) -> [FieldVariable] {
+    return _variableUsageIndex.fields(forName: name)
   }
 }
@@ -0,0 +1,480 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+import AEXML
+
+/**
+ Encodes and decodes workspaces using a compact, versioned binary format. Snapshots are intended
+ for frequent save/restore operations (eg. autosave), where XML serialization is too expensive.
+
+ A snapshot contains:
+ - A header, consisting of the bytes "BKYS" followed by the format version.
+ - A string table, containing every string in the snapshot (block types, uuids, field names and
+ values, input names, and mutation XML) exactly once.
+ - The top-level block trees, where every string is referenced by its index in the string table
+ and all integers are stored as variable-length integers (varints).
+
+ Snapshots store the same information as XML (plus block comments), so workspaces can be freely
+ converted between the two formats.
+ */
+@objc(BKYWorkspaceSnapshot)
+@objcMembers public final class WorkspaceSnapshot: NSObject {
+  // MARK: - Constants
+
+  /// The current version of the snapshot format.
+  public static let FormatVersion = 1
+
+  /// The bytes that every snapshot starts with.
+  fileprivate static let MagicBytes: [UInt8] = Array("BKYS".utf8)
+
+  /// Flags describing the state of a block.
+  fileprivate struct BlockFlags: OptionSet {
+    let rawValue: UInt64
+
+    static let shadow = BlockFlags(rawValue: 1 << 0)
+    static let disabled = BlockFlags(rawValue: 1 << 1)
+    static let deletable = BlockFlags(rawValue: 1 << 2)
+    static let movable = BlockFlags(rawValue: 1 << 3)
+    static let editable = BlockFlags(rawValue: 1 << 4)
+    static let inputsInline = BlockFlags(rawValue: 1 << 5)
+    static let hasPosition = BlockFlags(rawValue: 1 << 6)
+    static let hasMutation = BlockFlags(rawValue: 1 << 7)
+    static let hasComment = BlockFlags(rawValue: 1 << 8)
+    static let hasNextBlock = BlockFlags(rawValue: 1 << 9)
+    static let hasNextShadowBlock = BlockFlags(rawValue: 1 << 10)
+  }
+
+  /// Flags describing which blocks are connected to an input.
+  fileprivate struct InputFlags: OptionSet {
+    let rawValue: UInt64
+
+    static let hasBlock = InputFlags(rawValue: 1 << 0)
+    static let hasShadowBlock = InputFlags(rawValue: 1 << 1)
+  }
+
+  // MARK: - Encoding
+
+  /**
+   Creates a snapshot of the current state of a workspace.
+
+   - parameter workspace: The workspace to encode.
+   - returns: The snapshot data.
+   - throws:
+   `BlocklyError`: Thrown if there was an error encoding any of the blocks in the workspace.
+   */
+  public static func makeData(forWorkspace workspace: Workspace) throws -> Data {
+    var encoder = SnapshotEncoder()
+    let topLevelBlocks = workspace.topLevelBlocks()
+
+    encoder.writeVarint(UInt64(topLevelBlocks.count))
+    for block in topLevelBlocks {
+      try encoder.writeBlock(block)
+    }
+
+    return encoder.makeData()
+  }
+
+  /**
+   Converts workspace XML into a snapshot.
+
+   - parameter xmlString: The workspace XML.
+   - parameter factory: The `BlockFactory` used to build blocks from the XML.
+   - returns: The snapshot data.
+   - throws:
+   `BlocklyError`: Thrown if the XML could not be parsed or the snapshot could not be created.
+   */
+  public static func makeData(fromXMLString xmlString: String, factory: BlockFactory) throws
+    -> Data
+  {
+    let workspace = Workspace()
+    try workspace.loadBlocks(fromXMLString: xmlString, factory: factory)
+    return try makeData(forWorkspace: workspace)
+  }
+
+  // MARK: - Decoding
+
+  /**
+   Creates block trees from a snapshot.
+
+   - parameter data: The snapshot data.
+   - parameter factory: The `BlockFactory` used to build blocks.
+   - returns: A list of all top-level block trees in the snapshot.
+   - throws:
+   `BlocklyError`: Thrown if the snapshot is invalid, was created with an unsupported format
+   version, or references block types that are unknown to `factory`.
+   */
+  public static func blockTrees(fromData data: Data, factory: BlockFactory) throws
+    -> [Block.BlockTree]
+  {
+    var decoder = try SnapshotDecoder(data: data, factory: factory)
+    var blockTrees = [Block.BlockTree]()
+    let count = try decoder.readCount()
+
+    for _ in 0 ..< count {
+      var allBlocks = [Block]()
+      let rootBlock = try decoder.readBlock(allBlocks: &allBlocks)
+      blockTrees.append(Block.BlockTree(rootBlock: rootBlock, allBlocks: allBlocks))
+    }
+
+    guard decoder.isAtEnd else {
+      throw BlocklyError(.snapshotParsing, "Unexpected data at the end of the snapshot.")
+    }
+
+    return blockTrees
+  }
+
+  /**
+   Converts a snapshot into workspace XML.
+
+   - parameter data: The snapshot data.
+   - parameter factory: The `BlockFactory` used to build blocks from the snapshot.
+   - returns: The workspace XML.
+   - throws:
+   `BlocklyError`: Thrown if the snapshot could not be decoded or the XML could not be created.
+   */
+  public static func xmlString(fromData data: Data, factory: BlockFactory) throws -> String {
+    let workspace = Workspace()
+    try workspace.load(snapshot: data, factory: factory)
+    return try workspace.toXML()
+  }
+}
+
+// MARK: - Workspace Snapshots
+
+extension Workspace {
+  /**
+   Returns a binary snapshot of the current state of this workspace. See `WorkspaceSnapshot` for
+   details on the format.
+
+   - returns: The snapshot data.
+   - throws:
+   `BlocklyError`: Thrown if there was an error encoding any of the blocks in the workspace.
+   */
+  public func snapshotData() throws -> Data {
+    return try WorkspaceSnapshot.makeData(forWorkspace: self)
+  }
+
+  /**
+   Loads blocks from a binary snapshot into the workspace.
+
+   - parameter snapshot: The snapshot data, created by `snapshotData()`.
+   - parameter factory: The `BlockFactory` to use to build blocks.
+   - throws:
+   `BlocklyError`: Thrown if the snapshot is invalid, was created with an unsupported format
+   version, or references block types that are unknown to `factory`.
+   */
+  public func load(snapshot: Data, factory: BlockFactory) throws {
+    let blockTrees = try WorkspaceSnapshot.blockTrees(fromData: snapshot, factory: factory)
+    try addBlockTrees(blockTrees.map({ $0.rootBlock }))
+  }
+}
+
+// MARK: - SnapshotEncoder
+
+fileprivate struct SnapshotEncoder {
+  /// Maps each string to its index in `_strings`
+  private var _stringIndices = [String: Int]()
+  private var _strings = [String]()
+  private var _body = [UInt8]()
+
+  mutating func writeBlock(_ block: Block) throws {
+    var flags = WorkspaceSnapshot.BlockFlags()
+    if block.shadow { flags.insert(.shadow) }
+    if block.disabled { flags.insert(.disabled) }
+    if block.deletable { flags.insert(.deletable) }
+    if block.movable { flags.insert(.movable) }
+    if block.editable { flags.insert(.editable) }
+    if block.inputsInline { flags.insert(.inputsInline) }
+    if block.topLevel { flags.insert(.hasPosition) }
+    if block.mutator != nil { flags.insert(.hasMutation) }
+    if !block.comment.isEmpty { flags.insert(.hasComment) }
+    if block.nextBlock != nil { flags.insert(.hasNextBlock) }
+    if block.nextShadowBlock != nil { flags.insert(.hasNextShadowBlock) }
+
+    writeVarint(flags.rawValue)
+    writeString(block.name)
+    writeString(block.uuid)
+
+    if block.topLevel {
+      writeSignedVarint(Int64(floor(block.position.x)))
+      writeSignedVarint(Int64(floor(block.position.y)))
+    }
+    if let mutator = block.mutator {
+      writeString(mutator.toXMLElement().xml)
+    }
+    if !block.comment.isEmpty {
+      writeString(block.comment)
+    }
+
+    // Fields
+    var fieldValues = [(name: String, value: String)]()
+    for input in block.inputs {
+      for field in input.fields {
+        if let serializedText = try field.serializedText() {
+          fieldValues.append((name: field.name, value: serializedText))
+        }
+      }
+    }
+    writeVarint(UInt64(fieldValues.count))
+    for fieldValue in fieldValues {
+      writeString(fieldValue.name)
+      writeString(fieldValue.value)
+    }
+
+    // Connected inputs
+    let connectedInputs = block.inputs.filter {
+      $0.connectedBlock != nil || $0.connectedShadowBlock != nil
+    }
+    writeVarint(UInt64(connectedInputs.count))
+    for input in connectedInputs {
+      var inputFlags = WorkspaceSnapshot.InputFlags()
+      if input.connectedBlock != nil { inputFlags.insert(.hasBlock) }
+      if input.connectedShadowBlock != nil { inputFlags.insert(.hasShadowBlock) }
+
+      writeString(input.name)
+      writeVarint(inputFlags.rawValue)
+      if let connectedBlock = input.connectedBlock {
+        try writeBlock(connectedBlock)
+      }
+      if let connectedShadowBlock = input.connectedShadowBlock {
+        try writeBlock(connectedShadowBlock)
+      }
+    }
+
+    // Next statement
+    if let nextBlock = block.nextBlock {
+      try writeBlock(nextBlock)
+    }
+    if let nextShadowBlock = block.nextShadowBlock {
+      try writeBlock(nextShadowBlock)
+    }
+  }
+
+  mutating func writeString(_ string: String) {
+    if let index = _stringIndices[string] {
+      writeVarint(UInt64(index))
+    } else {
+      let index = _strings.count
+      _stringIndices[string] = index
+      _strings.append(string)
+      writeVarint(UInt64(index))
+    }
+  }
+
+  mutating func writeVarint(_ value: UInt64) {
+    SnapshotEncoder.appendVarint(value, to: &_body)
+  }
+
+  mutating func writeSignedVarint(_ value: Int64) {
+    // Zig-zag encode the value, so small negative numbers also use few bytes
+    writeVarint(UInt64(bitPattern: (value << 1) ^ (value >> 63)))
+  }
+
+  func makeData() -> Data {
+    var header = WorkspaceSnapshot.MagicBytes
+    SnapshotEncoder.appendVarint(UInt64(WorkspaceSnapshot.FormatVersion), to: &header)
+
+    // String table
+    SnapshotEncoder.appendVarint(UInt64(_strings.count), to: &header)
+    for string in _strings {
+      let utf8 = Array(string.utf8)
+      SnapshotEncoder.appendVarint(UInt64(utf8.count), to: &header)
+      header.append(contentsOf: utf8)
+    }
+
+    var data = Data(capacity: header.count + _body.count)
+    data.append(contentsOf: header)
+    data.append(contentsOf: _body)
+    return data
+  }
+
+  private static func appendVarint(_ value: UInt64, to bytes: inout [UInt8]) {
+    var remaining = value
+    while remaining >= 0x80 {
+      bytes.append(UInt8(truncatingIfNeeded: remaining) | 0x80)
+      remaining >>= 7
+    }
+    bytes.append(UInt8(remaining))
+  }
+}
+
+// MARK: - SnapshotDecoder
+
+fileprivate struct SnapshotDecoder {
+  private let _bytes: [UInt8]
+  private var _offset = 0
+  private var _strings = [String]()
+  private let _factory: BlockFactory
+
+  var isAtEnd: Bool {
+    return _offset == _bytes.count
+  }
+
+  init(data: Data, factory: BlockFactory) throws {
+    _bytes = [UInt8](data)
+    _factory = factory
+
+    let magicBytes = WorkspaceSnapshot.MagicBytes
+    guard _bytes.count >= magicBytes.count &&
+      Array(_bytes[0 ..< magicBytes.count]) == magicBytes else
+    {
+      throw BlocklyError(.snapshotParsing, "The data is not a workspace snapshot.")
+    }
+    _offset = magicBytes.count
+
+    let version = try readVarint()
+    guard version == UInt64(WorkspaceSnapshot.FormatVersion) else {
+      throw BlocklyError(.snapshotParsing, "Unsupported snapshot format version: \(version).")
+    }
+
+    // String table
+    let stringCount = try readCount()
+    _strings.reserveCapacity(stringCount)
+    for _ in 0 ..< stringCount {
+      let length = try readCount()
+      guard let string = String(bytes: _bytes[_offset ..< _offset + length], encoding: .utf8) else {
+        throw BlocklyError(.snapshotParsing, "The snapshot contains an invalid string.")
+      }
+      _strings.append(string)
+      _offset += length
+    }
+  }
+
+  mutating func readBlock(allBlocks: inout [Block]) throws -> Block {
+    let flags = WorkspaceSnapshot.BlockFlags(rawValue: try readVarint())
+    let type = try readString()
+    let uuid = try readString()
+    let shadow = flags.contains(.shadow)
+
+    guard let block = try? _factory.makeBlock(name: type, shadow: shadow, uuid: uuid) else {
+      throw BlocklyError(.snapshotParsing, "The block type \(type) does not exist.")
+    }
+    allBlocks.append(block)
+
+    if flags.contains(.hasPosition) {
+      let x = try readSignedVarint()
+      let y = try readSignedVarint()
+      block.position = WorkspacePoint(x: CGFloat(x), y: CGFloat(y))
+    }
+
+    block.disabled = flags.contains(.disabled)
+    block.deletable = flags.contains(.deletable)
+    block.movable = flags.contains(.movable)
+    block.editable = flags.contains(.editable)
+    block.inputsInline = flags.contains(.inputsInline)
+
+    if flags.contains(.hasMutation) {
+      let mutationXML = try readString()
+      if let mutator = block.mutator {
+        // Mutators read their state from the XML of the block, so wrap the mutation in a block
+        // element.
+        let blockXML = AEXMLElement(name: XMLConstants.TAG_BLOCK)
+        blockXML.addChild(try AEXMLDocument(xml: mutationXML).root)
+        mutator.update(fromXML: blockXML)
+        try mutator.mutateBlock()
+      }
+    }
+
+    if flags.contains(.hasComment) {
+      block.comment = try readString()
+    }
+
+    // Fields
+    let fieldCount = try readCount()
+    for _ in 0 ..< fieldCount {
+      let name = try readString()
+      let value = try readString()
+      try block.firstField(withName: name)?.setValueFromSerializedText(value)
+    }
+
+    // Connected inputs
+    let inputCount = try readCount()
+    for _ in 0 ..< inputCount {
+      let name = try readString()
+      let inputFlags = WorkspaceSnapshot.InputFlags(rawValue: try readVarint())
+
+      guard let connection = block.firstInput(withName: name)?.connection else {
+        throw BlocklyError(.snapshotParsing, "Could not find input on block: \(name)")
+      }
+      if inputFlags.contains(.hasBlock) {
+        let childBlock = try readBlock(allBlocks: &allBlocks)
+        try connection.connectTo(childBlock.inferiorConnection)
+      }
+      if inputFlags.contains(.hasShadowBlock) {
+        let childBlock = try readBlock(allBlocks: &allBlocks)
+        try connection.connectShadowTo(childBlock.inferiorConnection)
+      }
+    }
+
+    // Next statement
+    if flags.contains(.hasNextBlock) || flags.contains(.hasNextShadowBlock) {
+      guard let nextConnection = block.nextConnection else {
+        throw BlocklyError(.snapshotParsing, "Block has no next connection.")
+      }
+      if flags.contains(.hasNextBlock) {
+        let nextBlock = try readBlock(allBlocks: &allBlocks)
+        try nextConnection.connectTo(nextBlock.inferiorConnection)
+      }
+      if flags.contains(.hasNextShadowBlock) {
+        let nextBlock = try readBlock(allBlocks: &allBlocks)
+        try nextConnection.connectShadowTo(nextBlock.inferiorConnection)
+      }
+    }
+
+    return block
+  }
+
+  mutating func readString() throws -> String {
+    let index = try readVarint()
+    guard index < UInt64(_strings.count) else {
+      throw BlocklyError(.snapshotParsing, "The snapshot references an invalid string.")
+    }
+    return _strings[Int(index)]
+  }
+
+  /// Reads a varint that represents a count or a length. Since every counted item occupies at
+  /// least one byte, it can't exceed the number of remaining bytes.
+  mutating func readCount() throws -> Int {
+    let value = try readVarint()
+    guard value <= UInt64(_bytes.count - _offset) else {
+      throw BlocklyError(.snapshotParsing, "The snapshot is truncated or corrupt.")
+    }
+    return Int(value)
+  }
+
+  mutating func readVarint() throws -> UInt64 {
+    var value: UInt64 = 0
+    var shift: UInt64 = 0
+
+    while true {
+      guard _offset < _bytes.count, shift < 64 else {
+        throw BlocklyError(.snapshotParsing, "The snapshot is truncated or corrupt.")
+      }
+      let byte = _bytes[_offset]
+      _offset += 1
+      value |= UInt64(byte & 0x7F) << shift
+      if byte & 0x80 == 0 {
+        return value
+      }
+      shift += 7
+    }
+  }
+
+  mutating func readSignedVarint() throws -> Int64 {
+    let value = try readVarint()
+    return Int64(bitPattern: value >> 1) ^ -Int64(bitPattern: value & 1)
+  }
+}
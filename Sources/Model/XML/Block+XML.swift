@@ -30,12 +30,13 @@ extension Block {
    - throws:
    `BlocklyError`: Occurs if there is a problem parsing the xml (eg. insufficient data,
    malformed data, or contradictory data).
+   - note: Blocks are built while the XML is parsed, using a `BlockXMLStreamLoader`.
    */
   public class func blockTree(
     fromXMLString xmlString: String, factory: BlockFactory) throws -> BlockTree
   {
-    let xmlDoc = try AEXMLDocument(xml: xmlString)
-    return try blockTree(fromXML: xmlDoc.root, factory: factory)
+    let loader = BlockXMLStreamLoader(factory: factory)
+    return try loader.blockTree(fromBlockXMLData: Data(xmlString.utf8))
   }
 
   /**
@@ -259,13 +260,14 @@ extension Block {
   /**
    Returns an XML string representing the current state of this block and all of its descendants.
 
+   - note: The XML is written directly using a `BlockXMLWriter`.
    - returns: The XML string.
    - throws:
    `BlocklyError`: Thrown if there was an error serializing this block or any of its descendants.
    */
   @objc(toXMLWithError:)
   public func toXML() throws -> String {
-    return try toXMLElement().xml
+    return try BlockXMLWriter().xmlString(forBlock: self)
   }
 
   // MARK: - Internal
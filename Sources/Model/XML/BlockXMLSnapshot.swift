@@ -0,0 +1,173 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+import AEXML
+
+/**
+ An immutable capture of everything needed to serialize a block tree to XML, taken at a specific
+ point in time.
+
+ Capturing a snapshot only copies the values that end up in the XML (attributes, field values and
+ mutations), without doing any string formatting or escaping. The XML can then be rendered later
+ (eg. only when an event's XML is actually read), and still reflects the state of the block tree
+ at the time the snapshot was captured.
+ */
+internal final class BlockXMLSnapshot {
+  // MARK: - Structs
+
+  /// The state of a single input of a block.
+  struct InputState {
+    /// The XML element name for connected blocks, or `nil` for dummy inputs.
+    let elementName: String?
+    let name: String
+    let block: BlockXMLSnapshot?
+    let shadowBlock: BlockXMLSnapshot?
+    let fields: [(name: String, value: String)]
+  }
+
+  // MARK: - Properties
+
+  /// The tag name of the block (ie. "block" or "shadow").
+  let tagName: String
+  /// The attributes of the block element.
+  let attributes: [String: String]
+  /// The mutation of the block, if it has a mutator.
+  let mutation: AEXMLElement?
+  /// The state of each input of the block.
+  let inputs: [InputState]
+  /// The snapshot of the next block.
+  let nextBlock: BlockXMLSnapshot?
+  /// The snapshot of the next shadow block.
+  let nextShadowBlock: BlockXMLSnapshot?
+
+  /// The estimated number of bytes used by this snapshot (or by the XML rendered from it), for
+  /// this block and all of its descendants.
+  let estimatedByteCount: Int
+
+  /// The UUIDs of every block in this tree, in the same order as `Block.allBlocksForTree()`.
+  var allBlockUUIDs: [String] {
+    var uuids = [String]()
+    appendBlockUUIDs(to: &uuids)
+    return uuids
+  }
+
+  /// The UUID of the block.
+  private let uuid: String
+
+  // MARK: - Initializers
+
+  /**
+   Captures the current state of a block and all of its descendants.
+
+   - parameter block: The root block of the tree.
+   - throws:
+   `BlocklyError`: Thrown if the value of any field could not be serialized.
+   */
+  init(block: Block) throws {
+    uuid = block.uuid
+    tagName = block.shadow ? XMLConstants.TAG_SHADOW : XMLConstants.TAG_BLOCK
+    attributes = BlockXMLWriter.attributes(forBlock: block)
+    mutation = block.mutator?.toXMLElement()
+
+    var inputs = [InputState]()
+    inputs.reserveCapacity(block.inputs.count)
+    for input in block.inputs {
+      var fields = [(name: String, value: String)]()
+      for field in input.fields {
+        if let serializedText = try field.serializedText() {
+          fields.append((name: field.name, value: serializedText))
+        }
+      }
+      inputs.append(InputState(
+        elementName: BlockXMLWriter.elementName(forInput: input),
+        name: input.name,
+        block: try input.connectedBlock.map { try BlockXMLSnapshot(block: $0) },
+        shadowBlock: try input.connectedShadowBlock.map { try BlockXMLSnapshot(block: $0) },
+        fields: fields))
+    }
+    self.inputs = inputs
+
+    nextBlock = try block.nextBlock.map { try BlockXMLSnapshot(block: $0) }
+    nextShadowBlock = try block.nextShadowBlock.map { try BlockXMLSnapshot(block: $0) }
+
+    // Count the strings that end up in the XML, plus a rough overhead for each element
+    var byteCount = BlockXMLSnapshot.estimatedByteCount(
+      ofElementNamed: tagName, attributes: attributes, value: nil)
+    if let mutation = mutation {
+      byteCount += BlockXMLSnapshot.estimatedByteCount(of: mutation)
+    }
+    for input in inputs {
+      if let elementName = input.elementName {
+        byteCount += BlockXMLSnapshot.estimatedByteCount(
+          ofElementNamed: elementName, attributes: [XMLConstants.ATTRIBUTE_NAME: input.name],
+          value: nil)
+      }
+      for field in input.fields {
+        byteCount += BlockXMLSnapshot.estimatedByteCount(
+          ofElementNamed: XMLConstants.TAG_FIELD,
+          attributes: [XMLConstants.ATTRIBUTE_NAME: field.name], value: field.value)
+      }
+      byteCount += (input.block?.estimatedByteCount ?? 0) +
+        (input.shadowBlock?.estimatedByteCount ?? 0)
+    }
+    byteCount += (nextBlock?.estimatedByteCount ?? 0) + (nextShadowBlock?.estimatedByteCount ?? 0)
+    estimatedByteCount = byteCount
+  }
+
+  // MARK: - XML
+
+  /**
+   Renders the XML of the captured block tree. The output is identical to what `Block.toXML()`
+   returned at the time this snapshot was captured.
+
+   - returns: The XML string.
+   */
+  func xmlString() -> String {
+    return BlockXMLWriter().xmlString(forSnapshot: self)
+  }
+
+  // MARK: - Private
+
+  private static func estimatedByteCount(of element: AEXMLElement) -> Int {
+    var byteCount = estimatedByteCount(
+      ofElementNamed: element.name, attributes: element.attributes, value: element.value)
+    for child in element.children {
+      byteCount += estimatedByteCount(of: child)
+    }
+    return byteCount
+  }
+
+  private static func estimatedByteCount(
+    ofElementNamed name: String, attributes: [String: String], value: String?) -> Int
+  {
+    // Opening and closing tags, plus the quotes and separators of each attribute
+    var byteCount = 2 * name.utf8.count + 5 + (value?.utf8.count ?? 0)
+    for (key, attributeValue) in attributes {
+      byteCount += key.utf8.count + attributeValue.utf8.count + 4
+    }
+    return byteCount
+  }
+
+  private func appendBlockUUIDs(to uuids: inout [String]) {
+    uuids.append(uuid)
+    for input in inputs {
+      input.block?.appendBlockUUIDs(to: &uuids)
+      input.shadowBlock?.appendBlockUUIDs(to: &uuids)
+    }
+    nextBlock?.appendBlockUUIDs(to: &uuids)
+    nextShadowBlock?.appendBlockUUIDs(to: &uuids)
+  }
+}
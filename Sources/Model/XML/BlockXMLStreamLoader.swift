@@ -0,0 +1,655 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+import AEXML
+
+/**
+ Loads `Block` trees from XML, building blocks directly from `XMLParser` events instead of first
+ parsing the entire document into an `AEXMLDocument`.
+
+ Only the elements between the document root and the element currently being parsed are held in
+ memory, so peak memory (beyond the blocks that are created) is proportional to the nesting depth
+ of the XML, rather than its total size.
+
+ The XML format is the same one that is accepted by `Block.blockTree(fromXML:factory:)` and
+ `Workspace.loadBlocks(fromXML:factory:)`. Blockly serializes a block's `<mutation>` element (if it
+ has one) before its other child elements. Until a block with a mutator has been mutated, its
+ `<field>` and `<comment>` elements, and any `<value>` or `<statement>` elements for inputs that
+ don't exist yet, are held in memory. They are loaded once the mutation has been read, or once the
+ block's `<next>` element or the end of the block is reached.
+ */
+@objc(BKYBlockXMLStreamLoader)
+@objcMembers public final class BlockXMLStreamLoader: NSObject {
+  // MARK: - Structs
+
+  /**
+   Statistics describing a single load performed by a `BlockXMLStreamLoader`.
+   */
+  public struct Statistics {
+    /// The number of blocks that were created.
+    public let blockCount: Int
+    /// The number of elements that had to be held in memory until their block was mutated (see
+    /// `BlockXMLStreamLoader`).
+    public let bufferedElementCount: Int
+    /// The number of bytes that were parsed, or `nil` if the size of the input was not known
+    /// (eg. when loading from an `InputStream`).
+    public let byteCount: Int?
+    /// The amount of time the load took, in seconds.
+    public let duration: TimeInterval
+
+    /// The number of blocks that were created per second.
+    public var blocksPerSecond: Double {
+      return duration > 0 ? Double(blockCount) / duration : 0
+    }
+
+    /// The number of bytes that were parsed per second, or `nil` if `byteCount` is `nil`.
+    public var bytesPerSecond: Double? {
+      guard let byteCount = byteCount else {
+        return nil
+      }
+      return duration > 0 ? Double(byteCount) / duration : 0
+    }
+  }
+
+  // MARK: - Properties
+
+  /// The `BlockFactory` used to build blocks.
+  public let factory: BlockFactory
+
+  /// Statistics for the last successful load, or `nil` if nothing has been loaded yet.
+  public fileprivate(set) var lastLoadStatistics: Statistics?
+
+  // MARK: - Initializers
+
+  /**
+   Initializes the loader.
+
+   - parameter factory: The `BlockFactory` to use to build blocks.
+   */
+  public init(factory: BlockFactory) {
+    self.factory = factory
+    super.init()
+  }
+
+  // MARK: - Public
+
+  /**
+   Creates block trees from a workspace XML document (ie. a root element containing zero or more
+   `<block>` elements).
+
+   - parameter data: The XML data.
+   - returns: A list of all block trees that were created, in document order.
+   - throws:
+   `BlocklyError`: Occurs if there is a problem parsing the xml (eg. insufficient data,
+   malformed data, or contradictory data).
+   */
+  public func blockTrees(fromWorkspaceXMLData data: Data) throws -> [Block.BlockTree] {
+    return try load(parser: XMLParser(data: data), mode: .workspace, byteCount: data.count)
+  }
+
+  /**
+   Creates block trees from a workspace XML document (ie. a root element containing zero or more
+   `<block>` elements), reading it incrementally from a stream.
+
+   - parameter stream: The stream containing the XML data.
+   - returns: A list of all block trees that were created, in document order.
+   - throws:
+   `BlocklyError`: Occurs if there is a problem parsing the xml (eg. insufficient data,
+   malformed data, or contradictory data).
+   */
+  public func blockTrees(fromWorkspaceXMLStream stream: InputStream) throws -> [Block.BlockTree] {
+    return try load(parser: XMLParser(stream: stream), mode: .workspace, byteCount: nil)
+  }
+
+  /**
+   Creates a block tree from an XML document whose root element is a `<block>` or `<shadow>`.
+
+   - parameter data: The XML data.
+   - returns: The `BlockTree` that was created.
+   - throws:
+   `BlocklyError`: Occurs if there is a problem parsing the xml (eg. insufficient data,
+   malformed data, or contradictory data).
+   */
+  public func blockTree(fromBlockXMLData data: Data) throws -> Block.BlockTree {
+    let blockTrees =
+      try load(parser: XMLParser(data: data), mode: .blockTree, byteCount: data.count)
+
+    guard let blockTree = blockTrees.first else {
+      throw BlocklyError(.xmlParsing, "Could not find a block in the XML.")
+    }
+    return blockTree
+  }
+
+  // MARK: - Private
+
+  private func load(parser: XMLParser, mode: BlockXMLStreamParserDelegate.Mode, byteCount: Int?)
+    throws -> [Block.BlockTree]
+  {
+    let startTime = Date()
+    let delegate = BlockXMLStreamParserDelegate(factory: factory, mode: mode)
+    parser.delegate = delegate
+
+    let success = parser.parse()
+
+    if let error = delegate.error {
+      throw error
+    } else if !success {
+      let reason = parser.parserError?.localizedDescription ?? "Unknown error"
+      throw BlocklyError(.xmlParsing, "Could not parse XML: \(reason)")
+    }
+
+    lastLoadStatistics = Statistics(
+      blockCount: delegate.blockCount,
+      bufferedElementCount: delegate.bufferedElementCount,
+      byteCount: byteCount,
+      duration: Date().timeIntervalSince(startTime))
+
+    return delegate.blockTrees
+  }
+}
+
+// MARK: - BlockXMLStreamParserDelegate
+
+/**
+ `XMLParserDelegate` that builds block trees as elements are parsed, by maintaining a stack of the
+ elements that are currently open.
+ */
+fileprivate final class BlockXMLStreamParserDelegate: NSObject, XMLParserDelegate {
+  // MARK: - Enums
+
+  /// The type of document being parsed.
+  enum Mode {
+    /// A root element that contains zero or more `<block>` elements.
+    case workspace
+    /// A root element that is a `<block>` or `<shadow>`.
+    case blockTree
+  }
+
+  /// An element that is currently open.
+  enum Frame {
+    /// The root element of a workspace document.
+    case root
+    /// A `<block>` or `<shadow>` element.
+    case block(BlockFrame)
+    /// A `<value>`, `<statement>`, or `<next>` element.
+    case connection(ConnectionFrame)
+    /// A `<field>` or `<comment>` element.
+    case text(TextFrame)
+    /// A `<mutation>` element, or one of its descendants.
+    case mutation(TextFrame)
+    /// A child element of a block that can only be loaded once the block has been mutated, or one
+    /// of its descendants.
+    case buffered(TextFrame)
+    /// An element whose contents are ignored.
+    case ignored
+  }
+
+  // MARK: - Classes
+
+  /// The blocks created for a single block tree.
+  final class TreeBuilder {
+    var allBlocks = [Block]()
+  }
+
+  final class BlockFrame {
+    let block: Block
+    /// Contains the attributes and `<mutation>` children of the block element. This is the element
+    /// that is passed to `Mutator.update(fromXML:)`.
+    let element: AEXMLElement
+    let tree: TreeBuilder
+    let parent: ConnectionFrame?
+    var mutatorApplied = false
+    var mutationFound = false
+    /// Child elements that can only be loaded once the block has been mutated.
+    var bufferedChildren = [AEXMLElement]()
+
+    init(block: Block, element: AEXMLElement, tree: TreeBuilder, parent: ConnectionFrame?) {
+      self.block = block
+      self.element = element
+      self.tree = tree
+      self.parent = parent
+    }
+  }
+
+  final class ConnectionFrame {
+    let connection: Connection
+    let element: AEXMLElement
+    let tree: TreeBuilder
+    var blockCount = 0
+
+    init(connection: Connection, element: AEXMLElement, tree: TreeBuilder) {
+      self.connection = connection
+      self.element = element
+      self.tree = tree
+    }
+  }
+
+  final class TextFrame {
+    let element: AEXMLElement
+    let block: Block?
+    var text = ""
+    /// Matches `AEXMLDocument`, which ignores text that appears after an element's first child.
+    var acceptsText = true
+
+    init(element: AEXMLElement, block: Block?) {
+      self.element = element
+      self.block = block
+    }
+
+    var trimmedText: String? {
+      let trimmed = text.trimmingCharacters(in: .whitespacesAndNewlines)
+      return trimmed.isEmpty ? nil : trimmed
+    }
+  }
+
+  // MARK: - Properties
+
+  let factory: BlockFactory
+  let mode: Mode
+  fileprivate(set) var blockTrees = [Block.BlockTree]()
+  fileprivate(set) var blockCount = 0
+  fileprivate(set) var bufferedElementCount = 0
+  fileprivate(set) var error: Error?
+
+  fileprivate var _stack = [Frame]()
+  /// Formatter used to parse block positions. It is shared since creating one is expensive.
+  fileprivate let _numberFormatter = NumberFormatter()
+
+  // MARK: - Initializers
+
+  init(factory: BlockFactory, mode: Mode) {
+    self.factory = factory
+    self.mode = mode
+    super.init()
+  }
+
+  // MARK: - XMLParserDelegate
+
+  func parser(
+    _ parser: XMLParser, didStartElement elementName: String, namespaceURI: String?,
+    qualifiedName qName: String?, attributes attributeDict: [String : String])
+  {
+    guard error == nil else { return }
+
+    do {
+      try startElement(elementName, attributes: attributeDict)
+    } catch let error {
+      fail(parser, error)
+    }
+  }
+
+  func parser(
+    _ parser: XMLParser, didEndElement elementName: String, namespaceURI: String?,
+    qualifiedName qName: String?)
+  {
+    guard error == nil else { return }
+
+    do {
+      try endTopElement()
+    } catch let error {
+      fail(parser, error)
+    }
+  }
+
+  func parser(_ parser: XMLParser, foundCharacters string: String) {
+    appendText(string)
+  }
+
+  func parser(_ parser: XMLParser, foundCDATA CDATABlock: Data) {
+    if let string = String(data: CDATABlock, encoding: .utf8) {
+      appendText(string)
+    }
+  }
+
+  // MARK: - Start Element
+
+  private func startElement(_ name: String, attributes: [String: String]) throws {
+    guard let top = _stack.last else {
+      // This is the root element of the document
+      switch mode {
+      case .workspace:
+        _stack.append(.root)
+      case .blockTree:
+        try startBlock(name, attributes: attributes, parent: nil)
+      }
+      return
+    }
+
+    switch top {
+    case .root:
+      if name == XMLConstants.TAG_BLOCK {
+        try startBlock(name, attributes: attributes, parent: nil)
+      } else {
+        _stack.append(.ignored)
+      }
+    case .block(let blockFrame):
+      try startChild(name, attributes: attributes, ofBlock: blockFrame)
+    case .connection(let connectionFrame):
+      switch name.lowercased() {
+      case XMLConstants.TAG_BLOCK, XMLConstants.TAG_SHADOW:
+        try startBlock(name, attributes: attributes, parent: connectionFrame)
+      default:
+        bky_print("Unknown element: \(name)")
+        _stack.append(.ignored)
+      }
+    case .mutation(let mutationFrame):
+      mutationFrame.acceptsText = false
+      let child = mutationFrame.element.addChild(name: name, attributes: attributes)
+      _stack.append(.mutation(TextFrame(element: child, block: nil)))
+    case .buffered(let bufferedFrame):
+      bufferedFrame.acceptsText = false
+      let child = bufferedFrame.element.addChild(name: name, attributes: attributes)
+      bufferedElementCount += 1
+      _stack.append(.buffered(TextFrame(element: child, block: nil)))
+    case .text(let textFrame):
+      textFrame.acceptsText = false
+      _stack.append(.ignored)
+    case .ignored:
+      _stack.append(.ignored)
+    }
+  }
+
+  private func startBlock(_ name: String, attributes: [String: String], parent: ConnectionFrame?)
+    throws
+  {
+    let element = AEXMLElement(name: name, attributes: attributes)
+    let lowercaseTag = name.lowercased()
+    guard lowercaseTag == XMLConstants.TAG_BLOCK || lowercaseTag == XMLConstants.TAG_SHADOW else {
+      let errorMessage = "The block tag (\"\(name)\") must be either " +
+        "'\(XMLConstants.TAG_BLOCK)' or '\(XMLConstants.TAG_SHADOW)'"
+      throw BlocklyError(.xmlUnknownBlock, errorMessage, element)
+    }
+    guard let type = attributes[XMLConstants.ATTRIBUTE_TYPE] else {
+      throw BlocklyError(.xmlUnknownBlock, "The block type may not be nil.", element)
+    }
+    if type == "" {
+      throw BlocklyError(.xmlUnknownBlock, "The block type may not be empty.", element)
+    }
+
+    let uuid = attributes[XMLConstants.ATTRIBUTE_ID]
+    let shadow = (lowercaseTag == XMLConstants.TAG_SHADOW)
+
+    guard let block = try? factory.makeBlock(name: type, shadow: shadow, uuid: uuid) else {
+      throw BlocklyError(.xmlUnknownBlock, "The block type \(type) does not exist.", element)
+    }
+
+    if let xString = attributes[XMLConstants.ATTRIBUTE_POSITION_X],
+      let yString = attributes[XMLConstants.ATTRIBUTE_POSITION_Y],
+      let x = _numberFormatter.number(from: xString),
+      let y = _numberFormatter.number(from: yString)
+    {
+      block.position = WorkspacePoint(x: CGFloat(truncating: x), y: CGFloat(truncating: y))
+    }
+
+    if let disabled = attributes[XMLConstants.TAG_DISABLED] {
+      block.disabled = disabled.caseInsensitiveCompare("true") == .orderedSame
+    }
+    if let deletable = attributes[XMLConstants.TAG_DELETABLE] {
+      block.deletable = deletable.caseInsensitiveCompare("true") == .orderedSame
+    }
+    if let movable = attributes[XMLConstants.TAG_MOVABLE] {
+      block.movable = movable.caseInsensitiveCompare("true") == .orderedSame
+    }
+    if let editable = attributes[XMLConstants.TAG_EDITABLE] {
+      block.editable = editable.caseInsensitiveCompare("true") == .orderedSame
+    }
+    if let inputsInline = attributes[XMLConstants.TAG_INPUTS_INLINE] {
+      block.inputsInline = inputsInline.caseInsensitiveCompare("true") == .orderedSame
+    }
+
+    let tree = parent?.tree ?? TreeBuilder()
+    tree.allBlocks.append(block)
+    blockCount += 1
+
+    _stack.append(.block(BlockFrame(block: block, element: element, tree: tree, parent: parent)))
+  }
+
+  private func startChild(_ name: String, attributes: [String: String], ofBlock frame: BlockFrame)
+    throws
+  {
+    let block = frame.block
+
+    if name == XMLConstants.TAG_MUTATION && block.mutator != nil {
+      guard !frame.mutatorApplied else {
+        let errorMessage = frame.mutationFound ?
+          "A block must not contain more than one \"\(XMLConstants.TAG_MUTATION)\" element." :
+          "The \"\(XMLConstants.TAG_MUTATION)\" element must appear before the " +
+            "\"\(XMLConstants.TAG_NEXT_STATEMENT)\" element of its block."
+        throw BlocklyError(.xmlParsing, errorMessage, frame.element)
+      }
+
+      frame.mutationFound = true
+      let mutationXML = frame.element.addChild(name: name, attributes: attributes)
+      _stack.append(.mutation(TextFrame(element: mutationXML, block: nil)))
+      return
+    }
+
+    if block.mutator != nil && !frame.mutatorApplied {
+      if requiresMutation(name, attributes: attributes, ofBlock: block) {
+        // The mutation may still follow, so hold onto this element until the block is mutated.
+        let bufferedXML = AEXMLElement(name: name, attributes: attributes)
+        frame.bufferedChildren.append(bufferedXML)
+        bufferedElementCount += 1
+        _stack.append(.buffered(TextFrame(element: bufferedXML, block: nil)))
+        return
+      } else if name.lowercased() == XMLConstants.TAG_NEXT_STATEMENT {
+        // The next block never depends on the mutation, so stop waiting for one.
+        try mutateBlock(frame)
+      }
+    }
+
+    let element = AEXMLElement(name: name, attributes: attributes)
+
+    switch name.lowercased() {
+    case XMLConstants.TAG_INPUT_VALUE, XMLConstants.TAG_INPUT_STATEMENT:
+      // Figure out which connection we're connecting to
+      guard let inputName = attributes[XMLConstants.ATTRIBUTE_NAME] else {
+        let errorMessage = "Missing \"\(XMLConstants.ATTRIBUTE_NAME)\" attribute for input."
+        throw BlocklyError(.xmlParsing, errorMessage, element)
+      }
+      guard let input = block.firstInput(withName: inputName) else {
+        throw BlocklyError(.xmlParsing, "Could not find input on block: \(inputName)", element)
+      }
+      guard let inputConnection = input.connection else {
+        throw BlocklyError(.xmlParsing, "Input has no connection.")
+      }
+      _stack.append(.connection(
+        ConnectionFrame(connection: inputConnection, element: element, tree: frame.tree)))
+    case XMLConstants.TAG_NEXT_STATEMENT:
+      guard let nextConnection = block.nextConnection else {
+        throw BlocklyError(.xmlParsing, "Block has no next connection.")
+      }
+      _stack.append(.connection(
+        ConnectionFrame(connection: nextConnection, element: element, tree: frame.tree)))
+    case XMLConstants.TAG_FIELD, XMLConstants.TAG_COMMENT:
+      _stack.append(.text(TextFrame(element: element, block: block)))
+    default:
+      if block.mutator == nil {
+        // Log unknown nodes (if there's a mutator, those unknown nodes may have been handled
+        // already so we will not log them).
+        bky_print("Unknown node name: \(name)")
+      }
+      _stack.append(.ignored)
+    }
+  }
+
+  // MARK: - End Element
+
+  private func endTopElement() throws {
+    guard let frame = _stack.last else { return }
+
+    if case .block(let blockFrame) = frame {
+      // Mutate the block (if it hasn't been yet), before it is connected to its parent
+      try mutateBlock(blockFrame)
+    }
+
+    _stack.removeLast()
+    try endElement(frame)
+  }
+
+  private func endElement(_ frame: Frame) throws {
+    switch frame {
+    case .block(let blockFrame):
+      if let parent = blockFrame.parent {
+        // Connect this block tree to its parent
+        let block = blockFrame.block
+        if block.shadow {
+          try parent.connection.connectShadowTo(block.inferiorConnection)
+        } else {
+          try parent.connection.connectTo(block.inferiorConnection)
+        }
+        parent.blockCount += 1
+      } else {
+        blockTrees.append(
+          Block.BlockTree(rootBlock: blockFrame.block, allBlocks: blockFrame.tree.allBlocks))
+      }
+    case .connection(let connectionFrame):
+      if connectionFrame.blockCount == 0 {
+        let isNext = connectionFrame.element.name.lowercased() == XMLConstants.TAG_NEXT_STATEMENT
+        let errorMessage = isNext ? "Missing next block." : "Missing block for input."
+        throw BlocklyError(.xmlParsing, errorMessage, connectionFrame.element)
+      }
+    case .text(let textFrame):
+      guard let block = textFrame.block else { break }
+
+      if textFrame.element.name.lowercased() == XMLConstants.TAG_COMMENT {
+        if let commentText = textFrame.trimmedText {
+          block.comment = commentText
+        }
+      } else {
+        try setField(onBlock: block, fromTextFrame: textFrame)
+      }
+    case .mutation(let mutationFrame):
+      mutationFrame.element.value = mutationFrame.trimmedText
+
+      if let top = _stack.last, case .block(let blockFrame) = top {
+        // All mutation data has been read, so the block can now be mutated.
+        try mutateBlock(blockFrame)
+      }
+    case .buffered(let bufferedFrame):
+      bufferedFrame.element.value = bufferedFrame.trimmedText
+    case .root, .ignored:
+      break
+    }
+  }
+
+  private func setField(onBlock block: Block, fromTextFrame frame: TextFrame) throws {
+    guard let fieldName = frame.element.attributes[XMLConstants.ATTRIBUTE_NAME] else {
+      bky_print("Skipping setting field for block type '\(block.name)'. " +
+        "Missing required field attribute '\(XMLConstants.ATTRIBUTE_NAME)'")
+      return
+    }
+
+    guard let field = block.firstField(withName: fieldName) else {
+      bky_print("Skipping setting field for block type '\(block.name)'. " +
+        "Could not find field name '\(fieldName)'")
+      return
+    }
+
+    try field.setValueFromSerializedText(frame.trimmedText ?? "")
+  }
+
+  // MARK: - Helpers
+
+  /**
+   Returns whether a child element of a block can only be loaded once the block has been mutated.
+   Fields and comments are always loaded after the mutation, as they are when loading from an
+   `AEXMLElement`. Values and statements only need to wait if their input doesn't exist yet.
+   */
+  private func requiresMutation(
+    _ name: String, attributes: [String: String], ofBlock block: Block) -> Bool
+  {
+    switch name.lowercased() {
+    case XMLConstants.TAG_FIELD, XMLConstants.TAG_COMMENT:
+      return true
+    case XMLConstants.TAG_INPUT_VALUE, XMLConstants.TAG_INPUT_STATEMENT:
+      if let inputName = attributes[XMLConstants.ATTRIBUTE_NAME] {
+        return block.firstInput(withName: inputName) == nil
+      }
+      return false
+    default:
+      return false
+    }
+  }
+
+  /**
+   Applies the mutator of a block (if it hasn't been applied yet), and then loads the child elements
+   that were waiting for it, as if they were being parsed for the first time.
+   */
+  private func mutateBlock(_ frame: BlockFrame) throws {
+    guard !frame.mutatorApplied else { return }
+    frame.mutatorApplied = true
+
+    if let mutator = frame.block.mutator {
+      // Update the mutator and immediately apply it
+      mutator.update(fromXML: frame.element)
+      try mutator.mutateBlock()
+    }
+
+    let children = frame.bufferedChildren
+    frame.bufferedChildren.removeAll()
+
+    for child in children {
+      try loadBufferedElement(child)
+    }
+  }
+
+  private func loadBufferedElement(_ element: AEXMLElement) throws {
+    // Walk the element iteratively, so deeply nested elements don't exhaust the call stack
+    var openElements = [(element: AEXMLElement, nextChildIndex: Int)]()
+
+    try startBufferedElement(element)
+    openElements.append((element: element, nextChildIndex: 0))
+
+    while let top = openElements.last {
+      if top.nextChildIndex < top.element.children.count {
+        openElements[openElements.count - 1].nextChildIndex += 1
+
+        let child = top.element.children[top.nextChildIndex]
+        try startBufferedElement(child)
+        openElements.append((element: child, nextChildIndex: 0))
+      } else {
+        openElements.removeLast()
+        try endTopElement()
+      }
+    }
+  }
+
+  private func startBufferedElement(_ element: AEXMLElement) throws {
+    try startElement(element.name, attributes: element.attributes)
+    if let value = element.value {
+      appendText(value)
+    }
+  }
+
+  private func appendText(_ string: String) {
+    guard error == nil, let top = _stack.last else { return }
+
+    switch top {
+    case .text(let textFrame), .mutation(let textFrame), .buffered(let textFrame):
+      if textFrame.acceptsText {
+        textFrame.text += string
+      }
+    default:
+      break
+    }
+  }
+
+  private func fail(_ parser: XMLParser, _ error: Error) {
+    self.error = error
+    parser.abortParsing()
+  }
+}
@@ -0,0 +1,475 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+import AEXML
+
+/**
+ Serializes blocks and workspaces to XML by writing directly into a reusable byte buffer, instead
+ of first building an `AEXMLDocument` and then rendering it.
+
+ The output uses the same formatting as `AEXMLElement.xml` (tab indentation, self-closing empty
+ elements, and the same escaping), and attributes are emitted from dictionaries built in the same
+ order as `Block.toXMLElement()`, so the result matches the output of the DOM-based serializer.
+
+ The byte buffer is kept between calls, so re-using a writer (eg. for periodic autosaves) avoids
+ re-growing it each time.
+
+ - note: This class is not thread-safe.
+ */
+@objc(BKYBlockXMLWriter)
+@objcMembers public final class BlockXMLWriter: NSObject {
+  // MARK: - Structs
+
+  /**
+   Statistics describing a single serialization performed by a `BlockXMLWriter`.
+   */
+  public struct Statistics {
+    /// The number of XML elements that were written.
+    public let elementCount: Int
+    /// The number of bytes that were written.
+    public let byteCount: Int
+    /// The number of times the writer's buffer had to grow during serialization.
+    public let bufferGrowthCount: Int
+    /// The amount of time the serialization took, in seconds.
+    public let duration: TimeInterval
+  }
+
+  // MARK: - Constants
+
+  /// When writing to an `OutputStream`, the buffer is flushed once it reaches this size (in bytes).
+  public static let StreamFlushThreshold = 64 * 1024
+
+  // MARK: - Properties
+
+  /// Statistics for the last successful serialization, or `nil` if nothing has been written yet.
+  public fileprivate(set) var lastWriteStatistics: Statistics?
+
+  /// The buffer that XML is written into.
+  fileprivate var _buffer = [UInt8]()
+  /// For each open element, whether any children have been written into it yet.
+  fileprivate var _openElements = [Bool]()
+  /// The depth of the first element that is written (matching `AEXMLElement`, where an element
+  /// without a parent has a depth of -1 and the root of a document has a depth of 0).
+  fileprivate var _baseDepth = 0
+  /// The stream that the buffer is flushed to, if one has been specified.
+  fileprivate var _outputStream: OutputStream?
+  fileprivate var _elementCount = 0
+  fileprivate var _bufferGrowthCount = 0
+  fileprivate var _flushedByteCount = 0
+
+  // MARK: - Public
+
+  /**
+   Returns an XML string representing the current state of a workspace. The output is identical
+   to `Workspace.toXMLDocument().xml`.
+
+   - parameter workspace: The workspace to serialize.
+   - returns: The XML string.
+   - throws:
+   `BlocklyError`: Thrown if there was an error serializing any of the blocks in the workspace.
+   */
+  public func xmlString(forWorkspace workspace: Workspace) throws -> String {
+    try write {
+      try writeWorkspace(workspace)
+    }
+    return String(decoding: _buffer, as: UTF8.self)
+  }
+
+  /**
+   Returns an XML string representing the current state of a block and all of its descendants. The
+   output is identical to `Block.toXMLElement().xml`.
+
+   - parameter block: The block to serialize.
+   - returns: The XML string.
+   - throws:
+   `BlocklyError`: Thrown if there was an error serializing the block or any of its descendants.
+   */
+  public func xmlString(forBlock block: Block) throws -> String {
+    try write {
+      _baseDepth = -1
+      try writeBlock(block)
+    }
+    return String(decoding: _buffer, as: UTF8.self)
+  }
+
+  /**
+   Returns an XML string representing a block tree, as it was when a snapshot was captured. The
+   output is identical to what `Block.toXML()` returned at that time.
+
+   - parameter snapshot: The snapshot of the block tree.
+   - returns: The XML string.
+   */
+  internal func xmlString(forSnapshot snapshot: BlockXMLSnapshot) -> String {
+    write {
+      _baseDepth = -1
+      writeSnapshot(snapshot)
+    }
+    return String(decoding: _buffer, as: UTF8.self)
+  }
+
+  /**
+   Writes XML representing the current state of a workspace to an output stream. The stream must
+   already be open.
+
+   - parameter workspace: The workspace to serialize.
+   - parameter stream: The stream to write to. XML is written in chunks of up to
+   `StreamFlushThreshold` bytes, so the entire document is never held in memory.
+   - throws:
+   `BlocklyError`: Thrown if there was an error serializing any of the blocks in the workspace, or
+   if the stream could not be written to.
+   */
+  public func write(workspace: Workspace, to stream: OutputStream) throws {
+    _outputStream = stream
+    defer { _outputStream = nil }
+
+    try write {
+      try writeWorkspace(workspace)
+      try flush()
+    }
+  }
+
+  // MARK: - Private
+
+  private func write(_ closure: () throws -> Void) rethrows {
+    let startTime = Date()
+
+    _buffer.removeAll(keepingCapacity: true)
+    _openElements.removeAll(keepingCapacity: true)
+    _baseDepth = 0
+    _elementCount = 0
+    _bufferGrowthCount = 0
+    _flushedByteCount = 0
+
+    try closure()
+
+    lastWriteStatistics = Statistics(
+      elementCount: _elementCount,
+      byteCount: _flushedByteCount + _buffer.count,
+      bufferGrowthCount: _bufferGrowthCount,
+      duration: Date().timeIntervalSince(startTime))
+  }
+
+  private func writeWorkspace(_ workspace: Workspace) throws {
+    append(AEXMLOptions.DocumentHeader().xmlString)
+    append("\n")
+
+    beginElement("xml", attributes: ["xmlns": "http://www.w3.org/1999/xhtml"])
+    for block in workspace.topLevelBlocks() {
+      try writeChild { try writeBlock(block) }
+    }
+    endElement("xml")
+  }
+
+  private func writeBlock(_ block: Block) throws {
+    let tagName = block.shadow ? XMLConstants.TAG_SHADOW : XMLConstants.TAG_BLOCK
+    beginElement(tagName, attributes: BlockXMLWriter.attributes(forBlock: block))
+
+    if let mutator = block.mutator {
+      let mutatorXML = mutator.toXMLElement()
+      writeChild { writeElement(mutatorXML) }
+    }
+
+    for input in block.inputs {
+      try writeInput(input)
+    }
+
+    if block.nextBlock != nil || block.nextShadowBlock != nil {
+      try writeChild {
+        beginElement(XMLConstants.TAG_NEXT_STATEMENT, attributes: [:])
+        if let nextBlock = block.nextBlock {
+          try writeChild { try writeBlock(nextBlock) }
+        }
+        if let nextShadowBlock = block.nextShadowBlock {
+          try writeChild { try writeBlock(nextShadowBlock) }
+        }
+        endElement(XMLConstants.TAG_NEXT_STATEMENT)
+      }
+    }
+
+    endElement(tagName)
+  }
+
+  private func writeInput(_ input: Input) throws {
+    if let elementName = BlockXMLWriter.elementName(forInput: input),
+      input.connectedBlock != nil || input.connectedShadowBlock != nil
+    {
+      try writeChild {
+        beginElement(elementName, attributes: [XMLConstants.ATTRIBUTE_NAME: input.name])
+        if let connectedBlock = input.connectedBlock {
+          try writeChild { try writeBlock(connectedBlock) }
+        }
+        if let connectedShadowBlock = input.connectedShadowBlock {
+          try writeChild { try writeBlock(connectedShadowBlock) }
+        }
+        endElement(elementName)
+      }
+    }
+
+    for field in input.fields {
+      if let serializedText = try field.serializedText() {
+        writeChild {
+          writeValueElement(XMLConstants.TAG_FIELD,
+            attributes: [XMLConstants.ATTRIBUTE_NAME: field.name], value: serializedText)
+        }
+      }
+    }
+  }
+
+  private func writeSnapshot(_ snapshot: BlockXMLSnapshot) {
+    beginElement(snapshot.tagName, attributes: snapshot.attributes)
+
+    if let mutation = snapshot.mutation {
+      writeChild { writeElement(mutation) }
+    }
+
+    for input in snapshot.inputs {
+      if let elementName = input.elementName, input.block != nil || input.shadowBlock != nil {
+        writeChild {
+          beginElement(elementName, attributes: [XMLConstants.ATTRIBUTE_NAME: input.name])
+          if let block = input.block {
+            writeChild { writeSnapshot(block) }
+          }
+          if let shadowBlock = input.shadowBlock {
+            writeChild { writeSnapshot(shadowBlock) }
+          }
+          endElement(elementName)
+        }
+      }
+
+      for field in input.fields {
+        writeChild {
+          writeValueElement(XMLConstants.TAG_FIELD,
+            attributes: [XMLConstants.ATTRIBUTE_NAME: field.name], value: field.value)
+        }
+      }
+    }
+
+    if snapshot.nextBlock != nil || snapshot.nextShadowBlock != nil {
+      writeChild {
+        beginElement(XMLConstants.TAG_NEXT_STATEMENT, attributes: [:])
+        if let nextBlock = snapshot.nextBlock {
+          writeChild { writeSnapshot(nextBlock) }
+        }
+        if let nextShadowBlock = snapshot.nextShadowBlock {
+          writeChild { writeSnapshot(nextShadowBlock) }
+        }
+        endElement(XMLConstants.TAG_NEXT_STATEMENT)
+      }
+    }
+
+    endElement(snapshot.tagName)
+  }
+
+  /**
+   Writes an arbitrary `AEXMLElement` (eg. the XML for a mutator), formatted the same way as
+   `AEXMLElement.xml`.
+   */
+  private func writeElement(_ element: AEXMLElement) {
+    if element.children.isEmpty, let value = element.value {
+      writeValueElement(element.name, attributes: element.attributes, value: value)
+      return
+    }
+
+    beginElement(element.name, attributes: element.attributes)
+    for child in element.children {
+      writeChild { writeElement(child) }
+    }
+    endElement(element.name)
+  }
+
+  // MARK: - Block Attributes
+
+  /**
+   Returns the attributes of the XML element for a block. The dictionary is built in the same
+   order as `Block.toXMLElement()`, so attributes are written in the same order.
+
+   - parameter block: The block.
+   - returns: The attributes of the block's element.
+   */
+  internal static func attributes(forBlock block: Block) -> [String: String] {
+    var attributes: [String: String] = [:]
+    attributes[XMLConstants.ATTRIBUTE_TYPE] = block.name // `name` represents the block type
+    attributes[XMLConstants.ATTRIBUTE_ID] = block.uuid
+
+    if block.topLevel {
+      attributes[XMLConstants.ATTRIBUTE_POSITION_X] = String(Int(floor(block.position.x)))
+      attributes[XMLConstants.ATTRIBUTE_POSITION_Y] = String(Int(floor(block.position.y)))
+    }
+    if block.initialInputsInlineValue != block.inputsInline {
+      attributes[XMLConstants.TAG_INPUTS_INLINE] = String(block.inputsInline)
+    }
+    if block.disabled {
+      attributes[XMLConstants.TAG_DISABLED] = "true"
+    }
+    if !block.deletable && !block.shadow {
+      attributes[XMLConstants.TAG_DELETABLE] = "false"
+    }
+    if !block.movable && !block.shadow {
+      attributes[XMLConstants.TAG_MOVABLE] = "false"
+    }
+    if !block.editable {
+      attributes[XMLConstants.TAG_EDITABLE] = "false"
+    }
+
+    return attributes
+  }
+
+  /**
+   Returns the name of the XML element that wraps the blocks connected to an input.
+
+   - parameter input: The input.
+   - returns: The element name, or `nil` if the input can't have blocks connected to it.
+   */
+  internal static func elementName(forInput input: Input) -> String? {
+    switch input.type {
+    case .dummy:
+      return nil
+    case .value:
+      return XMLConstants.TAG_INPUT_VALUE
+    case .statement:
+      return XMLConstants.TAG_INPUT_STATEMENT
+    }
+  }
+
+  // MARK: - Element Writing
+
+  private func beginElement(_ name: String, attributes: [String: String]) {
+    _elementCount += 1
+    appendIndent()
+    append("<")
+    append(name)
+    appendAttributes(attributes)
+    _openElements.append(false)
+  }
+
+  private func endElement(_ name: String) {
+    let hasChildren = _openElements.popLast() ?? false
+
+    if hasChildren {
+      appendIndent()
+      append("</")
+      append(name)
+      append(">")
+    } else {
+      append(" />")
+    }
+  }
+
+  private func writeValueElement(_ name: String, attributes: [String: String], value: String) {
+    _elementCount += 1
+    appendIndent()
+    append("<")
+    append(name)
+    appendAttributes(attributes)
+    append(">")
+    appendEscaped(value)
+    append("</")
+    append(name)
+    append(">")
+  }
+
+  /**
+   Writes a child element of the currently open element, using `closure`. This finishes the
+   parent's start tag if this is its first child, and writes the newline that follows each child.
+   */
+  private func writeChild(_ closure: () throws -> Void) rethrows {
+    if let hasChildren = _openElements.last, !hasChildren {
+      _openElements[_openElements.count - 1] = true
+      append(">\n")
+    }
+
+    try closure()
+    append("\n")
+
+    if _outputStream != nil && _buffer.count >= BlockXMLWriter.StreamFlushThreshold {
+      // A failed flush leaves the buffer intact, so any error is reported by the final flush.
+      try? flush()
+    }
+  }
+
+  // MARK: - Buffer
+
+  private func append(_ string: String) {
+    let previousCapacity = _buffer.capacity
+    _buffer.append(contentsOf: string.utf8)
+    if _buffer.capacity != previousCapacity {
+      _bufferGrowthCount += 1
+    }
+  }
+
+  private func appendIndent() {
+    // The current depth is the depth of the element that is about to be written
+    let depth = _baseDepth + _openElements.count
+    if depth > 0 {
+      let previousCapacity = _buffer.capacity
+      _buffer.append(contentsOf: repeatElement(UInt8(ascii: "\t"), count: depth))
+      if _buffer.capacity != previousCapacity {
+        _bufferGrowthCount += 1
+      }
+    }
+  }
+
+  private func appendAttributes(_ attributes: [String: String]) {
+    for (key, value) in attributes {
+      append(" ")
+      append(key)
+      append("=\"")
+      appendEscaped(value)
+      append("\"")
+    }
+  }
+
+  /// Appends a string with XML special characters escaped, matching `String.xmlEscaped`.
+  private func appendEscaped(_ string: String) {
+    let previousCapacity = _buffer.capacity
+
+    for byte in string.utf8 {
+      switch byte {
+      case UInt8(ascii: "&"): _buffer.append(contentsOf: "&amp;".utf8)
+      case UInt8(ascii: "<"): _buffer.append(contentsOf: "&lt;".utf8)
+      case UInt8(ascii: ">"): _buffer.append(contentsOf: "&gt;".utf8)
+      case UInt8(ascii: "'"): _buffer.append(contentsOf: "&apos;".utf8)
+      case UInt8(ascii: "\""): _buffer.append(contentsOf: "&quot;".utf8)
+      default: _buffer.append(byte)
+      }
+    }
+
+    if _buffer.capacity != previousCapacity {
+      _bufferGrowthCount += 1
+    }
+  }
+
+  private func flush() throws {
+    guard let stream = _outputStream, !_buffer.isEmpty else {
+      return
+    }
+
+    var offset = 0
+    try _buffer.withUnsafeBufferPointer { pointer in
+      while offset < pointer.count {
+        let written = stream.write(pointer.baseAddress! + offset, maxLength: pointer.count - offset)
+        if written <= 0 {
+          let reason = stream.streamError?.localizedDescription ?? "Unknown error"
+          throw BlocklyError(.xmlSerialization, "Could not write XML to stream: \(reason)")
+        }
+        offset += written
+      }
+    }
+
+    _flushedByteCount += _buffer.count
+    _buffer.removeAll(keepingCapacity: true)
+  }
+}
@@ -29,10 +29,42 @@ extension Workspace {
    - throws:
      `BlocklyError`: Occurs if there is a problem parsing the xml (eg. insufficient data,
      malformed data, or contradictory data).
+   - note: Blocks are built while the XML is parsed, using a `BlockXMLStreamLoader`.
   */
   public func loadBlocks(fromXMLString xmlString: String, factory: BlockFactory) throws {
-    let xmlDoc = try AEXMLDocument(xml: xmlString)
-    try loadBlocks(fromXML: xmlDoc.root, factory: factory)
+    try loadBlocks(fromXMLData: Data(xmlString.utf8), factory: factory)
+  }
+
+  /**
+   Loads blocks from XML data into the workspace.
+
+   - parameter xmlData: The data that contains all the block data.
+   - parameter factory: The `BlockFactory` to use to build blocks.
+   - throws:
+     `BlocklyError`: Occurs if there is a problem parsing the xml (eg. insufficient data,
+     malformed data, or contradictory data).
+   - note: Blocks are built while the XML is parsed, using a `BlockXMLStreamLoader`.
+   */
+  public func loadBlocks(fromXMLData xmlData: Data, factory: BlockFactory) throws {
+    let loader = BlockXMLStreamLoader(factory: factory)
+    let blockTrees = try loader.blockTrees(fromWorkspaceXMLData: xmlData)
+    try addBlockTrees(blockTrees.map({ $0.rootBlock }))
+  }
+
+  /**
+   Loads blocks from an XML stream into the workspace. The stream is read incrementally, so the
+   entire document never needs to be held in memory.
+
+   - parameter xmlStream: The stream that contains all the block data.
+   - parameter factory: The `BlockFactory` to use to build blocks.
+   - throws:
+     `BlocklyError`: Occurs if there is a problem parsing the xml (eg. insufficient data,
+     malformed data, or contradictory data).
+   */
+  public func loadBlocks(fromXMLStream xmlStream: InputStream, factory: BlockFactory) throws {
+    let loader = BlockXMLStreamLoader(factory: factory)
+    let blockTrees = try loader.blockTrees(fromWorkspaceXMLStream: xmlStream)
+    try addBlockTrees(blockTrees.map({ $0.rootBlock }))
   }
 
   /**
@@ -66,13 +98,15 @@ extension Workspace {
   /**
    Returns an XML string representing the current state of this workspace.
 
+   - note: The XML is written directly using a `BlockXMLWriter`. To serialize the same workspace
+   repeatedly (eg. for autosaving), re-use a single `BlockXMLWriter` instead.
    - returns: The XML string.
    - throws:
    `BlocklyError`: Thrown if there was an error serializing any of the blocks in the workspace.
    */
   @objc(toXMLWithError:)
   public func toXML() throws -> String {
-    return try toXMLDocument().xml
+    return try BlockXMLWriter().xmlString(forWorkspace: self)
   }
 
   // MARK: - Internal
@@ -25,6 +25,7 @@
   static let TAG_NEXT_STATEMENT = "next"
   static let TAG_FIELD = "field"
   static let TAG_COMMENT = "comment"
+  static let TAG_MUTATION = "mutation"
   static let TAG_INPUTS_INLINE = "inline"
   static let TAG_DISABLED = "disabled"
   static let TAG_EDITABLE = "editable"
@@ -0,0 +1,287 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Caches the background bezier paths of blocks, keyed by the shape of each block.
+
+ Most blocks in a workspace share identical background geometry (eg. every "math_number" block in
+ a program has the same rows, connectors and scale). Instead of rebuilding the same path for each of
+ those blocks, `DefaultBlockView` looks up a shared path using a canonical signature of its
+ `DefaultBlockLayout.Background`, the path-related values in its `LayoutConfig` and its engine's
+ scale.
+
+ Cached paths are shared by every view with the same shape, so they must be treated as immutable.
+ Their underlying `CGPath` objects are shared by the layers that render them.
+
+ The cache is cleared automatically when the app receives a memory warning.
+
+ - note: This class is not thread-safe and should only be used from the main thread.
+ */
+@objc(BKYBlockPathCache)
+@objcMembers public final class BlockPathCache: NSObject {
+  // MARK: - Constants
+
+  /// The default maximum number of cached paths.
+  public static let DefaultCapacity = 512
+
+  /// The cache used by all `DefaultBlockView` instances.
+  public static let shared = BlockPathCache()
+
+  // MARK: - Properties
+
+  /// Flag determining if paths should be cached. If `false`, every lookup builds a new path.
+  public var isEnabled = true {
+    didSet {
+      if !isEnabled {
+        removeAllPaths()
+      }
+    }
+  }
+
+  /// The maximum number of cached paths. When the cache is full, the least recently used path is
+  /// evicted.
+  public var capacity: Int {
+    get { return _cache.capacity }
+    set { _cache.capacity = max(newValue, 1) }
+  }
+
+  /// The number of paths currently cached.
+  public var cachedPathCount: Int {
+    return _cache.count
+  }
+
+  /// The number of lookups that were served from the cache.
+  public var hitCount: Int {
+    return _cache.hitCount
+  }
+
+  /// The number of lookups that had to build a new path.
+  public var missCount: Int {
+    return _cache.missCount
+  }
+
+  /// The number of cached paths that were evicted to make room for other paths.
+  public var evictionCount: Int {
+    return _cache.evictionCount
+  }
+
+  /// The ratio of lookups that were served from the cache, between `0` and `1`.
+  public var hitRate: Double {
+    return _cache.hitRate
+  }
+
+  /// An estimate of the number of bytes used by the elements of all cached paths.
+  public private(set) var estimatedByteCount: Int = 0
+
+  /// The cached paths
+  fileprivate let _cache: LRUCache<ShapeSignature, CachedPath>
+
+  // MARK: - Initializers
+
+  /**
+   Initializes an empty cache.
+
+   - parameter capacity: The maximum number of cached paths.
+   */
+  public init(capacity: Int = BlockPathCache.DefaultCapacity) {
+    _cache = LRUCache(capacity: max(capacity, 1))
+    super.init()
+
+    _cache.evictionHandler = { [unowned self] _, cachedPath in
+      self.estimatedByteCount -= cachedPath.byteCount
+    }
+
+    NotificationCenter.default.addObserver(
+      self, selector: #selector(didReceiveMemoryWarning(_:)),
+      name: .UIApplicationDidReceiveMemoryWarning, object: nil)
+  }
+
+  deinit {
+    NotificationCenter.default.removeObserver(self)
+  }
+
+  // MARK: - Public
+
+  /**
+   Discards all cached paths. Statistics are not reset.
+   */
+  public func removeAllPaths() {
+    _cache.removeAllValues()
+    estimatedByteCount = 0
+  }
+
+  /**
+   Resets `hitCount`, `missCount` and `evictionCount` to `0`.
+   */
+  public func resetStatistics() {
+    _cache.resetStatistics()
+  }
+
+  // MARK: - Internal
+
+  /**
+   Returns the cached path for a shape, building and caching it if necessary.
+
+   - parameter signature: The signature of the shape.
+   - parameter makePath: Builds the path, if it isn't already cached.
+   - returns: A path that may be shared with other callers. It must not be mutated.
+   */
+  internal func path(
+    for signature: ShapeSignature, makePath: () -> UIBezierPath) -> UIBezierPath
+  {
+    guard isEnabled else {
+      return makePath()
+    }
+
+    if let cachedPath = _cache.value(forKey: signature) {
+      return cachedPath.path
+    }
+
+    let path = makePath()
+    let cachedPath = CachedPath(path: path, byteCount: BlockPathCache.byteCount(of: path))
+    _cache.setValue(cachedPath, forKey: signature)
+    estimatedByteCount += cachedPath.byteCount
+    return path
+  }
+
+  /**
+   Estimates the number of bytes used to store the elements of a path.
+
+   - parameter path: The path.
+   - returns: The estimated number of bytes.
+   */
+  internal static func byteCount(of path: UIBezierPath) -> Int {
+    var counts = PathElementCounts()
+    withUnsafeMutablePointer(to: &counts) { pointer in
+      path.cgPath.apply(info: pointer) { info, element in
+        guard let counts = info?.assumingMemoryBound(to: PathElementCounts.self) else {
+          return
+        }
+        counts.pointee.elementCount += 1
+        switch element.pointee.type {
+        case .moveToPoint, .addLineToPoint: counts.pointee.pointCount += 1
+        case .addQuadCurveToPoint: counts.pointee.pointCount += 2
+        case .addCurveToPoint: counts.pointee.pointCount += 3
+        case .closeSubpath: break
+        }
+      }
+    }
+
+    return counts.elementCount * MemoryLayout<CGPathElement>.size +
+      counts.pointCount * MemoryLayout<CGPoint>.size
+  }
+
+  // MARK: - Private
+
+  @objc private dynamic func didReceiveMemoryWarning(_ notification: Notification) {
+    removeAllPaths()
+  }
+}
+
+// MARK: - ShapeSignature
+
+extension BlockPathCache {
+  /**
+   A canonical description of everything that affects the background path of a block. Two blocks
+   with equal signatures have identical background paths.
+   */
+  internal struct ShapeSignature: Hashable {
+    /// The hat style of the block
+    let hat: Block.Style.HatType
+    /// The flattened geometry of the block, including its scale, connectors and rows
+    let geometry: [CGFloat]
+
+    var hashValue: Int {
+      return geometry.reduce(hat.hashValue) { $0 &* 31 &+ $1.hashValue }
+    }
+
+    /**
+     Creates the signature of a block layout's background.
+
+     - parameter layout: The block layout.
+     */
+    init(layout: DefaultBlockLayout) {
+      let background = layout.background
+      let config = layout.config
+      let capHatSize = config.workspaceSize(for: DefaultLayoutConfig.BlockHatCapSize)
+      let flag: (Bool) -> CGFloat = { $0 ? 1 : 0 }
+
+      var geometry: [CGFloat] = [
+        layout.engine.scale,
+        // In RTL, the path is flipped across the width of the view
+        layout.engine.rtl ? layout.viewFrame.size.width : -1,
+        config.workspaceUnit(for: DefaultLayoutConfig.NotchXOffset),
+        config.workspaceUnit(for: DefaultLayoutConfig.NotchWidth),
+        config.workspaceUnit(for: DefaultLayoutConfig.NotchHeight),
+        config.workspaceUnit(for: DefaultLayoutConfig.PuzzleTabWidth),
+        config.workspaceUnit(for: DefaultLayoutConfig.PuzzleTabHeight),
+        config.workspaceUnit(for: DefaultLayoutConfig.BlockCornerRadius),
+        capHatSize.width,
+        capHatSize.height,
+        flag(background.previousStatementConnector),
+        flag(background.nextStatementConnector),
+        flag(background.outputConnector),
+        background.firstLineHeight,
+        background.leadingEdgeXOffset,
+        background.leadingEdgeYOffset,
+        CGFloat(background.rows.count)
+      ]
+
+      for row in background.rows {
+        geometry += [
+          flag(row.isStatement),
+          flag(row.outputConnector),
+          row.rightEdge,
+          row.topPadding,
+          row.bottomPadding,
+          row.middleHeight,
+          row.statementIndent,
+          CGFloat(row.inlineConnectors.count)
+        ]
+
+        for inlineConnector in row.inlineConnectors {
+          geometry += [
+            inlineConnector.relativePosition.x,
+            inlineConnector.relativePosition.y,
+            inlineConnector.size.width,
+            inlineConnector.size.height,
+            inlineConnector.firstLineHeight
+          ]
+        }
+      }
+
+      self.hat = background.hat
+      self.geometry = geometry
+    }
+
+    static func ==(lhs: ShapeSignature, rhs: ShapeSignature) -> Bool {
+      return lhs.hat == rhs.hat && lhs.geometry == rhs.geometry
+    }
+  }
+
+  /// A cached path, along with its estimated size.
+  fileprivate struct CachedPath {
+    let path: UIBezierPath
+    let byteCount: Int
+  }
+
+  /// Running totals used to estimate the size of a path.
+  fileprivate struct PathElementCounts {
+    var elementCount = 0
+    var pointCount = 0
+  }
+}
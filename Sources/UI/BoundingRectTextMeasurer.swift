@@ -0,0 +1,168 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+
+/**
+ Measures text using the platform's text rendering engine (ie. `NSString.boundingRect(...)`).
+ */
+@objc(BKYBoundingRectTextMeasurer)
+@objcMembers public final class BoundingRectTextMeasurer: NSObject, TextMeasurer {
+  public func singleLineSize(of text: String, font: TextMeasurementFont) -> CGSize {
+    return multiLineSize(
+      of: text,
+      attributes: [NSAttributedStringKey.font: font.uiFont()],
+      constrainedToWidth: CGFloat(MAXFLOAT))
+  }
+
+  public func multiLineSize(
+    of text: String, font: TextMeasurementFont, constrainedToWidth width: CGFloat) -> CGSize
+  {
+    return multiLineSize(
+      of: text, attributes: [NSAttributedStringKey.font: font.uiFont()], constrainedToWidth: width)
+  }
+
+  /**
+   Computes the size of the bounding box that would be needed to render text using a set of text
+   attributes, constrained to a maximum width.
+
+   - parameter text: The text to measure.
+   - parameter attributes: A dictionary of text attributes to be applied to the entire text.
+   - parameter width: The maximum width the text can occupy when rendered.
+   - returns: The size required to render the text.
+   */
+  public func multiLineSize(
+    of text: String, attributes: [NSAttributedStringKey : Any]?, constrainedToWidth width: CGFloat)
+    -> CGSize
+  {
+    let boundingBox = text.boundingRect(
+      with: CGSize(width: width, height: CGFloat(MAXFLOAT)),
+      options: NSStringDrawingOptions.usesLineFragmentOrigin,
+      attributes: attributes,
+      context: nil)
+
+    // Use ceiling since you can't split a pixel
+    return CGSize(width: ceil(boundingBox.size.width), height: ceil(boundingBox.size.height))
+  }
+}
+
+// MARK: - UIFont Support
+
+extension TextMeasurementFont {
+  /// Descriptions of the `UIFont` instances that have been measured, so their font descriptors
+  /// don't need to be inspected on every measurement.
+  fileprivate static let uiFontDescriptions = NSCache<UIFont, TextMeasurementFont>()
+
+  /**
+   Returns a description of a `UIFont`, reusing a previous description of an equal font if one is
+   still cached.
+
+   - parameter font: The font to describe.
+   - returns: A description of `font`.
+   */
+  internal static func cachedDescription(of font: UIFont) -> TextMeasurementFont {
+    if let description = uiFontDescriptions.object(forKey: font) {
+      return description
+    }
+
+    let description = TextMeasurementFont(font: font)
+    uiFontDescriptions.setObject(description, forKey: font)
+    return description
+  }
+
+  /**
+   Initializes a description of a `UIFont`.
+
+   - parameter font: The font to describe.
+   */
+  public convenience init(font: UIFont) {
+    var traits = Traits()
+    let symbolicTraits = font.fontDescriptor.symbolicTraits
+    if symbolicTraits.contains(.traitBold) {
+      traits.insert(.bold)
+    }
+    if symbolicTraits.contains(.traitItalic) {
+      traits.insert(.italic)
+    }
+    if symbolicTraits.contains(.traitMonoSpace) {
+      traits.insert(.monospace)
+    }
+
+    self.init(name: font.fontName, pointSize: font.pointSize, traits: traits, platformFont: font)
+  }
+
+  /**
+   Returns the `UIFont` described by this font. If this font was created from a `UIFont`, that font
+   is returned. Otherwise, the font is looked up by name, falling back to the system font if no font
+   with that name exists.
+
+   - returns: The `UIFont` described by this font.
+   */
+  internal func uiFont() -> UIFont {
+    if let font = platformFont as? UIFont {
+      return font
+    }
+
+    if let font = UIFont(name: name, size: pointSize) {
+      return font
+    }
+
+    let systemFont = UIFont.systemFont(ofSize: pointSize)
+    var symbolicTraits = UIFontDescriptorSymbolicTraits()
+    if traits.contains(.bold) {
+      symbolicTraits.insert(.traitBold)
+    }
+    if traits.contains(.italic) {
+      symbolicTraits.insert(.traitItalic)
+    }
+    if traits.contains(.monospace) {
+      symbolicTraits.insert(.traitMonoSpace)
+    }
+    if let descriptor = systemFont.fontDescriptor.withSymbolicTraits(symbolicTraits) {
+      return UIFont(descriptor: descriptor, size: pointSize)
+    }
+    return systemFont
+  }
+}
+
+extension TextMeasurer {
+  /**
+   Computes the size of the bounding box that would be needed to render text using a given
+   `UIFont`, on a single line.
+
+   - parameter text: The text to measure.
+   - parameter font: The font used to render the text.
+   - returns: The size required to render the text.
+   */
+  public func singleLineSize(of text: String, font: UIFont) -> CGSize {
+    return singleLineSize(of: text, font: TextMeasurementFont.cachedDescription(of: font))
+  }
+
+  /**
+   Computes the size of the bounding box that would be needed to render text using a given
+   `UIFont`, constrained to a maximum width.
+
+   - parameter text: The text to measure.
+   - parameter font: The font used to render the text.
+   - parameter width: The maximum width the text can occupy when rendered.
+   - returns: The size required to render the text.
+   */
+  public func multiLineSize(
+    of text: String, font: UIFont, constrainedToWidth width: CGFloat) -> CGSize
+  {
+    return multiLineSize(
+      of: text, font: TextMeasurementFont.cachedDescription(of: font), constrainedToWidth: width)
+  }
+}
@@ -356,19 +356,39 @@ public protocol WorkbenchViewControllerDelegate: class {
   /// Flag determining if this view controller should be recording events for undo/redo purposes.
   open fileprivate(set) var shouldRecordEvents = true
 
+  /// The undo/redo history of the main workspace.
+  open fileprivate(set) lazy var history: WorkspaceHistory = {
+    let history = WorkspaceHistory()
+    history.delegate = self
+    return history
+  }()
+  /// Stack of layout coordinators that have a batch of updates open, for each nested call to
+  /// `beginBatchUpdates()`
+  fileprivate var _batchUpdateCoordinators = [[WorkspaceLayoutCoordinator]]()
+
   /// Stack of events to run when applying "undo" actions. The events are sorted in
   /// chronological order, where the first event to "undo" is at the end of the array.
-  open var undoStack = [BlocklyEvent]() {
-    didSet {
-      undoButton.isEnabled = !undoStack.isEmpty
+  /// - note: This is derived from `self.history`, and excludes steps that have been compacted.
+  /// Setting this value rebuilds `self.history` from the new undo stack and the current redo
+  /// stack, which drops any compacted steps.
+  open var undoStack: [BlocklyEvent] {
+    get { return history.undoableEvents }
+    set {
+      history.reset(undoableEvents: newValue, redoableEvents: history.redoableEvents)
+      updateUndoRedoButtons()
     }
   }
 
   /// Stack of events to run when applying "redo" actions. The events are sorted in reverse
   /// chronological order, where the first event to "redo" is at the end of the array.
-  open var redoStack = [BlocklyEvent]() {
-    didSet {
-      redoButton.isEnabled = !redoStack.isEmpty
+  /// - note: This is derived from `self.history`, and excludes steps that have been compacted.
+  /// Setting this value rebuilds `self.history` from the current undo stack and the new redo
+  /// stack, which drops any compacted steps.
+  open var redoStack: [BlocklyEvent] {
+    get { return history.redoableEvents.reversed() }
+    set {
+      history.reset(undoableEvents: history.undoableEvents, redoableEvents: newValue.reversed())
+      updateUndoRedoButtons()
     }
   }
 
@@ -742,6 +762,10 @@ public protocol WorkbenchViewControllerDelegate: class {
 
     // Fire any events that were created as a result of loading a new workspace.
     EventManager.shared.firePendingEvents()
+
+    // Start a new undo/redo history for this workspace
+    history.reset(workspace: workspace)
+    updateUndoRedoButtons()
   }
 
   /**
@@ -1094,21 +1118,9 @@ extension WorkbenchViewController: EventManagerListener {
     }
 
     if event.workspaceID == workspace?.uuid {
-      // Try to merge this event with the last one in the undo stack
-      if let lastEvent = undoStack.last,
-        let mergedEvent = lastEvent.merged(withNextChronologicalEvent: event) {
-        undoStack.removeLast()
-
-        if !mergedEvent.isDiscardable() {
-          undoStack.append(mergedEvent)
-        }
-      } else {
-        // Couldn't merge event with last one, just append it
-        undoStack.append(event)
-      }
-
-      // Clear the redo stack now since a new event has been added to the undo stack
-      redoStack.removeAll()
+      // Recording an event also clears any steps that could be redone
+      history.record(event)
+      updateUndoRedoButtons()
     }
   }
 }
@@ -1130,25 +1142,22 @@ extension WorkbenchViewController {
     }
   }
 
+  fileprivate func updateUndoRedoButtons() {
+    undoButton.isEnabled = history.canUndo
+    redoButton.isEnabled = history.canRedo
+  }
+
   @objc fileprivate dynamic func didTapUndoButton(_ sender: UIButton) {
-    guard !undoStack.isEmpty else {
+    guard history.canUndo else {
       return
     }
 
     // Don't listen to any events, to avoid echoing
     shouldRecordEvents = false
 
-    // Pop off the next group of events from the undo stack. These events will already be sorted
-    // in the order which they should be played (reverse chronological order).
-    let events = popGroupedEvents(fromStack: &undoStack)
-
-    // Run each event in order
-    for event in events {
-      update(fromEvent: event, runForward: false)
-    }
-
-    // Add events back to redo stack
-    redoStack.append(contentsOf: events)
+    // Undo the last group of events, in reverse chronological order
+    history.undo()
+    updateUndoRedoButtons()
 
     // Fire pending events before listening to events again, in case outside listeners need to
     // update their state from those events.
@@ -1159,24 +1168,16 @@ extension WorkbenchViewController {
   }
 
   @objc fileprivate dynamic func didTapRedoButton(_ sender: UIButton) {
-    guard !redoStack.isEmpty else {
+    guard history.canRedo else {
       return
     }
 
     // Don't listen to any events, to avoid echoing
     shouldRecordEvents = false
 
-    // Pop off the next group of events from the redo stack. These events will already be sorted
-    // in the order which they should be played (chronological order).
-    let events = popGroupedEvents(fromStack: &redoStack)
-
-    // Run each event in order
-    for event in events {
-      update(fromEvent: event, runForward: true)
-    }
-
-    // Add events back to undo stack
-    undoStack.append(contentsOf: events)
+    // Redo the next group of events, in chronological order
+    history.redo()
+    updateUndoRedoButtons()
 
     // Fire pending events before listening to events again, in case outside listeners need to
     // update their state from those events.
@@ -1210,6 +1211,35 @@ extension WorkbenchViewController {
     }
   }
 
+  /**
+   Updates the workbench based on a group of `BlocklyEvent` objects, as a single transaction.
+
+   Events are applied inside one batch of updates on the workspace and trash can layout
+   coordinators (see `WorkspaceLayoutCoordinator.beginBatchUpdates()`), so each affected block
+   group is only laid out once, after every event has been applied.
+
+   - parameter events: The events, in chronological order.
+   - parameter runForward: Flag determining if the events should be run forward (`true` for redo
+   operations) or run backward (`false` for undo operations). When run backward, events are
+   applied in reverse chronological order.
+   */
+  open func update(fromEvents events: [BlocklyEvent], runForward: Bool) {
+    beginBatchUpdates()
+    defer {
+      commitBatchUpdates()
+    }
+
+    if runForward {
+      for event in events {
+        update(fromEvent: event, runForward: true)
+      }
+    } else {
+      for event in events.reversed() {
+        update(fromEvent: event, runForward: false)
+      }
+    }
+  }
+
   /**
    Updates the workbench based on a `BlocklyEvent.Create`.
 
@@ -1397,36 +1427,134 @@ extension WorkbenchViewController {
       }
     }
   }
+}
 
-  /**
-   Pops a group of events from the end of a stack of events and returns them in the order they
-   were popped off the stack.
+// MARK: - WorkspaceHistoryDelegate Implementation
+
+extension WorkbenchViewController: WorkspaceHistoryDelegate {
+  open func workspaceHistory(
+    _ history: WorkspaceHistory, applyEvent event: BlocklyEvent, runForward: Bool)
+  {
+    update(fromEvent: event, runForward: runForward)
+  }
+
+  open func workspaceHistory(
+    _ history: WorkspaceHistory, restoreCheckpoint snapshot: Data, runForward: Bool)
+  {
+    guard let coordinator = _workspaceLayoutCoordinator else {
+      return
+    }
 
-   If the top of the stack contains an event with a group ID, this method will pop off all
-   events that match that group ID.
-   If the top of the stack contains an event without a group ID, only that event is popped off.
+    do {
+      let blockTrees = try WorkspaceSnapshot.blockTrees(fromData: snapshot, factory: blockFactory)
+      let workspace = coordinator.workspaceLayout.workspace
+      let oldBlocks = workspace.allBlocks
+      try coordinator.performBatchUpdates {
+        // Remove and re-add all trees in one call each, so listeners (eg. `ProcedureCoordinator`)
+        // see every tree at once. Otherwise, removing a procedure definition would also remove its
+        // callers a second time, and re-adding a caller before its definition would auto-create a
+        // duplicate definition. Top-level blocks aren't connected to anything, so they don't need
+        // to be disconnected through the coordinator first.
+        try workspace.removeBlockTrees(workspace.topLevelBlocks())
+        try workspace.addBlockTrees(blockTrees.map { $0.rootBlock })
+      }
+      try updateTrash(afterRestoringCheckpointFrom: oldBlocks, runForward: runForward)
+    } catch let error {
+      bky_assertionFailure("Could not restore workspace checkpoint: \(error)")
+    }
+  }
 
-   - parameter stack: The stack of events.
-   - returns: An array of grouped events, sorted in the order they were popped off the stack.
+  /**
+   Updates the trash can after a checkpoint has been restored, the same way that replaying the
+   `BlocklyEvent.Delete` events between both states would have (see
+   `update(fromDeleteEvent:runForward:)`).
+
+   - parameter oldBlocks: All blocks that were in the workspace before the checkpoint was restored,
+   keyed by their uuid.
+   - parameter runForward: `true` if restoring the checkpoint redid changes, or `false` if it undid
+   them.
    */
-  fileprivate func popGroupedEvents(fromStack stack: inout [BlocklyEvent]) -> [BlocklyEvent] {
-    var events = [BlocklyEvent]()
+  fileprivate func updateTrash(
+    afterRestoringCheckpointFrom oldBlocks: [String: Block], runForward: Bool) throws
+  {
+    guard let workspace = self.workspace else {
+      return
+    }
 
-    if let lastEvent = stack.popLast() {
-      events.append(lastEvent)
+    if runForward {
+      // Blocks that are no longer in the workspace have been deleted, so move them to the trash.
+      // Only trash the top-most block of each deleted group, detached from any blocks that are
+      // still in the workspace. The old blocks have been discarded, so they can be changed freely.
+      var deletedBlocks = [Block]()
+      for (uuid, block) in oldBlocks where workspace.allBlocks[uuid] == nil && !block.shadow {
+        if let parent = block.inferiorConnection?.targetBlock,
+          workspace.allBlocks[parent.uuid] == nil
+        {
+          continue
+        }
+        deletedBlocks.append(block)
+      }
 
-      // If this event was part of a group, get all other events part of this group
-      if let groupID = lastEvent.groupID {
-        while let event = stack.last,
-          event.groupID == groupID
+      for block in deletedBlocks {
+        block.inferiorConnection?.disconnect()
+        for descendant in block.allBlocksForTree()
+          where workspace.allBlocks[descendant.uuid] != nil
         {
-          stack.removeLast()
-          events.append(event)
+          descendant.inferiorConnection?.disconnect()
+          descendant.inferiorConnection?.disconnectShadow()
+        }
+
+        if trashCanViewController.workspace?.allBlocks[block.uuid] == nil {
+          addBlockToTrash(block)
+        }
+      }
+    } else if let trashWorkspace = trashCanViewController.workspace {
+      // Blocks that are back in the workspace have been un-deleted, so remove them from the trash
+      for uuid in workspace.allBlocks.keys where oldBlocks[uuid] == nil {
+        if let trashBlock = trashWorkspace.allBlocks[uuid], trashBlock.topLevel {
+          try trashCanViewController.workspaceLayoutCoordinator?.removeBlockTree(trashBlock)
         }
       }
     }
+  }
+
+  open func workspaceHistoryWillApplyChanges(_ history: WorkspaceHistory) {
+    // Apply every step of this operation in one transaction, so that affected block groups are
+    // only laid out once at the end
+    beginBatchUpdates()
+  }
+
+  open func workspaceHistoryDidApplyChanges(_ history: WorkspaceHistory) {
+    commitBatchUpdates()
+  }
+}
+
+// MARK: - Batch Updates
 
-    return events
+extension WorkbenchViewController {
+  fileprivate func beginBatchUpdates() {
+    var coordinators = [WorkspaceLayoutCoordinator]()
+    for workspaceLayoutCoordinator in
+      [_workspaceLayoutCoordinator, trashCanViewController.workspaceLayoutCoordinator]
+    {
+      if let coordinator = workspaceLayoutCoordinator {
+        coordinator.beginBatchUpdates()
+        coordinators.append(coordinator)
+      }
+    }
+    _batchUpdateCoordinators.append(coordinators)
+  }
+
+  fileprivate func commitBatchUpdates() {
+    // Commit the same coordinators that were opened, in case any have been replaced since
+    guard let coordinators = _batchUpdateCoordinators.popLast() else {
+      bky_assertionFailure("`commitBatchUpdates()` was called without a matching " +
+        "`beginBatchUpdates()`.")
+      return
+    }
+    for coordinator in coordinators.reversed() {
+      coordinator.commitBatchUpdates()
+    }
   }
 }
 
@@ -1815,7 +1943,7 @@ extension WorkbenchViewController: BlocklyPanGestureRecognizerDelegate {
           try _workspaceLayoutCoordinator?.removeBlockTree(blockLayout.block)
 
           // Enable the entire block tree, before adding it to the trash can.
-          for block in blockLayout.block.allBlocksForTree() {
+          for block in allBlocksToRemove {
             block.disabled = false
           }
 
@@ -24,6 +24,11 @@ protocol BlockGroupViewDelegate: class {
    Event that is called when a `BlockGroupView` has its `dragging` property.
    */
   func blockGroupViewDidUpdateDragging(_ blockGroupView: BlockGroupView)
+
+  /**
+   Event that is called when a `BlockGroupView` has updated its `frame` from its layout.
+   */
+  func blockGroupViewDidUpdateFrame(_ blockGroupView: BlockGroupView)
 }
 
 /**
@@ -63,8 +68,28 @@ protocol BlockGroupViewDelegate: class {
     }
   }
 
+  /// The level of detail that this view and its descendants are rendered at. Nested block group
+  /// views always match the level of detail of their top-level block group view.
+  public var levelOfDetail: LevelOfDetail = .full {
+    didSet {
+      if levelOfDetail != oldValue {
+        applyLevelOfDetail(toSubviewsOf: self)
+        updateRasterization()
+      }
+    }
+  }
+
   // MARK: - Super
 
+  open override func didMoveToSuperview() {
+    super.didMoveToSuperview()
+
+    if let parentBlockGroupView = bky_firstAncestor(ofType: BlockGroupView.self) {
+      levelOfDetail = parentBlockGroupView.levelOfDetail
+    }
+    updateRasterization()
+  }
+
   /**
    Returns the furthest descendant of the receiver in the view hierarchy that contains a specified
    point. Unlike the default implementation, block group view will not return itself.
@@ -113,6 +138,7 @@ protocol BlockGroupViewDelegate: class {
       if flags.intersectsWith([Layout.Flag_NeedsDisplay, Layout.Flag_UpdateViewFrame]) {
         // Update the view frame
         self.frame = layout.viewFrame
+        self.delegate?.blockGroupViewDidUpdateFrame(self)
       }
 
       if flags.intersectsWith([Layout.Flag_NeedsDisplay, BlockGroupLayout.Flag_UpdateZIndex]) {
@@ -123,10 +149,85 @@ protocol BlockGroupViewDelegate: class {
   }
 
   open override func prepareForReuse() {
+    // Restore all descendant views to full detail before they're recycled
+    levelOfDetail = .full
+
     super.prepareForReuse()
 
     for subview in self.subviews {
       subview.removeFromSuperview()
     }
   }
+
+  // MARK: - Private
+
+  /**
+   Hides or shows the field views inside a view, and passes the current level of detail on to
+   nested block group views.
+
+   - parameter view: The view whose subviews should be updated.
+   */
+  fileprivate func applyLevelOfDetail(toSubviewsOf view: UIView) {
+    for subview in view.subviews {
+      if let blockGroupView = subview as? BlockGroupView {
+        blockGroupView.levelOfDetail = levelOfDetail
+      } else if let fieldView = subview as? FieldView {
+        fieldView.isHidden = (levelOfDetail != .full)
+      } else {
+        applyLevelOfDetail(toSubviewsOf: subview)
+      }
+    }
+  }
+
+  /**
+   Caches the contents of this view as a bitmap if it's rendered at the `.rasterized` level of
+   detail. Only top-level block group views are rasterized, since their bitmap already contains
+   every nested block group view.
+   */
+  fileprivate func updateRasterization() {
+    let shouldRasterize = (levelOfDetail == .rasterized) &&
+      bky_firstAncestor(ofType: BlockGroupView.self) == nil
+
+    if layer.shouldRasterize != shouldRasterize {
+      layer.rasterizationScale = UIScreen.main.scale
+      layer.shouldRasterize = shouldRasterize
+    }
+  }
+}
+
+// MARK: - Level Of Detail
+
+extension BlockGroupView {
+  /**
+   The amount of detail that a block group view is rendered with. Less detail is used when the
+   workspace is zoomed out, where individual fields can't be read anyway.
+   */
+  @objc(BKYBlockGroupViewLevelOfDetail)
+  public enum LevelOfDetail: Int {
+    case
+      /// Blocks are rendered with all of their fields.
+      full = 0,
+      /// Blocks are rendered as silhouettes of their backgrounds, without any field views.
+      silhouette,
+      /// Blocks are rendered as silhouettes, and each top-level block group is cached as a bitmap.
+      rasterized
+
+    /**
+     Returns the level of detail for a given workspace scale.
+
+     - parameter scale: The scale of the workspace.
+     - parameter config: The config that specifies the scale thresholds for each level of detail
+     (`LayoutConfig.SilhouetteDetailScale` and `LayoutConfig.RasterizedDetailScale`).
+     - returns: The level of detail to render blocks with at `scale`.
+     */
+    public static func forScale(_ scale: CGFloat, config: LayoutConfig) -> LevelOfDetail {
+      if scale < config.float(for: LayoutConfig.RasterizedDetailScale) {
+        return .rasterized
+      } else if scale < config.float(for: LayoutConfig.SilhouetteDetailScale) {
+        return .silhouette
+      } else {
+        return .full
+      }
+    }
+  }
 }
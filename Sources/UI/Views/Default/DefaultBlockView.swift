@@ -277,6 +277,14 @@ import Foundation
       return nil
     }
 
+    // Blocks with the same shape share the same (immutable) path
+    let signature = BlockPathCache.ShapeSignature(layout: layout)
+    return BlockPathCache.shared.path(for: signature) {
+      self.makeBlockBackgroundBezierPath(layout: layout)
+    }
+  }
+
+  fileprivate func makeBlockBackgroundBezierPath(layout: DefaultBlockLayout) -> UIBezierPath {
     let path = WorkspaceBezierPath(engine: layout.engine)
     let background = layout.background
     var previousBottomPadding: CGFloat = 0
@@ -49,4 +49,12 @@ import Foundation
       self.isUserInteractionEnabled = fieldLayout.userInteractionEnabled
     }
   }
+
+  open override func didMoveToSuperview() {
+    super.didMoveToSuperview()
+
+    // Fields are only rendered when their block group is rendered in full detail
+    let levelOfDetail = bky_firstAncestor(ofType: BlockGroupView.self)?.levelOfDetail ?? .full
+    isHidden = (levelOfDetail != .full)
+  }
 }
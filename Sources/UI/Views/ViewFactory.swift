@@ -24,7 +24,7 @@ import Foundation
   // MARK: - Properties
 
   /// Object pool for holding reusable views.
-  private let _objectPool = ObjectPool()
+  public let objectPool = ObjectPool()
 
   /// Dictionary that maps `Layout` subclasses (using their class' `hash()` value) to their
   /// `LayoutView` type
@@ -103,7 +103,24 @@ import Foundation
    - returns: An object of the given `type`.
    */
   open func view<T>(forType type: T.Type) -> T where T: UIView {
-    return _objectPool.object(forType: type)
+    return objectPool.object(forType: type)
+  }
+
+  /**
+   Creates views ahead of time for a given `Layout` type, so they can be re-used by
+   `makeView(layout:)` without having to be created at that point. This is best called while the
+   app is idle (eg. before a large workspace is loaded).
+
+   - parameter layoutType: The `Layout.Type` whose registered view type should be created.
+   - parameter count: The number of recycled views that should be available for the layout type.
+   - throws:
+   `BlocklyError`: Thrown if no view type has been registered for `layoutType`.
+   */
+  open func prewarmViews(forLayoutType layoutType: Layout.Type, count: Int) throws {
+    guard let viewType = _viewMapping[layoutType.hash()] else {
+      throw BlocklyError(.viewNotFound, "Could not retrieve view for \(layoutType)")
+    }
+    objectPool.prewarm(viewType, count: count)
   }
 
   /**
@@ -114,7 +131,7 @@ import Foundation
    */
   open func recycleView(_ view: UIView) {
     if let recyclableView = view as? Recyclable {
-      _objectPool.recycleObject(recyclableView)
+      objectPool.recycleObject(recyclableView)
     }
   }
 
@@ -106,6 +106,41 @@ View for rendering a `WorkspaceLayout`.
   /// Enables/disables the zooming of a workspace. Defaults to false.
   open var allowZoom = false
 
+  /// Flag determining if block group views that are far outside the visible area of the scroll
+  /// view should be detached from the view hierarchy, so they aren't rendered. Defaults to `true`.
+  open var cullsOffscreenBlockGroupViews = true {
+    didSet {
+      if cullsOffscreenBlockGroupViews != oldValue {
+        updateVisibleBlockGroupViews()
+      }
+    }
+  }
+
+  /// Statistics for the last time block group views were culled against the visible area of the
+  /// scroll view.
+  public fileprivate(set) var lastViewportCulling = ViewportCullingStatistics()
+
+  /// Flag determining if block group views should be rendered with less detail when the workspace
+  /// is zoomed out below the scales specified by `LayoutConfig.SilhouetteDetailScale` and
+  /// `LayoutConfig.RasterizedDetailScale`. Defaults to `true`.
+  open var reducesDetailWhenZoomedOut = true {
+    didSet {
+      if reducesDetailWhenZoomedOut != oldValue {
+        updateLevelOfDetail()
+      }
+    }
+  }
+
+  /// The level of detail that block group views are currently rendered at.
+  public fileprivate(set) var levelOfDetail: BlockGroupView.LevelOfDetail = .full
+
+  /// Spatial index of the frames of all block group views, in the coordinate system of
+  /// `scrollView.containerView`
+  fileprivate let _blockGroupViewIndex = TileIndex<BlockGroupView>(tileSize: 512)
+
+  /// Block group views that are currently attached to the view hierarchy
+  fileprivate var _attachedBlockGroupViews = Set<BlockGroupView>()
+
   /// The last known value for `workspaceLayout.contentOrigin`
   fileprivate var _lastKnownContentOrigin: WorkspacePoint = WorkspacePoint.zero
 
@@ -165,18 +200,19 @@ View for rendering a `WorkspaceLayout`.
         self.updateCanvasSizeFromLayout()
       }
     }
+
+    updateLevelOfDetail()
   }
 
   open override func prepareForReuse() {
     super.prepareForReuse()
 
-    // Remove all block group views
-    for view in scrollView.containerView.subviews {
-      if let blockGroupView = view as? BlockGroupView {
-        removeBlockGroupView(blockGroupView)
-      }
+    // Remove all block group views (including those that have been culled)
+    for blockGroupView in blockGroupViews {
+      removeBlockGroupView(blockGroupView)
     }
 
+    levelOfDetail = .full
     scrollView.contentSize = CGSize.zero
     scrollView.containerView.frame = CGRect.zero
 
@@ -195,6 +231,7 @@ View for rendering a `WorkspaceLayout`.
     super.layoutSubviews()
 
     updateCanvasSizeFromLayout()
+    updateVisibleBlockGroupViews()
   }
 
   // MARK: - Public
@@ -236,6 +273,14 @@ View for rendering a `WorkspaceLayout`.
       return
     }
 
+    if let blockGroupLayout = blockLayout.rootBlockGroupLayout,
+      let blockGroupView = ViewManager.shared.findView(forLayout: blockGroupLayout)
+        as? BlockGroupView
+    {
+      // The block's position can only be calculated if it's in the view hierarchy
+      attachBlockGroupView(blockGroupView)
+    }
+
     var contentOffset = scrollView.contentOffset
     let blockViewRect = blockView.convert(blockView.bounds, to: scrollView)
     var scrollAreaInsets = UIEdgeInsets(top: scrollIntoViewEdgeInsets.top,
@@ -721,30 +766,13 @@ View for rendering a `WorkspaceLayout`.
   }
 
   /**
-   Returns `if a given block layout should be rendered within this workspace view.
-
-   - parameter blockLayout: The `BlockLayout`.
-   - returns: `true` if a given block layout should be rendered within this workspace view.
-   `false` otherwise.
-  */
-  fileprivate func shouldRenderBlockLayout(_ blockLayout: BlockLayout) -> Bool {
-    // Allow blocks within a 1/2 screen away to be rendered
-    let xDelta = scrollView.contentSize.width / 2
-    let yDelta = scrollView.contentSize.height / 2
-    let minX = scrollView.contentOffset.x - xDelta
-    let maxX = scrollView.contentOffset.x + scrollView.contentSize.width + xDelta
-    let minY = scrollView.contentOffset.y - yDelta
-    let maxY = scrollView.contentOffset.y + scrollView.contentSize.height + yDelta
-    let leftMostEdge = blockLayout.viewFrame.minX
-    let rightMostEdge = blockLayout.viewFrame.maxX
-    let topMostEdge = blockLayout.viewFrame.minY
-    let bottomMostEdge = blockLayout.viewFrame.maxY
-
-    return
-      ((minX <= leftMostEdge && leftMostEdge <= maxX) ||
-      (minX <= rightMostEdge && rightMostEdge <= maxX)) &&
-      ((minY <= topMostEdge && topMostEdge <= maxY) ||
-      (minY <= bottomMostEdge && bottomMostEdge <= maxY))
+   Returns the rect in which block group views should be rendered, in the coordinate system of
+   `scrollView.containerView`. This is the visible area of the scroll view, extended by half a
+   screen in every direction.
+   */
+  fileprivate func renderRect() -> CGRect {
+    let visibleRect = scrollView.convert(scrollView.bounds, to: scrollView.containerView)
+    return visibleRect.insetBy(dx: -visibleRect.width / 2, dy: -visibleRect.height / 2)
   }
 }
 
@@ -758,8 +786,9 @@ extension WorkspaceView: BlockGroupViewDelegate {
    */
   open func addBlockGroupView(_ blockGroupView: BlockGroupView) {
     blockGroupView.delegate = self
-    upsertBlockGroupView(blockGroupView)
     blockGroupViews.insert(blockGroupView)
+    _blockGroupViewIndex.update(blockGroupView, frame: blockGroupView.frame)
+    updateAttachment(forBlockGroupView: blockGroupView)
   }
 
   /**
@@ -770,6 +799,8 @@ extension WorkspaceView: BlockGroupViewDelegate {
   open func removeBlockGroupView(_ blockGroupView: BlockGroupView) {
     blockGroupView.delegate = nil
     blockGroupViews.remove(blockGroupView)
+    _blockGroupViewIndex.remove(blockGroupView)
+    _attachedBlockGroupViews.remove(blockGroupView)
     blockGroupView.removeFromSuperview()
   }
 
@@ -788,8 +819,112 @@ extension WorkspaceView: BlockGroupViewDelegate {
   }
 
   open func blockGroupViewDidUpdateDragging(_ blockGroupView: BlockGroupView) {
+    updateAttachment(forBlockGroupView: blockGroupView)
+  }
+
+  open func blockGroupViewDidUpdateFrame(_ blockGroupView: BlockGroupView) {
+    guard blockGroupViews.contains(blockGroupView) else {
+      return
+    }
+
+    _blockGroupViewIndex.update(blockGroupView, frame: blockGroupView.frame)
+    updateAttachment(forBlockGroupView: blockGroupView)
+  }
+
+  /**
+   Attaches or detaches every block group view, depending on whether it's inside the render rect
+   of the scroll view.
+
+   Only block group views inside the render rect (found through a spatial index of their frames)
+   and block group views that are currently attached are visited, so the cost of this method
+   depends on the number of visible blocks, rather than the total number of blocks.
+   */
+  internal func updateVisibleBlockGroupViews() {
+    var statistics = ViewportCullingStatistics()
+
+    let visibleViews: Set<BlockGroupView>
+    if cullsOffscreenBlockGroupViews {
+      visibleViews = _blockGroupViewIndex.elements(intersecting: renderRect())
+      statistics.visitedCount = _blockGroupViewIndex.lastQueryVisitedCount
+    } else {
+      visibleViews = blockGroupViews
+      statistics.visitedCount = blockGroupViews.count
+    }
+
+    for blockGroupView in visibleViews where !_attachedBlockGroupViews.contains(blockGroupView) {
+      attachBlockGroupView(blockGroupView)
+      statistics.attachedCount += 1
+    }
+
+    statistics.visitedCount += _attachedBlockGroupViews.count
+    for blockGroupView in _attachedBlockGroupViews
+      where !visibleViews.contains(blockGroupView) && !blockGroupView.dragging
+    {
+      detachBlockGroupView(blockGroupView)
+      statistics.detachedCount += 1
+    }
+
+    statistics.renderedCount = _attachedBlockGroupViews.count
+    statistics.totalCount = blockGroupViews.count
+    lastViewportCulling = statistics
+  }
+
+  /**
+   Attaches or detaches a single block group view, depending on whether it's being dragged or is
+   inside the render rect of the scroll view.
+
+   - parameter blockGroupView: The `BlockGroupView` to update.
+   */
+  fileprivate func updateAttachment(forBlockGroupView blockGroupView: BlockGroupView) {
+    if blockGroupView.dragging || !cullsOffscreenBlockGroupViews ||
+      blockGroupView.frame.intersects(renderRect())
+    {
+      attachBlockGroupView(blockGroupView)
+    } else {
+      detachBlockGroupView(blockGroupView)
+    }
+  }
+
+  fileprivate func attachBlockGroupView(_ blockGroupView: BlockGroupView) {
+    _attachedBlockGroupViews.insert(blockGroupView)
+    // Detached views aren't updated when the level of detail changes, so update it now
+    blockGroupView.levelOfDetail = levelOfDetail
     upsertBlockGroupView(blockGroupView)
   }
+
+  fileprivate func detachBlockGroupView(_ blockGroupView: BlockGroupView) {
+    if _attachedBlockGroupViews.remove(blockGroupView) != nil {
+      blockGroupView.removeFromSuperview()
+    }
+  }
+}
+
+// MARK: - Level Of Detail
+
+extension WorkspaceView {
+  /**
+   Updates the level of detail of all attached block group views, based on the current scale of
+   the workspace (including any zoom that is still in progress).
+
+   Detached block group views are updated when they're attached again, so the cost of switching
+   the level of detail only depends on the number of visible blocks.
+   */
+  internal func updateLevelOfDetail() {
+    var newLevelOfDetail = BlockGroupView.LevelOfDetail.full
+    if reducesDetailWhenZoomedOut, let workspaceLayout = self.workspaceLayout {
+      let scale = workspaceLayout.engine.scale * scrollView.zoomScale
+      newLevelOfDetail = .forScale(scale, config: workspaceLayout.config)
+    }
+
+    if newLevelOfDetail == levelOfDetail {
+      return
+    }
+
+    levelOfDetail = newLevelOfDetail
+    for blockGroupView in _attachedBlockGroupViews {
+      blockGroupView.levelOfDetail = newLevelOfDetail
+    }
+  }
 }
 
 // MARK: - UIScrollViewDelegate Implementation
@@ -835,6 +970,9 @@ extension WorkspaceView: UIScrollViewDelegate {
     offset.y = offset.y * scrollView.zoomScale
 
     scrollView.contentOffset = offset - _zoomPinchOffset
+
+    // Switch the level of detail as soon as the pinch crosses a threshold
+    updateLevelOfDetail()
   }
 
   public func scrollViewDidEndZooming(_ scrollView: UIScrollView,
@@ -861,6 +999,7 @@ extension WorkspaceView: UIScrollViewDelegate {
     workspaceLayout.engine.scale *= scale
     workspaceLayout.updateLayoutDownTree()
     removeExcessScrollSpace(ignoreRestrictions: true)
+    updateLevelOfDetail()
 
     scrollView.showsVerticalScrollIndicator = _scrollViewShowedVerticalScrollIndicator
     scrollView.showsHorizontalScrollIndicator = _scrollViewShowedHorizontalScrollIndicator
@@ -886,6 +1025,9 @@ extension WorkspaceView: UIScrollViewDelegate {
     // Scrolling the workspace updates the `scrollView.containerView.frame`. We need to update
     // the drag layer to match its new coordinates.
     updateDragLayerViewFrame()
+
+    // Attach block group views that have scrolled into view, and detach those that have left it
+    updateVisibleBlockGroupViews()
   }
 }
 
@@ -934,3 +1076,26 @@ extension WorkspaceView {
     }
   }
 }
+
+// MARK: - Viewport Culling Statistics
+
+/**
+ Statistics for a single pass of culling block group views against the visible area of a
+ `WorkspaceView`.
+ */
+public struct ViewportCullingStatistics {
+  /// The number of block group views that were visited during the pass
+  public internal(set) var visitedCount: Int = 0
+
+  /// The number of block group views that were attached to the view hierarchy during the pass
+  public internal(set) var attachedCount: Int = 0
+
+  /// The number of block group views that were detached from the view hierarchy during the pass
+  public internal(set) var detachedCount: Int = 0
+
+  /// The number of block group views attached to the view hierarchy after the pass
+  public internal(set) var renderedCount: Int = 0
+
+  /// The total number of block group views in the workspace view
+  public internal(set) var totalCount: Int = 0
+}
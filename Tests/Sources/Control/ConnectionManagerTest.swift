@@ -257,7 +257,7 @@ class ConnectionManagerTest: XCTestCase {
   // MARK: - ConnectionManager.YSortedList Tests
 
   func testYSortedListFindPosition() {
-    let list = manager.mainGroup.connections(forType: .previousStatement)
+    let list = ySortedList(manager.mainGroup)
     list.addConnection(createConnection(0, 0, .previousStatement))
     list.addConnection(createConnection(0, 1, .previousStatement))
     list.addConnection(createConnection(0, 2, .previousStatement))
@@ -270,7 +270,7 @@ class ConnectionManagerTest: XCTestCase {
   }
 
   func testYSortedListFind() {
-    let previousList = manager.mainGroup.connections(forType: .previousStatement)
+    let previousList = ySortedList(manager.mainGroup)
     for i in 0 ..< 10 {
       previousList.addConnection(createConnection(CGFloat(i), 0, .previousStatement))
       previousList.addConnection(createConnection(0, CGFloat(i), .previousStatement))
@@ -285,7 +285,7 @@ class ConnectionManagerTest: XCTestCase {
   }
 
   func testYSortedListOrdered() {
-    let list = manager.mainGroup.connections(forType: .previousStatement)
+    let list = ySortedList(manager.mainGroup)
     for i in 0 ..< 10 {
       list.addConnection(createConnection(0, CGFloat(9 - i), .previousStatement))
     }
@@ -319,7 +319,7 @@ class ConnectionManagerTest: XCTestCase {
 
   // Test YSortedList
   func testYSortedListSearchForClosest() {
-    let list = manager.mainGroup.connections(forType: .previousStatement)
+    let list = ySortedList(manager.mainGroup)
     let validator = manager.connectionValidator
 
     // search an empty list
@@ -351,7 +351,7 @@ class ConnectionManagerTest: XCTestCase {
   }
 
   func testYSortedListGetNeighbors() {
-    let list = manager.mainGroup.connections(forType: .previousStatement)
+    let list = ySortedList(manager.mainGroup)
 
     // Search an empty list
     XCTAssertTrue(getNeighborHelper(list, x: 10, y: 10, radius: 100).isEmpty)
@@ -396,7 +396,7 @@ class ConnectionManagerTest: XCTestCase {
   }
 
   func testYSortedListGetNeighborsWithDifferentTypes() {
-    let list = manager.mainGroup.connections(forType: .previousStatement)
+    let list = ySortedList(manager.mainGroup)
 
     let previousConnection = createConnection(0, 0, .previousStatement)
     previousConnection.typeChecks = ["String"]
@@ -416,7 +416,7 @@ class ConnectionManagerTest: XCTestCase {
   }
 
   func testYSortedListGetNeighborsWithShadows() {
-    let list = manager.mainGroup.connections(forType: .previousStatement)
+    let list = ySortedList(manager.mainGroup)
 
     let previousConnection = createConnection(0, 0, .previousStatement)
     list.addConnection(previousConnection)
@@ -447,8 +447,8 @@ class ConnectionManagerTest: XCTestCase {
   func testYSortedListTransferConnectionsToEmptyGroup() {
     let group1 = manager.startGroup(forBlock: nil)
     let group2 = manager.startGroup(forBlock: nil)
-    let list1 = group1.connections(forType: .previousStatement)
-    let list2 = group2.connections(forType: .previousStatement)
+    let list1 = ySortedList(group1)
+    let list2 = ySortedList(group2)
 
     // Create connections
     let yCoords1: [CGFloat] = [-25, -24.3, 1, 6, 29, -2, 4]
@@ -470,8 +470,8 @@ class ConnectionManagerTest: XCTestCase {
   func testYSortedListTransferConnectionsToNonEmptyGroup1() {
     let group1 = manager.startGroup(forBlock: nil)
     let group2 = manager.startGroup(forBlock: nil)
-    let list1 = group1.connections(forType: .previousStatement)
-    let list2 = group2.connections(forType: .previousStatement)
+    let list1 = ySortedList(group1)
+    let list2 = ySortedList(group2)
 
     // Create connections
     let yCoords1: [CGFloat] = [-3, 0, 1, 5, 5, 6, 8]
@@ -495,8 +495,8 @@ class ConnectionManagerTest: XCTestCase {
   func testYSortedListTransferConnectionsToNonEmptyGroup2() {
     let group1 = manager.startGroup(forBlock: nil)
     let group2 = manager.startGroup(forBlock: nil)
-    let list1 = group1.connections(forType: .previousStatement)
-    let list2 = group2.connections(forType: .previousStatement)
+    let list1 = ySortedList(group1)
+    let list2 = ySortedList(group2)
 
     // Create connections
     let yCoords1: [CGFloat] = [-3, 0, 1, 5, 5, 6, 8]
@@ -517,8 +517,222 @@ class ConnectionManagerTest: XCTestCase {
     XCTAssertTrue(isListSorted(list2))
   }
 
+  // MARK: - ConnectionManager.Grid Tests
+
+  func testGridAddRemoveConnections() {
+    let grid = ConnectionManager.Grid(cellSize: 10)
+    let connections = [
+      createConnection(0, 0, .previousStatement),
+      createConnection(-5, 25, .previousStatement),
+      createConnection(100, -300, .previousStatement),
+      createConnection(100, -300, .previousStatement)
+    ]
+
+    for connection in connections {
+      grid.addConnection(connection)
+      XCTAssertTrue(grid.contains(connection))
+    }
+    XCTAssertEqual(connections.count, grid.count)
+
+    grid.removeConnection(connections[2])
+    XCTAssertFalse(grid.contains(connections[2]))
+    XCTAssertTrue(grid.contains(connections[3]))
+    XCTAssertEqual(connections.count - 1, grid.count)
+
+    grid.removeAllConnections()
+    XCTAssertTrue(grid.isEmpty)
+  }
+
+  func testGridRemoveConnectionAfterPositionChangedWithoutNotification() {
+    let grid = ConnectionManager.Grid(cellSize: 10)
+    let connection = createConnection(0, 0, .previousStatement)
+    grid.addConnection(connection)
+
+    connection.moveToPosition(WorkspacePoint(x: 500, y: 500))
+    grid.removeConnection(connection)
+
+    XCTAssertFalse(grid.contains(connection))
+    XCTAssertTrue(grid.isEmpty)
+  }
+
+  func testGridSearchForClosest() {
+    let grid = ConnectionManager.Grid(cellSize: 4)
+    let validator = manager.connectionValidator
+
+    // search an empty grid
+    XCTAssertEqual(nil, searchIndex(grid, x: 10, y: 10, radius: 100, validator: validator))
+
+    grid.addConnection(createConnection(100, 0, .previousStatement))
+    XCTAssertEqual(nil, searchIndex(grid, x: 0, y: 0, radius: 5, validator: validator))
+    grid.removeAllConnections()
+
+    var column = [Connection]()
+    for i in 0 ..< 10 {
+      let connection = createConnection(0, CGFloat(i), .previousStatement)
+      column.append(connection)
+      grid.addConnection(connection)
+    }
+
+    XCTAssertEqual(column[9], searchIndex(grid, x: 0, y: 10, radius: 15, validator: validator))
+    XCTAssertEqual(nil, searchIndex(grid, x: 100, y: 100, radius: 3, validator: validator))
+    XCTAssertEqual(column[0], searchIndex(grid, x: 0, y: 0, radius: 0, validator: validator))
+
+    grid.addConnection(createConnection(6, 6, .previousStatement))
+    grid.addConnection(createConnection(5, 5, .previousStatement))
+
+    let result = searchIndex(grid, x: 4, y: 6, radius: 3, validator: validator)
+    XCTAssertEqual(5, result?.position.x)
+    XCTAssertEqual(5, result?.position.y)
+  }
+
+  func testGridMatchesYSortedList() {
+    let list = ConnectionManager.YSortedList()
+    let grid = ConnectionManager.Grid(cellSize: 16)
+    let validator = manager.connectionValidator
+
+    // Use distinct coordinates so there are no ties between equidistant connections
+    for i in 0 ..< 400 {
+      let x = CGFloat((i * 37) % 401) * 1.5 - 300.25
+      let y = CGFloat((i * 91) % 397) * 0.75 - 150.5
+      let connection = createConnection(x, y, .previousStatement)
+      list.addConnection(connection)
+      grid.addConnection(connection)
+    }
+
+    for i in 0 ..< 100 {
+      let x = CGFloat((i * 53) % 600) - 300
+      let y = CGFloat((i * 29) % 300) - 150
+      let radius = CGFloat(i % 40)
+
+      XCTAssertEqual(
+        searchIndex(list, x: x, y: y, radius: radius, validator: validator),
+        searchIndex(grid, x: x, y: y, radius: radius, validator: validator))
+
+      let connection = createConnection(x, y, .nextStatement)
+      XCTAssertEqual(
+        Set(list.neighbors(forConnection: connection, maxRadius: radius)),
+        Set(grid.neighbors(forConnection: connection, maxRadius: radius)))
+    }
+  }
+
+  func testGridTransferConnections() {
+    let group1 = ConnectionManager(indexStrategy: .grid(cellSize: 10)).startGroup(forBlock: nil)
+    let grid1 = group1.connections(forType: .previousStatement)
+    let grid2 = ConnectionManager.Grid(cellSize: 10)
+    let list = ConnectionManager.YSortedList()
+
+    let connections = createConnectionsForIndex(grid1, yCoords: [-25, 0, 12, 48, 48, 100])
+    grid1.transferConnections(toIndex: grid2)
+
+    for connection in connections {
+      XCTAssertFalse(grid1.contains(connection))
+      XCTAssertTrue(grid2.contains(connection))
+    }
+
+    grid2.transferConnections(toIndex: list)
+
+    XCTAssertTrue(grid2.isEmpty)
+    XCTAssertEqual(connections.count, list.count)
+    XCTAssertTrue(isListSorted(list))
+  }
+
+  func testGridStrategyStartAndMergeGroup() {
+    let gridManager = ConnectionManager(indexStrategy: .grid(cellSize: 10))
+    let connection = createConnection(5, 5, .previousStatement)
+    gridManager.trackConnection(connection)
+    XCTAssertTrue(gridManager.mainGroup.connections(forType: .previousStatement) is
+      ConnectionManager.Grid)
+
+    let group = gridManager.startGroup(forBlock: nil)
+    gridManager.trackConnection(connection, assignToGroup: group)
+    XCTAssertTrue(group.connections(forType: .previousStatement).contains(connection))
+    XCTAssertFalse(
+      gridManager.mainGroup.connections(forType: .previousStatement).contains(connection))
+
+    gridManager.mergeGroup(group, intoGroup: nil)
+    XCTAssertTrue(
+      gridManager.mainGroup.connections(forType: .previousStatement).contains(connection))
+    XCTAssertTrue(connection.positionDelegate === gridManager.mainGroup)
+  }
+
+  // MARK: - Benchmarks
+
+  func testBenchmarkYSortedListSearch10k() {
+    let list = ConnectionManager.YSortedList()
+    let queries = populateWideWorkspace(list)
+
+    measure {
+      self.runSearchQueries(queries, index: list)
+    }
+  }
+
+  func testBenchmarkGridSearch10k() {
+    let grid = ConnectionManager.Grid(cellSize: 48)
+    let queries = populateWideWorkspace(grid)
+
+    measure {
+      self.runSearchQueries(queries, index: grid)
+    }
+  }
+
   // MARK: - Private Helpers
 
+  fileprivate func ySortedList(_ group: ConnectionManager.Group) -> ConnectionManager.YSortedList {
+    return group.connections(forType: .previousStatement) as! ConnectionManager.YSortedList
+  }
+
+  fileprivate func createConnectionsForIndex(
+    _ index: ConnectionIndex, yCoords: [CGFloat]) -> [Connection]
+  {
+    var connections = [Connection]()
+    for i in 0 ..< yCoords.count {
+      let connection = createConnection(CGFloat(i), CGFloat(yCoords[i]), .previousStatement)
+      index.addConnection(connection)
+      connections.append(connection)
+    }
+    return connections
+  }
+
+  /**
+   Fills an index with 10,000 connections laid out in long horizontal rows (simulating wide
+   horizontal block flows) and returns a set of connections to search with.
+   */
+  fileprivate func populateWideWorkspace(_ index: ConnectionIndex) -> [Connection] {
+    // Connections don't need real source blocks to be indexed, and creating 10k blocks would
+    // dominate the setup time of the benchmark.
+    for i in 0 ..< 10_000 {
+      let connection = Connection(type: .previousStatement)
+      connection.moveToPosition(
+        WorkspacePoint(x: CGFloat(i % 500) * 120, y: CGFloat(i / 500) * 60))
+      index.addConnection(connection)
+    }
+
+    var queries = [Connection]()
+    for i in 0 ..< 500 {
+      let connection = Connection(type: .nextStatement)
+      connection.moveToPosition(
+        WorkspacePoint(x: CGFloat((i * 7919) % 60_000), y: CGFloat((i * 31) % 1_200)))
+      queries.append(connection)
+    }
+    return queries
+  }
+
+  fileprivate func runSearchQueries(_ queries: [Connection], index: ConnectionIndex) {
+    let validator = manager.connectionValidator
+    for query in queries {
+      _ = index.searchForClosestValidConnection(to: query, maxRadius: 24, validator: validator)
+      _ = index.neighbors(forConnection: query, maxRadius: 24)
+    }
+  }
+
+  fileprivate func searchIndex(_ index: ConnectionIndex, x: CGFloat, y: CGFloat,
+                               radius: CGFloat, validator: ConnectionValidator) -> Connection?
+  {
+    let connection = createConnection(x, y, .nextStatement)
+    return index.searchForClosestValidConnection(
+      to: connection, maxRadius: radius, validator: validator)
+  }
+
   fileprivate func createConnectionsForList(
     _ list: ConnectionManager.YSortedList, yCoords: [CGFloat])
     -> [Connection] {
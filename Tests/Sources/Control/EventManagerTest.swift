@@ -0,0 +1,238 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+@testable import Blockly
+import XCTest
+
+/** Tests for `EventManager` listeners and `EventFilter`. */
+class EventManagerTest: XCTestCase {
+
+  var _listeners = [RecordingListener]()
+
+  override func setUp() {
+    super.setUp()
+    EventManager.shared.firePendingEvents()
+  }
+
+  override func tearDown() {
+    for listener in _listeners {
+      EventManager.shared.removeListener(listener)
+    }
+    _listeners.removeAll()
+    super.tearDown()
+  }
+
+  // MARK: - Tests
+
+  func testCatchAllListenerReceivesAllEvents() {
+    let listener = addListener(filter: nil)
+
+    fire([
+      makeMoveEvent(workspaceID: "w1", blockID: "a"),
+      makeChangeEvent(workspaceID: "w2", blockID: "b"),
+      makeUIEvent(workspaceID: "w1")
+    ])
+
+    XCTAssertEqual(3, listener.events.count)
+  }
+
+  func testFilterByEventType() {
+    let listener = addListener(filter: EventFilter(eventTypes: [BlocklyEvent.Move.EVENT_TYPE]))
+
+    fire([
+      makeMoveEvent(workspaceID: "w1", blockID: "a"),
+      makeChangeEvent(workspaceID: "w1", blockID: "a")
+    ])
+
+    XCTAssertEqual(1, listener.events.count)
+    XCTAssertTrue(listener.events.first is BlocklyEvent.Move)
+  }
+
+  func testFilterByWorkspaceID() {
+    let listener = addListener(filter: EventFilter(workspaceIDs: ["w2"]))
+
+    fire([
+      makeMoveEvent(workspaceID: "w1", blockID: "a"),
+      makeChangeEvent(workspaceID: "w2", blockID: "b")
+    ])
+
+    XCTAssertEqual(1, listener.events.count)
+    XCTAssertEqual("w2", listener.events.first?.workspaceID)
+  }
+
+  func testFilterByBlockID() {
+    let listener = addListener(filter: EventFilter(blockIDs: ["b"]))
+
+    fire([
+      makeMoveEvent(workspaceID: "w1", blockID: "a"),
+      makeMoveEvent(workspaceID: "w1", blockID: "b"),
+      makeUIEvent(workspaceID: "w1")
+    ])
+
+    XCTAssertEqual(1, listener.events.count)
+    XCTAssertEqual("b", listener.events.first?.blockID)
+  }
+
+  func testFilterByBlockIDMatchesBlocksInsideDeletedTree() {
+    let factory = BlockFactory()
+    factory.load(fromDefaultFiles: .loopDefault)
+    let workspace = Workspace()
+    guard
+      let parent = BKYAssertDoesNotThrow({ try factory.makeBlock(name: "controls_repeat_ext") }),
+      let child = BKYAssertDoesNotThrow({ try factory.makeBlock(name: "controls_repeat_ext") }) else
+    {
+      return
+    }
+    BKYAssertDoesNotThrow {
+      try parent.firstInput(withName: "DO")?.connection?.connectTo(child.previousConnection)
+    }
+    BKYAssertDoesNotThrow { try workspace.addBlockTree(parent) }
+
+    let listener = addListener(filter: EventFilter(blockIDs: [child.uuid]))
+    if let event = BKYAssertDoesNotThrow({
+      try BlocklyEvent.Delete(workspace: workspace, block: parent)
+    }) {
+      fire([event])
+    }
+
+    XCTAssertEqual(1, listener.events.count)
+  }
+
+  func testCombinedFilter() {
+    let listener = addListener(filter: EventFilter(
+      eventTypes: [BlocklyEvent.Change.EVENT_TYPE], workspaceIDs: ["w1"], blockIDs: ["a"]))
+
+    fire([
+      makeChangeEvent(workspaceID: "w1", blockID: "a"),
+      makeChangeEvent(workspaceID: "w2", blockID: "a"),
+      makeChangeEvent(workspaceID: "w1", blockID: "b"),
+      makeMoveEvent(workspaceID: "w1", blockID: "a")
+    ])
+
+    XCTAssertEqual(1, listener.events.count)
+  }
+
+  func testAddingListenerAgainReplacesFilter() {
+    let listener = addListener(filter: EventFilter(eventTypes: [BlocklyEvent.Move.EVENT_TYPE]))
+    EventManager.shared.addListener(
+      listener, filter: EventFilter(eventTypes: [BlocklyEvent.Change.EVENT_TYPE]))
+
+    fire([
+      makeMoveEvent(workspaceID: "w1", blockID: "a"),
+      makeChangeEvent(workspaceID: "w1", blockID: "a")
+    ])
+
+    XCTAssertEqual(1, listener.events.count)
+    XCTAssertTrue(listener.events.first is BlocklyEvent.Change)
+  }
+
+  func testRemoveListener() {
+    let listener = addListener(filter: EventFilter(eventTypes: [BlocklyEvent.Move.EVENT_TYPE]))
+    EventManager.shared.removeListener(listener)
+
+    fire([makeMoveEvent(workspaceID: "w1", blockID: "a")])
+
+    XCTAssertEqual(0, listener.events.count)
+  }
+
+  func testListenersAreCalledInOrderAdded() {
+    var calls = [Int]()
+    let listener1 = addListener(filter: nil)
+    let listener2 = addListener(filter: EventFilter(eventTypes: [BlocklyEvent.Move.EVENT_TYPE]))
+    let listener3 = addListener(filter: nil)
+    listener1.onEvent = { calls.append(1) }
+    listener2.onEvent = { calls.append(2) }
+    listener3.onEvent = { calls.append(3) }
+
+    fire([makeMoveEvent(workspaceID: "w1", blockID: "a")])
+
+    XCTAssertEqual([1, 2, 3], calls)
+  }
+
+  func testCatchAllListenersAreCalledInOrderAddedForEveryEventType() {
+    var calls = [Int]()
+    let listener1 = addListener(filter: EventFilter(eventTypes: [BlocklyEvent.Move.EVENT_TYPE]))
+    let listener2 = addListener(filter: nil)
+    let listener3 = addListener(filter: EventFilter(
+      eventTypes: [BlocklyEvent.Move.EVENT_TYPE, BlocklyEvent.Change.EVENT_TYPE]))
+    listener1.onEvent = { calls.append(1) }
+    listener2.onEvent = { calls.append(2) }
+    listener3.onEvent = { calls.append(3) }
+
+    fire([makeMoveEvent(workspaceID: "w1", blockID: "a")])
+    XCTAssertEqual([1, 2, 3], calls)
+
+    calls.removeAll()
+    fire([makeChangeEvent(workspaceID: "w1", blockID: "a")])
+    XCTAssertEqual([2, 3], calls)
+
+    calls.removeAll()
+    fire([makeUIEvent(workspaceID: "w1")])
+    XCTAssertEqual([2], calls)
+
+    // Removing the typed listeners keeps sending every event to the catch-all listener
+    EventManager.shared.removeListener(listener1)
+    EventManager.shared.removeListener(listener3)
+    calls.removeAll()
+    fire([makeMoveEvent(workspaceID: "w1", blockID: "a")])
+    XCTAssertEqual([2], calls)
+  }
+
+  // MARK: - Helper methods
+
+  func addListener(filter: EventFilter?) -> RecordingListener {
+    let listener = RecordingListener()
+    _listeners.append(listener)
+    EventManager.shared.addListener(listener, filter: filter)
+    return listener
+  }
+
+  func fire(_ events: [BlocklyEvent]) {
+    for event in events {
+      EventManager.shared.addPendingEvent(event)
+    }
+    EventManager.shared.firePendingEvents()
+  }
+
+  func makeMoveEvent(workspaceID: String, blockID: String) -> BlocklyEvent.Move {
+    let event = BlocklyEvent.Move(
+      workspaceID: workspaceID, blockID: blockID, oldParentID: nil, oldInputName: nil,
+      oldPosition: WorkspacePoint(x: 0, y: 0))
+    event.newPosition = WorkspacePoint(x: 10, y: 10)
+    return event
+  }
+
+  func makeUIEvent(workspaceID: String) -> BlocklyEvent {
+    return BlocklyEvent(
+      type: BlocklyEvent.UI.EVENT_TYPE, workspaceID: workspaceID, groupID: nil, blockID: nil)
+  }
+
+  func makeChangeEvent(workspaceID: String, blockID: String) -> BlocklyEvent.Change {
+    return BlocklyEvent.Change(
+      element: BlocklyEvent.Change.elementField, workspaceID: workspaceID, blockID: blockID,
+      fieldName: "NUM", oldValue: "0", newValue: "1")
+  }
+}
+
+/** Listener that records every event it receives. */
+class RecordingListener: NSObject, EventManagerListener {
+  var events = [BlocklyEvent]()
+  var onEvent: (() -> Void)?
+
+  func eventManager(_ eventManager: EventManager, didFireEvent event: BlocklyEvent) {
+    events.append(event)
+    onEvent?()
+  }
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+@testable import Blockly
+import XCTest
+
+/** Tests for `WorkbenchViewController`. */
+class WorkbenchViewControllerTest: XCTestCase {
+
+  var _workbench: WorkbenchViewController!
+  var _workspace: Workspace!
+
+  override func setUp() {
+    super.setUp()
+
+    EventManager.shared.firePendingEvents()
+
+    _workbench = WorkbenchViewController(style: .defaultStyle)
+    _workbench.blockFactory.load(fromDefaultFiles: [.procedureDefault, .mathDefault])
+    _ = _workbench.view
+
+    _workspace = Workspace()
+    BKYAssertDoesNotThrow { () -> Void in
+      let toolbox = try Toolbox.makeToolbox(
+        xmlString: "<xml><category name=\"Functions\" custom=\"PROCEDURE\"></category></xml>",
+        factory: _workbench.blockFactory)
+      try _workbench.loadToolbox(toolbox)
+      try _workbench.loadWorkspace(_workspace)
+    }
+  }
+
+  override func tearDown() {
+    EventManager.shared.firePendingEvents()
+    _workbench = nil
+    _workspace = nil
+
+    super.tearDown()
+  }
+
+  // MARK: - Undo / Redo
+
+  func testRestoreCheckpointWithProcedures() {
+    guard let coordinator = _workbench.workspaceViewController.workspaceLayoutCoordinator,
+      let definitionBlock = BKYAssertDoesNotThrow({
+        try self._workbench.blockFactory.makeBlock(
+          name: ProcedureCoordinator.BLOCK_DEFINITION_NO_RETURN)
+      }),
+      let callerBlock = BKYAssertDoesNotThrow({
+        try self._workbench.blockFactory.makeBlock(
+          name: ProcedureCoordinator.BLOCK_CALLER_NO_RETURN)
+      }),
+      let numberBlock = BKYAssertDoesNotThrow({
+        try self._workbench.blockFactory.makeBlock(name: "math_number")
+      }) else
+    {
+      XCTFail("Could not build blocks")
+      return
+    }
+
+    // Add a procedure definition and a top-level caller, and capture a checkpoint after them
+    definitionBlock.procedureName = "proc"
+    callerBlock.procedureName = "proc"
+    BKYAssertDoesNotThrow {
+      try EventManager.shared.groupAndFireEvents {
+        try coordinator.addBlockTree(definitionBlock)
+        try coordinator.addBlockTree(callerBlock)
+      }
+    }
+    let history = _workbench.history
+    history.captureCheckpoint()
+
+    // Make another change, so there's something to undo
+    BKYAssertDoesNotThrow {
+      try EventManager.shared.groupAndFireEvents {
+        try coordinator.addBlockTree(numberBlock)
+      }
+    }
+    XCTAssertEqual(2, history.undoableStepCount)
+
+    // Undo past the checkpoint by restoring it
+    history.checkpointRestoreCost = 0
+    let restoreCount = history.checkpointRestoreCount
+    history.undo()
+    XCTAssertEqual(restoreCount + 1, history.checkpointRestoreCount)
+
+    // Each restored tree is deleted and created exactly once
+    var deletedBlockIDs = [String]()
+    var createdBlockIDs = [String]()
+    for event in EventManager.shared.pendingEvents {
+      if let deleteEvent = event as? BlocklyEvent.Delete, let blockID = deleteEvent.blockID {
+        deletedBlockIDs.append(blockID)
+      } else if let createEvent = event as? BlocklyEvent.Create, let blockID = createEvent.blockID {
+        createdBlockIDs.append(blockID)
+      }
+    }
+    XCTAssertEqual(
+      Set([definitionBlock.uuid, callerBlock.uuid, numberBlock.uuid]), Set(deletedBlockIDs))
+    XCTAssertEqual(3, deletedBlockIDs.count)
+    XCTAssertEqual(Set([definitionBlock.uuid, callerBlock.uuid]), Set(createdBlockIDs))
+    XCTAssertEqual(2, createdBlockIDs.count)
+
+    // The definition kept its name, and no duplicate definition was auto-created
+    let topLevelBlocks = _workspace.topLevelBlocks()
+    XCTAssertEqual(2, topLevelBlocks.count)
+    let definitionBlocks = topLevelBlocks.filter { $0.isProcedureDefinition }
+    let callerBlocks = topLevelBlocks.filter { $0.isProcedureCaller }
+    XCTAssertEqual(1, definitionBlocks.count)
+    XCTAssertEqual(1, callerBlocks.count)
+    XCTAssertEqual("proc", definitionBlocks.first?.procedureName)
+    XCTAssertEqual("proc", callerBlocks.first?.procedureName)
+  }
+
+  func testRestoreCheckpointUpdatesTrash() {
+    _workbench.keepTrashedBlocks = true
+    guard let coordinator = _workbench.workspaceViewController.workspaceLayoutCoordinator,
+      let block = BKYAssertDoesNotThrow({
+        try self._workbench.blockFactory.makeBlock(name: "math_number")
+      }) else
+    {
+      XCTFail("Could not build block")
+      return
+    }
+
+    // Add a block and then delete it to the trash, capturing checkpoints after each step
+    let history = _workbench.history
+    BKYAssertDoesNotThrow {
+      try EventManager.shared.groupAndFireEvents {
+        try coordinator.addBlockTree(block)
+      }
+    }
+    history.captureCheckpoint()
+    BKYAssertDoesNotThrow {
+      try EventManager.shared.groupAndFireEvents {
+        try coordinator.removeBlockTree(block)
+        self._workbench.addBlockToTrash(block)
+      }
+    }
+    history.captureCheckpoint()
+    XCTAssertEqual(2, history.undoableStepCount)
+    XCTAssertNotNil(_workbench.trashCanViewController.workspace?.allBlocks[block.uuid])
+
+    // Undoing the delete by restoring a checkpoint takes the block out of the trash
+    history.checkpointRestoreCost = 0
+    let restoreCount = history.checkpointRestoreCount
+    history.undo()
+    EventManager.shared.firePendingEvents()
+    XCTAssertEqual(restoreCount + 1, history.checkpointRestoreCount)
+    XCTAssertNotNil(_workspace.allBlocks[block.uuid])
+    XCTAssertNil(_workbench.trashCanViewController.workspace?.allBlocks[block.uuid])
+
+    // Redoing it puts the block back in the trash
+    history.redo()
+    EventManager.shared.firePendingEvents()
+    XCTAssertEqual(restoreCount + 2, history.checkpointRestoreCount)
+    XCTAssertNil(_workspace.allBlocks[block.uuid])
+    let trashBlock = _workbench.trashCanViewController.workspace?.allBlocks[block.uuid]
+    XCTAssertEqual(true, trashBlock?.topLevel)
+  }
+
+  func testSettingUndoAndRedoStacks() {
+    let undoEvent = BlocklyEvent.Change(
+      element: BlocklyEvent.Change.elementComment, workspaceID: _workspace.uuid, blockID: "a",
+      fieldName: nil, oldValue: "", newValue: "undo")
+    let redoEvent = BlocklyEvent.Change(
+      element: BlocklyEvent.Change.elementComment, workspaceID: _workspace.uuid, blockID: "a",
+      fieldName: nil, oldValue: "undo", newValue: "redo")
+
+    _workbench.undoStack = [undoEvent]
+    XCTAssertEqual(1, _workbench.history.undoableStepCount)
+    XCTAssertEqual(0, _workbench.history.redoableStepCount)
+    XCTAssertTrue(_workbench.undoStack.first === undoEvent)
+
+    _workbench.redoStack = [redoEvent]
+    XCTAssertEqual(1, _workbench.history.undoableStepCount)
+    XCTAssertEqual(1, _workbench.history.redoableStepCount)
+    XCTAssertTrue(_workbench.redoStack.first === redoEvent)
+
+    _workbench.undoStack = []
+    XCTAssertFalse(_workbench.history.canUndo)
+    XCTAssertEqual(1, _workbench.history.redoableStepCount)
+  }
+}
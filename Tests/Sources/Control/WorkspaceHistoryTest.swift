@@ -0,0 +1,375 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+@testable import Blockly
+import XCTest
+
+/** Tests for `WorkspaceHistory`. */
+class WorkspaceHistoryTest: XCTestCase {
+
+  var _blockFactory: BlockFactory!
+  var _workspace: Workspace!
+  var _history: WorkspaceHistory!
+  var _delegate: TestWorkspaceHistoryDelegate!
+  var _blockUUID: String!
+
+  override func setUp() {
+    super.setUp()
+
+    EventManager.shared.firePendingEvents()
+
+    _blockFactory = BlockFactory()
+    _blockFactory.load(fromDefaultFiles: .mathDefault)
+    _workspace = Workspace()
+
+    guard let block = BKYAssertDoesNotThrow({
+      try self._blockFactory.makeBlock(name: "math_number")
+    }) else {
+      XCTFail("Could not build block")
+      return
+    }
+    BKYAssertDoesNotThrow { try _workspace.addBlockTree(block) }
+    _blockUUID = block.uuid
+
+    _history = WorkspaceHistory(workspace: _workspace)
+    _delegate = TestWorkspaceHistoryDelegate(workspace: _workspace, factory: _blockFactory)
+    _history.delegate = _delegate
+  }
+
+  // MARK: - Recording
+
+  func testRecordGroupsEventsIntoSteps() {
+    changeValue(to: 1, groupID: "a")
+    recordMove(groupID: "a")
+    changeValue(to: 2, groupID: "b")
+
+    XCTAssertEqual(2, _history.undoableStepCount)
+    XCTAssertEqual(3, _history.undoableEvents.count)
+    XCTAssertEqual(0, _history.redoableStepCount)
+  }
+
+  func testRecordMergesConsecutiveEvents() {
+    changeValue(to: 1, groupID: nil)
+    changeValue(to: 2, groupID: nil)
+    changeValue(to: 3, groupID: nil)
+
+    XCTAssertEqual(1, _history.undoableStepCount)
+    XCTAssertEqual(1, _history.undoableEvents.count)
+    XCTAssertEqual("0", (_history.undoableEvents.first as? BlocklyEvent.Change)?.oldValue)
+    XCTAssertEqual("3", (_history.undoableEvents.first as? BlocklyEvent.Change)?.newValue)
+  }
+
+  func testRecordIgnoresOtherWorkspaces() {
+    _history.record(BlocklyEvent.Change(
+      element: BlocklyEvent.Change.elementField, workspaceID: "another workspace",
+      blockID: _blockUUID, fieldName: "NUM", oldValue: "0", newValue: "1"))
+
+    XCTAssertFalse(_history.canUndo)
+  }
+
+  // MARK: - Undo / Redo
+
+  func testUndoRedo() {
+    changeValue(to: 1, groupID: "a")
+    changeValue(to: 2, groupID: "b")
+
+    _history.undo()
+    XCTAssertEqual(1, currentValue())
+    XCTAssertTrue(_history.canRedo)
+
+    _history.undo()
+    XCTAssertEqual(0, currentValue())
+    XCTAssertFalse(_history.canUndo)
+
+    _history.redo()
+    _history.redo()
+    XCTAssertEqual(2, currentValue())
+    XCTAssertFalse(_history.canRedo)
+    XCTAssertEqual(0, _history.checkpointRestoreCount)
+  }
+
+  func testRecordingClearsRedoableSteps() {
+    changeValue(to: 1, groupID: "a")
+    changeValue(to: 2, groupID: "b")
+    _history.undo()
+
+    changeValue(to: 5, groupID: "c")
+
+    XCTAssertFalse(_history.canRedo)
+    XCTAssertEqual(2, _history.undoableStepCount)
+  }
+
+  func testEventsAreNotRecordedWhileApplyingChanges() {
+    changeValue(to: 1, groupID: "a")
+    _delegate.onApplyEvent = { event in
+      self._history.record(event)
+    }
+
+    _history.undo()
+
+    XCTAssertEqual(0, _history.undoableStepCount)
+    XCTAssertEqual(1, _history.redoableStepCount)
+  }
+
+  func testChangesAreAppliedInOneTransaction() {
+    _history.checkpointInterval = 5
+    _history.checkpointRestoreCost = 1
+    recordSteps(count: 12)
+
+    var transactionEvents = [String]()
+    _delegate.onWillApplyChanges = { transactionEvents.append("begin") }
+    _delegate.onApplyEvent = { _ in transactionEvents.append("event") }
+    _delegate.onDidApplyChanges = { transactionEvents.append("commit") }
+
+    // Jumping back restores a checkpoint and replays a step, all inside the same transaction
+    _history.move(toStep: 4)
+
+    XCTAssertEqual(4, currentValue())
+    XCTAssertEqual(1, _history.checkpointRestoreCount)
+    XCTAssertEqual(["begin", "event", "commit"], transactionEvents)
+    XCTAssertFalse(_history.isApplyingChanges)
+
+    // Moving to the current step doesn't open a transaction
+    transactionEvents.removeAll()
+    _history.move(toStep: 4)
+    XCTAssertEqual([], transactionEvents)
+  }
+
+  func testResetWithEvents() {
+    changeValue(to: 1, groupID: "a")
+    recordMove(groupID: "a")
+    changeValue(to: 2, groupID: "b")
+    changeValue(to: 3, groupID: "c")
+    _history.undo()
+
+    _history.reset(
+      undoableEvents: _history.undoableEvents, redoableEvents: _history.redoableEvents)
+
+    XCTAssertEqual(2, _history.undoableStepCount)
+    XCTAssertEqual(3, _history.undoableEvents.count)
+    XCTAssertEqual(1, _history.redoableStepCount)
+    XCTAssertEqual(1, _history.memoryUsage.checkpointCount)
+    XCTAssertEqual(2, currentValue())
+
+    _history.move(toStep: 0)
+    XCTAssertEqual(0, currentValue())
+    _history.move(toStep: 3)
+    XCTAssertEqual(3, currentValue())
+  }
+
+  // MARK: - Checkpoints
+
+  func testMoveToStepJumpsToClosestCheckpoint() {
+    _history.checkpointInterval = 5
+    _history.checkpointRestoreCost = 1
+    recordSteps(count: 20)
+    _delegate.appliedEventCount = 0
+
+    _history.move(toStep: 6)
+
+    XCTAssertEqual(6, currentValue())
+    XCTAssertEqual(1, _history.checkpointRestoreCount)
+    XCTAssertEqual(1, _delegate.appliedEventCount)
+
+    _history.move(toStep: 19)
+
+    XCTAssertEqual(19, currentValue())
+    XCTAssertEqual(2, _history.checkpointRestoreCount)
+  }
+
+  func testMemoryUsage() {
+    let initialUsage = _history.memoryUsage
+    XCTAssertEqual(0, initialUsage.eventCount)
+    XCTAssertEqual(1, initialUsage.checkpointCount)
+    XCTAssertGreaterThan(initialUsage.checkpointByteCount, 0)
+
+    recordSteps(count: 10)
+
+    let usage = _history.memoryUsage
+    XCTAssertEqual(10, usage.eventCount)
+    XCTAssertGreaterThan(usage.eventByteCount, 0)
+    XCTAssertEqual(usage.eventByteCount + usage.checkpointByteCount, usage.totalByteCount)
+  }
+
+  func testEstimatedByteCountOfCreateAndDeleteEvents() {
+    let longText = String(repeating: "a", count: 10_000)
+    let blockBuilder = BlockBuilder(name: "long_text")
+    let inputBuilder = InputBuilder(type: .dummy, name: "")
+    inputBuilder.appendField(FieldInput(name: "TEXT", text: longText))
+    blockBuilder.inputBuilders.append(inputBuilder)
+
+    guard let block = BKYAssertDoesNotThrow({ try blockBuilder.makeBlock() }),
+      let createEvent = BKYAssertDoesNotThrow({
+        try BlocklyEvent.Create(workspace: self._workspace, block: block)
+      }),
+      let deleteEvent = BKYAssertDoesNotThrow({
+        try BlocklyEvent.Delete(workspace: self._workspace, block: block)
+      }) else
+    {
+      XCTFail("Could not create events")
+      return
+    }
+
+    // The estimates account for the field's text, and stay close to the size of the rendered XML
+    let createEstimate = WorkspaceHistory.estimatedByteCount(of: createEvent)
+    XCTAssertGreaterThan(createEstimate, longText.utf8.count)
+    let xmlByteCount = createEvent.xml.utf8.count
+    XCTAssertLessThan(abs(createEstimate - xmlByteCount), xmlByteCount / 10)
+    // Once rendered, the XML itself is counted
+    XCTAssertGreaterThan(WorkspaceHistory.estimatedByteCount(of: createEvent), xmlByteCount)
+
+    let deleteEstimate = WorkspaceHistory.estimatedByteCount(of: deleteEvent)
+    XCTAssertGreaterThan(deleteEstimate, longText.utf8.count)
+    let oldXMLByteCount = deleteEvent.oldXML.utf8.count
+    XCTAssertLessThan(abs(deleteEstimate - oldXMLByteCount), oldXMLByteCount / 10)
+    XCTAssertGreaterThan(WorkspaceHistory.estimatedByteCount(of: deleteEvent), oldXMLByteCount)
+  }
+
+  func testMemoryBudgetCompactsOldSteps() {
+    _history.checkpointInterval = 5
+    recordSteps(count: 20)
+    let usage = _history.memoryUsage
+    XCTAssertEqual(20, usage.eventCount)
+    XCTAssertEqual(5, usage.checkpointCount)
+
+    // Only leave room for the checkpoints and the last 5 steps
+    let lastStepsByteCount = _history.undoableEvents.suffix(5).reduce(0) {
+      $0 + WorkspaceHistory.estimatedByteCount(of: $1)
+    }
+    _history.memoryBudget = usage.checkpointByteCount + lastStepsByteCount
+
+    XCTAssertLessThanOrEqual(_history.memoryUsage.totalByteCount, _history.memoryBudget)
+    XCTAssertEqual(5, _history.memoryUsage.eventCount)
+    // The first 15 steps have been compacted into 3 steps
+    XCTAssertEqual(8, _history.undoableStepCount)
+
+    // Undo back to the start, which needs to restore checkpoints for compacted steps
+    _history.move(toStep: 0)
+    XCTAssertEqual(0, currentValue())
+
+    // Redo everything
+    _history.move(toStep: 8)
+    XCTAssertEqual(20, currentValue())
+
+    // Undo a single compacted step
+    _history.move(toStep: 3)
+    XCTAssertEqual(15, currentValue())
+    _history.undo()
+    XCTAssertEqual(10, currentValue())
+  }
+
+  func testMemoryBudgetDropsOldestSteps() {
+    recordSteps(count: 10)
+
+    // Without intermediate checkpoints, nothing can be compacted so steps have to be dropped
+    _history.memoryBudget = _history.memoryUsage.eventByteCount / 2
+
+    XCTAssertLessThanOrEqual(_history.memoryUsage.totalByteCount, _history.memoryBudget)
+    XCTAssertLessThan(_history.undoableStepCount, 10)
+    XCTAssertGreaterThan(_history.undoableStepCount, 0)
+    XCTAssertEqual(10, currentValue())
+  }
+
+  // MARK: - Helper methods
+
+  func currentValue() -> Double? {
+    return (_workspace.allBlocks[_blockUUID]?.firstField(withName: "NUM") as? FieldNumber)?.value
+  }
+
+  func changeValue(to value: Int, groupID: String?) {
+    guard let field = _workspace.allBlocks[_blockUUID]?.firstField(withName: "NUM")
+      as? FieldNumber else
+    {
+      XCTFail("Could not find field")
+      return
+    }
+    let oldValue = String(Int(field.value))
+    field.value = Double(value)
+
+    let event = BlocklyEvent.Change(
+      element: BlocklyEvent.Change.elementField, workspaceID: _workspace.uuid,
+      blockID: _blockUUID, fieldName: "NUM", oldValue: oldValue, newValue: String(value))
+    event.groupID = groupID
+    _history.record(event)
+  }
+
+  func recordMove(groupID: String?) {
+    let event = BlocklyEvent.Move(
+      workspaceID: _workspace.uuid, blockID: _blockUUID, oldParentID: nil, oldInputName: nil,
+      oldPosition: WorkspacePoint(x: 0, y: 0))
+    event.newPosition = WorkspacePoint(x: 10, y: 10)
+    event.groupID = groupID
+    _history.record(event)
+  }
+
+  /// Records steps that change the value of the block from 1 to `count`, capturing checkpoints
+  /// along the way.
+  func recordSteps(count: Int) {
+    for i in 1 ... count {
+      changeValue(to: i, groupID: "group\(i)")
+      if i % _history.checkpointInterval == 0 {
+        _history.captureCheckpoint()
+      }
+    }
+  }
+}
+
+/** Delegate that applies field changes and checkpoints directly to a workspace. */
+class TestWorkspaceHistoryDelegate: NSObject, WorkspaceHistoryDelegate {
+  let workspace: Workspace
+  let factory: BlockFactory
+  var appliedEventCount = 0
+  var onApplyEvent: ((BlocklyEvent) -> Void)?
+  var onWillApplyChanges: (() -> Void)?
+  var onDidApplyChanges: (() -> Void)?
+
+  init(workspace: Workspace, factory: BlockFactory) {
+    self.workspace = workspace
+    self.factory = factory
+  }
+
+  func workspaceHistory(
+    _ history: WorkspaceHistory, applyEvent event: BlocklyEvent, runForward: Bool)
+  {
+    appliedEventCount += 1
+    onApplyEvent?(event)
+
+    if let changeEvent = event as? BlocklyEvent.Change,
+      let blockID = changeEvent.blockID,
+      let fieldName = changeEvent.fieldName,
+      let field = workspace.allBlocks[blockID]?.firstField(withName: fieldName),
+      let value = runForward ? changeEvent.newValue : changeEvent.oldValue
+    {
+      BKYAssertDoesNotThrow { try field.setValueFromSerializedText(value) }
+    }
+  }
+
+  func workspaceHistory(
+    _ history: WorkspaceHistory, restoreCheckpoint snapshot: Data, runForward: Bool)
+  {
+    BKYAssertDoesNotThrow { () -> Void in
+      try workspace.removeBlockTrees(workspace.topLevelBlocks())
+      try workspace.load(snapshot: snapshot, factory: factory)
+    }
+  }
+
+  func workspaceHistoryWillApplyChanges(_ history: WorkspaceHistory) {
+    onWillApplyChanges?()
+  }
+
+  func workspaceHistoryDidApplyChanges(_ history: WorkspaceHistory) {
+    onDidApplyChanges?()
+  }
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+@testable import Blockly
+import XCTest
+
+class BoundingRectTextMeasurerTest: XCTestCase {
+
+  var _originalMeasurer: TextMeasurer!
+
+  // MARK: - Setup
+
+  override func setUp() {
+    super.setUp()
+    _originalMeasurer = TextMeasurement.measurer
+  }
+
+  override func tearDown() {
+    TextMeasurement.measurer = _originalMeasurer
+    super.tearDown()
+  }
+
+  // MARK: - TextMeasurement
+
+  func testStringHelperUsesConfiguredMeasurer() {
+    TextMeasurement.measurer =
+      FixedMetricsTextMeasurer(characterWidthRatio: 1, lineHeightRatio: 2)
+    let font = UIFont.systemFont(ofSize: 8)
+
+    XCTAssertEqual(CGSize(width: 24, height: 16), "abc".bky_singleLineSize(forFont: font))
+    XCTAssertEqual(
+      CGSize(width: 16, height: 32),
+      "abc".bky_multiLineSize(forFont: font, constrainedToWidth: 16))
+  }
+
+  func testBoundingRectMeasurerMatchesBoundingRect() {
+    let measurer = BoundingRectTextMeasurer()
+    let font = UIFont.systemFont(ofSize: 14)
+    let text = "Blockly"
+    let boundingBox = text.boundingRect(
+      with: CGSize(width: CGFloat(MAXFLOAT), height: CGFloat(MAXFLOAT)),
+      options: NSStringDrawingOptions.usesLineFragmentOrigin,
+      attributes: [NSAttributedStringKey.font: font],
+      context: nil)
+
+    XCTAssertEqual(
+      CGSize(width: ceil(boundingBox.width), height: ceil(boundingBox.height)),
+      measurer.singleLineSize(of: text, font: font))
+  }
+
+  func testMeasurementFontDescribesUIFont() {
+    let font = UIFont.boldSystemFont(ofSize: 12)
+    let measurementFont = TextMeasurementFont(font: font)
+
+    XCTAssertEqual(font.fontName, measurementFont.name)
+    XCTAssertEqual(12, measurementFont.pointSize)
+    XCTAssertTrue(measurementFont.traits.contains(.bold))
+    XCTAssertFalse(measurementFont.traits.contains(.italic))
+    XCTAssertTrue(measurementFont.uiFont() === font)
+
+    // Equality ignores the font it was created from
+    XCTAssertEqual(
+      TextMeasurementFont(name: font.fontName, pointSize: 12, traits: [.bold]), measurementFont)
+    XCTAssertNotEqual(TextMeasurementFont(name: font.fontName, pointSize: 12), measurementFont)
+  }
+
+  func testMeasurementFontDescriptionsAreCachedPerUIFont() {
+    let font = UIFont.italicSystemFont(ofSize: 11)
+    let description = TextMeasurementFont.cachedDescription(of: font)
+
+    XCTAssertTrue(description === TextMeasurementFont.cachedDescription(of: font))
+    XCTAssertEqual(TextMeasurementFont(font: font), description)
+    XCTAssertFalse(
+      description === TextMeasurementFont.cachedDescription(of: UIFont.systemFont(ofSize: 11)))
+  }
+
+  func testMeasurementFontResolvesUIFontByName() {
+    let font = TextMeasurementFont(name: "Courier", pointSize: 9)
+    XCTAssertEqual("Courier", font.uiFont().familyName)
+    XCTAssertEqual(9, font.uiFont().pointSize)
+
+    // Unknown fonts fall back to the system font, with the same traits
+    let unknownFont = TextMeasurementFont(name: "NotAFont", pointSize: 9, traits: [.italic])
+    XCTAssertEqual(9, unknownFont.uiFont().pointSize)
+    XCTAssertTrue(unknownFont.uiFont().fontDescriptor.symbolicTraits.contains(.traitItalic))
+  }
+
+  // MARK: - CachingTextMeasurer
+
+  func testCachingMeasurerRemovesMeasurementsWhenFontsChange() {
+    let countingMeasurer = CountingTextMeasurer()
+    let measurer = CachingTextMeasurer(measurer: countingMeasurer)
+    TextMeasurement.measurer = measurer
+    let font = UIFont.systemFont(ofSize: 10)
+
+    _ = "repeat".bky_singleLineSize(forFont: font)
+    XCTAssertEqual(1, measurer.cachedMeasurementCount)
+
+    // Replacing a font in a layout config clears the cache
+    let config = LayoutConfig()
+    config.setFontCreator(
+      { UIFont.italicSystemFont(ofSize: 10 * $0) }, for: LayoutConfig.GlobalFont)
+    XCTAssertEqual(0, measurer.cachedMeasurementCount)
+
+    _ = "repeat".bky_singleLineSize(forFont: font)
+    XCTAssertEqual(1, measurer.cachedMeasurementCount)
+
+    // Changing the content size category clears the cache
+    NotificationCenter.default.post(name: .UIContentSizeCategoryDidChange, object: nil)
+    XCTAssertEqual(0, measurer.cachedMeasurementCount)
+    XCTAssertEqual(2, countingMeasurer.measurementCount)
+  }
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+@testable import Blockly
+import XCTest
+
+/** Tests for the `CodeGenerationCache` class. */
+class CodeGenerationCacheTest: XCTestCase {
+
+  var _blockFactory: BlockFactory!
+  var _workspace: Workspace!
+  var _generator: NativeCodeGenerator!
+  var _cache: CodeGenerationCache!
+  /// The number of blocks that the generator has generated code for
+  var _generatedBlockCount = 0
+
+  override func setUp() {
+    super.setUp()
+
+    _blockFactory = BlockFactory()
+    _blockFactory.load(fromDefaultFiles: [.loopDefault, .mathDefault])
+    _workspace = Workspace()
+
+    _generator = NativeCodeGenerator(name: "Python")
+    _generator.setGenerator(forBlockType: "math_number") { block, generator in
+      self._generatedBlockCount += 1
+      let value = (block.firstField(withName: "NUM") as? FieldNumber)?.value ?? 0
+      return .value(String(Int(value)), order: generator.atomicOrder)
+    }
+    _generator.setGenerator(forBlockType: "controls_repeat_ext") { block, generator in
+      self._generatedBlockCount += 1
+      let times = try generator.valueCode(
+        for: block, inputName: "TIMES", outerOrder: generator.noneOrder)
+      var branch = try generator.statementCode(for: block, inputName: "DO")
+      if branch.isEmpty {
+        branch = generator.indent + "pass\n"
+      }
+      return .statement("for count in range(\(times)):\n" + branch)
+    }
+
+    _cache = CodeGenerationCache(workspace: _workspace, generator: _generator)
+  }
+
+  override func tearDown() {
+    EventManager.shared.firePendingEvents()
+    _cache = nil
+    super.tearDown()
+  }
+
+  // MARK: - Tests
+
+  func testCodeIsCachedPerTopLevelBlockTree() {
+    guard addLoop(times: 1, y: 0) != nil, addLoop(times: 2, y: 100) != nil else {
+      return
+    }
+
+    let expectedCode =
+      "for count in range(1):\n  pass\n" +
+      "for count in range(2):\n  pass\n"
+    XCTAssertEqual(expectedCode, BKYAssertDoesNotThrow { try _cache.code() })
+    XCTAssertEqual(0, _cache.statistics.hitCount)
+    XCTAssertEqual(2, _cache.statistics.missCount)
+    XCTAssertEqual(2, _cache.cachedBlockTreeCount)
+    XCTAssertEqual(4, _generatedBlockCount)
+
+    // Nothing changed, so everything should come from the cache
+    XCTAssertEqual(expectedCode, BKYAssertDoesNotThrow { try _cache.code() })
+    XCTAssertEqual(2, _cache.statistics.hitCount)
+    XCTAssertEqual(2, _cache.statistics.missCount)
+    XCTAssertEqual(4, _generatedBlockCount)
+    XCTAssertEqual(0.5, _cache.statistics.hitRatio)
+  }
+
+  func testChangeEventOnlyRegeneratesAffectedTree() {
+    guard
+      addLoop(times: 1, y: 0) != nil,
+      let loop2 = addLoop(times: 2, y: 100),
+      let number = loop2.firstInput(withName: "TIMES")?.connectedBlock,
+      let field = number.firstField(withName: "NUM") as? FieldNumber else
+    {
+      XCTFail("Could not build blocks")
+      return
+    }
+    _ = BKYAssertDoesNotThrow { try _cache.code() }
+    _generatedBlockCount = 0
+
+    field.value = 5
+    fireEvent(BlocklyEvent.Change.fieldValueEvent(
+      workspace: _workspace, block: number, field: field, oldValue: "2", newValue: "5"))
+
+    XCTAssertEqual(
+      "for count in range(1):\n  pass\nfor count in range(5):\n  pass\n",
+      BKYAssertDoesNotThrow { try _cache.code() })
+    XCTAssertEqual(1, _cache.statistics.invalidationCount)
+    XCTAssertEqual(1, _cache.statistics.hitCount)
+    XCTAssertEqual(3, _cache.statistics.missCount)
+    XCTAssertEqual(2, _generatedBlockCount)
+  }
+
+  func testRepositioningTreeOnlyReordersCode() {
+    guard let loop1 = addLoop(times: 1, y: 0), addLoop(times: 2, y: 100) != nil else {
+      return
+    }
+    _ = BKYAssertDoesNotThrow { try _cache.code() }
+
+    BlocklyEvent.Move.captureMoveEvent(workspace: _workspace, block: loop1) {
+      loop1.position = WorkspacePoint(x: 0, y: 200)
+    }
+    EventManager.shared.firePendingEvents()
+
+    XCTAssertEqual(
+      "for count in range(2):\n  pass\nfor count in range(1):\n  pass\n",
+      BKYAssertDoesNotThrow { try _cache.code() })
+    XCTAssertEqual(0, _cache.statistics.invalidationCount)
+    XCTAssertEqual(2, _cache.statistics.hitCount)
+  }
+
+  func testConnectingTreesInvalidatesBothTrees() {
+    guard
+      let loop1 = addLoop(times: 1, y: 0),
+      let loop2 = addLoop(times: 2, y: 100),
+      addLoop(times: 3, y: 200) != nil else
+    {
+      return
+    }
+    _ = BKYAssertDoesNotThrow { try _cache.code() }
+
+    BKYAssertDoesNotThrow {
+      try BlocklyEvent.Move.captureMoveEvent(workspace: _workspace, block: loop2) {
+        try loop1.firstInput(withName: "DO")?.connection?.connectTo(loop2.previousConnection)
+      }
+    }
+    EventManager.shared.firePendingEvents()
+
+    XCTAssertEqual(
+      "for count in range(1):\n  for count in range(2):\n    pass\n" +
+      "for count in range(3):\n  pass\n",
+      BKYAssertDoesNotThrow { try _cache.code() })
+    XCTAssertEqual(2, _cache.statistics.invalidationCount)
+    XCTAssertEqual(2, _cache.cachedBlockTreeCount)
+    XCTAssertEqual(1, _cache.statistics.hitCount)
+
+    // Disconnect it again
+    BlocklyEvent.Move.captureMoveEvent(workspace: _workspace, block: loop2) {
+      loop2.previousConnection?.disconnect()
+    }
+    EventManager.shared.firePendingEvents()
+
+    XCTAssertEqual(
+      "for count in range(1):\n  pass\n" +
+      "for count in range(2):\n  pass\n" +
+      "for count in range(3):\n  pass\n",
+      BKYAssertDoesNotThrow { try _cache.code() })
+    XCTAssertEqual(3, _cache.cachedBlockTreeCount)
+  }
+
+  func testDeleteEventDropsTree() {
+    guard addLoop(times: 1, y: 0) != nil, let loop2 = addLoop(times: 2, y: 100) else {
+      return
+    }
+    _ = BKYAssertDoesNotThrow { try _cache.code() }
+
+    if let event = BKYAssertDoesNotThrow({
+      try BlocklyEvent.Delete(workspace: self._workspace, block: loop2)
+    }) {
+      BKYAssertDoesNotThrow { try _workspace.removeBlockTree(loop2) }
+      fireEvent(event)
+    }
+
+    XCTAssertEqual(1, _cache.cachedBlockTreeCount)
+    XCTAssertEqual("for count in range(1):\n  pass\n", BKYAssertDoesNotThrow { try _cache.code() })
+  }
+
+  func testEventsFromOtherWorkspacesAreIgnored() {
+    guard let loop = addLoop(times: 1, y: 0) else {
+      return
+    }
+    _ = BKYAssertDoesNotThrow { try _cache.code() }
+
+    fireEvent(BlocklyEvent.Change(
+      element: BlocklyEvent.Change.elementField, workspaceID: "another workspace",
+      blockID: loop.uuid))
+    XCTAssertEqual(0, _cache.statistics.invalidationCount)
+    XCTAssertEqual(1, _cache.cachedBlockTreeCount)
+  }
+
+  // MARK: - Helper methods
+
+  func addLoop(times: Int, y: CGFloat) -> Block? {
+    guard
+      let loop = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: "controls_repeat_ext")
+      }),
+      let number = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: "math_number")
+      }),
+      let field = number.firstField(withName: "NUM") as? FieldNumber else
+    {
+      XCTFail("Could not build blocks")
+      return nil
+    }
+    field.value = Double(times)
+    loop.position = WorkspacePoint(x: 0, y: y)
+
+    BKYAssertDoesNotThrow { () -> Void in
+      try loop.firstInput(withName: "TIMES")?.connection?.connectTo(number.outputConnection)
+      try _workspace.addBlockTree(loop)
+    }
+    return loop
+  }
+
+  func fireEvent(_ event: BlocklyEvent) {
+    EventManager.shared.addPendingEvent(event)
+    EventManager.shared.firePendingEvents()
+  }
+}
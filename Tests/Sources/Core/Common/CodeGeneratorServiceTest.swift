@@ -289,4 +289,229 @@ class CodeGeneratorServiceTest: XCTestCase {
       }
     })
   }
+
+  func testParallelCodeGenerationForMultipleLanguages() {
+    _blockFactory.load(fromDefaultFiles: [.mathDefault])
+
+    let workspace = Workspace()
+    guard let numberBlock = BKYAssertDoesNotThrow({
+      try self._blockFactory.makeBlock(name: "math_number")
+    }) else {
+      XCTFail("Could not build block")
+      return
+    }
+    BKYAssertDoesNotThrow { try workspace.addBlockTree(numberBlock) }
+
+    let testBundle = Bundle(for: type(of: self))
+    let pythonBuilder = CodeGeneratorServiceRequestBuilder(jsGeneratorObject: "Blockly.Python")
+    pythonBuilder.addJSBlockGeneratorFiles(["blockly_web/python_compressed.js"], bundle: testBundle)
+    pythonBuilder.addJSONBlockDefinitionFiles(fromDefaultFiles: .allDefault)
+    let jsBuilder = CodeGeneratorServiceRequestBuilder(jsGeneratorObject: "Blockly.JavaScript")
+    jsBuilder.addJSBlockGeneratorFiles(["blockly_web/javascript_compressed.js"], bundle: testBundle)
+    jsBuilder.addJSONBlockDefinitionFiles(fromDefaultFiles: .allDefault)
+
+    var finishedUUIDs = [String]()
+    _codeGeneratorService.onRequestFinished = { uuid, queueTime, totalTime in
+      XCTAssertGreaterThanOrEqual(totalTime, queueTime)
+      finishedUUIDs.append(uuid)
+    }
+
+    var requestUUIDs = [String]()
+    for _ in 0 ..< 3 {
+      for builder in [pythonBuilder, jsBuilder] {
+        let expectation = self.expectation(description: "Code Generation")
+        let uuid = BKYAssertDoesNotThrow {
+          try _codeGeneratorService.generateCode(
+            forWorkspace: workspace,
+            requestBuilder: builder,
+            onCompletion: { _, code in
+              XCTAssertTrue(code.contains("0"))
+              expectation.fulfill()
+            }, onError: { _, error in
+              XCTFail("Error occurred during code generation: \(error)")
+              expectation.fulfill()
+            })
+        }
+        if let uuid = uuid {
+          requestUUIDs.append(uuid)
+        }
+      }
+    }
+    XCTAssertGreaterThan(_codeGeneratorService.queueDepth, 0)
+
+    // Wait 60s for code generation to finish
+    waitForExpectations(timeout: 60.0, handler: { error in
+      if let error = error {
+        XCTFail("Code generation timed out: \(error)")
+      }
+    })
+
+    // Each language should have loaded exactly one code generator
+    let statistics = _codeGeneratorService.statistics
+    XCTAssertEqual(2, statistics.codeGeneratorLoadCount)
+    XCTAssertEqual(6, statistics.finishedRequestCount)
+    XCTAssertGreaterThanOrEqual(statistics.coalescedRequestCount, 2)
+    XCTAssertGreaterThan(statistics.maximumQueueDepth, 1)
+    XCTAssertGreaterThan(statistics.averageRequestLatency, 0)
+    XCTAssertEqual(Set(requestUUIDs), Set(finishedUUIDs))
+  }
+
+  func testCoalescingRequestsByWorkspace() {
+    _blockFactory.load(fromDefaultFiles: [.loopDefault, .mathDefault])
+
+    // Build workspace with simple repeat loop
+    let workspace = Workspace()
+    guard
+      let loopBlock = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: "controls_repeat_ext")
+      }),
+      let loopValueBlock = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: "math_number")
+      }),
+      let parentInput = loopBlock.firstInput(withName: "TIMES"),
+      let fieldNumber = loopValueBlock.firstField(withName: "NUM") as? FieldNumber else
+    {
+      XCTFail("Could not build blocks")
+      return
+    }
+    BKYAssertDoesNotThrow { () -> Void in
+      try parentInput.connection?.connectTo(loopValueBlock.inferiorConnection)
+      try workspace.addBlockTree(loopBlock)
+    }
+
+    let testBundle = Bundle(for: type(of: self))
+    let builder = CodeGeneratorServiceRequestBuilder(jsGeneratorObject: "Blockly.Python")
+    builder.addJSBlockGeneratorFiles(["blockly_web/python_compressed.js"], bundle: testBundle)
+    builder.addJSONBlockDefinitionFiles(fromDefaultFiles: .allDefault)
+    _codeGeneratorService.setRequestBuilder(builder, shouldCache: false)
+    _codeGeneratorService.coalescesRequestsByWorkspace = true
+
+    // Simulate a burst of edits, requesting code after each one
+    let expectation = self.expectation(description: "Code Generation")
+    let editCount = 5
+    for i in 1 ... editCount {
+      fieldNumber.value = Double(i)
+      let isLastEdit = (i == editCount)
+
+      let _ = BKYAssertDoesNotThrow {
+        try _codeGeneratorService.generateCode(
+          forWorkspace: workspace,
+          onCompletion: { _, code in
+            XCTAssertTrue(isLastEdit, "A superseded request completed")
+            XCTAssertEqual("for count in range(\(editCount)):  pass",
+                           code.replacingOccurrences(of: "\n", with: ""))
+            expectation.fulfill()
+          }, onError: { _, error in
+            XCTFail("Error occurred during code generation: \(error)")
+            expectation.fulfill()
+          })
+      }
+    }
+
+    // Wait 30s for code generation to finish
+    waitForExpectations(timeout: 30.0, handler: { error in
+      if let error = error {
+        XCTFail("Code generation timed out: \(error)")
+      }
+    })
+
+    XCTAssertEqual(editCount - 1, _codeGeneratorService.statistics.supersededRequestCount)
+  }
+
+  func testSupersededRequestDoesNotBreakOrdering() {
+    _blockFactory.load(fromDefaultFiles: [.mathDefault])
+
+    let workspace1 = Workspace()
+    let workspace2 = Workspace()
+    guard
+      let numberBlock1 = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: "math_number")
+      }),
+      let numberBlock2 = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: "math_number")
+      }) else
+    {
+      XCTFail("Could not build blocks")
+      return
+    }
+    BKYAssertDoesNotThrow { () -> Void in
+      try workspace1.addBlockTree(numberBlock1)
+      try workspace2.addBlockTree(numberBlock2)
+    }
+
+    let testBundle = Bundle(for: type(of: self))
+    let builder = CodeGeneratorServiceRequestBuilder(jsGeneratorObject: "Blockly.Python")
+    builder.addJSBlockGeneratorFiles(["blockly_web/python_compressed.js"], bundle: testBundle)
+    builder.addJSONBlockDefinitionFiles(fromDefaultFiles: .allDefault)
+    _codeGeneratorService.setRequestBuilder(builder, shouldCache: false)
+    _codeGeneratorService.coalescesRequestsByWorkspace = true
+
+    var requestAFinishedTime: Date?
+    var requestCEnqueueTime: Date?
+    var requestCUUID: String?
+    var requestCQueueTime: TimeInterval?
+    _codeGeneratorService.onRequestFinished = { uuid, queueTime, _ in
+      if uuid == requestCUUID {
+        requestCQueueTime = queueTime
+      }
+    }
+
+    // Request A, and let it start loading its code generator
+    let expectationA = self.expectation(description: "Code Generation A")
+    let _ = BKYAssertDoesNotThrow {
+      try _codeGeneratorService.generateCode(
+        forWorkspace: workspace1,
+        onCompletion: { _, _ in
+          requestAFinishedTime = Date()
+          expectationA.fulfill()
+        }, onError: { _, error in
+          XCTFail("Error occurred during code generation: \(error)")
+          expectationA.fulfill()
+        })
+    }
+    RunLoop.current.run(until: Date(timeIntervalSinceNow: 0.1))
+
+    // Queue request B behind A, and then supersede it with request C
+    let _ = BKYAssertDoesNotThrow {
+      try _codeGeneratorService.generateCode(
+        forWorkspace: workspace2,
+        onCompletion: { _, _ in
+          XCTFail("A superseded request completed")
+        }, onError: { _, error in
+          XCTFail("Error occurred during code generation: \(error)")
+        })
+    }
+    let expectationC = self.expectation(description: "Code Generation C")
+    requestCEnqueueTime = Date()
+    requestCUUID = BKYAssertDoesNotThrow {
+      try _codeGeneratorService.generateCode(
+        forWorkspace: workspace2,
+        onCompletion: { _, _ in
+          expectationC.fulfill()
+        }, onError: { _, error in
+          XCTFail("Error occurred during code generation: \(error)")
+          expectationC.fulfill()
+        })
+    }
+
+    // Wait 30s for code generation to finish
+    waitForExpectations(timeout: 30.0, handler: { error in
+      if let error = error {
+        XCTFail("Code generation timed out: \(error)")
+      }
+    })
+
+    guard let aFinishedTime = requestAFinishedTime,
+      let cEnqueueTime = requestCEnqueueTime,
+      let cQueueTime = requestCQueueTime else
+    {
+      XCTFail("Requests did not finish")
+      return
+    }
+
+    // C must not have started until A finished, and both must have shared one code generator
+    XCTAssertGreaterThanOrEqual(cEnqueueTime.addingTimeInterval(cQueueTime), aFinishedTime)
+    XCTAssertEqual(1, _codeGeneratorService.statistics.codeGeneratorLoadCount)
+    XCTAssertEqual(1, _codeGeneratorService.statistics.supersededRequestCount)
+  }
 }
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if SWIFT_PACKAGE
+@testable import BlocklyCore
+#else
+@testable import Blockly
+#endif
+import XCTest
+
+class ColorComponentsTest: XCTestCase {
+
+  // MARK: - init(rgb:)
+
+  func testInitFromRGB_valid() {
+    assertComponents(ColorComponents(rgb: "#FF8000"), red: 0xFF, green: 0x80, blue: 0x00)
+    assertComponents(ColorComponents(rgb: "ABCDEF"), red: 0xAB, green: 0xCD, blue: 0xEF)
+    assertComponents(ColorComponents(rgb: "abcdef"), red: 0xAB, green: 0xCD, blue: 0xEF)
+    assertComponents(ColorComponents(rgb: "000000"), red: 0x00, green: 0x00, blue: 0x00)
+  }
+
+  func testInitFromRGB_invalid() {
+    XCTAssertNil(ColorComponents(rgb: "GGGGGG"))
+    XCTAssertNil(ColorComponents(rgb: "00000AB"))
+    XCTAssertNil(ColorComponents(rgb: "0000A"))
+    XCTAssertNil(ColorComponents(rgb: "##000000"))
+    XCTAssertNil(ColorComponents(rgb: "+12345"))
+  }
+
+  // MARK: - init(hue:saturation:brightness:)
+
+  func testInitFromHue() {
+    XCTAssertEqual(
+      ColorComponents(red: 1, green: 0, blue: 0),
+      ColorComponents(hue: 0, saturation: 1, brightness: 1))
+    XCTAssertEqual(
+      ColorComponents(red: 0, green: 1, blue: 0),
+      ColorComponents(hue: 120, saturation: 1, brightness: 1))
+    XCTAssertEqual(
+      ColorComponents(red: 0, green: 0, blue: 1),
+      ColorComponents(hue: 240, saturation: 1, brightness: 1))
+    XCTAssertEqual(
+      ColorComponents(hue: 0, saturation: 1, brightness: 1),
+      ColorComponents(hue: 360, saturation: 1, brightness: 1))
+
+    // No saturation is a shade of grey
+    let grey = ColorComponents(hue: 200, saturation: 0, brightness: 0.5)
+    XCTAssertEqual(0.5, grey.red, accuracy: TestConstants.ACCURACY_CGF)
+    XCTAssertEqual(0.5, grey.green, accuracy: TestConstants.ACCURACY_CGF)
+    XCTAssertEqual(0.5, grey.blue, accuracy: TestConstants.ACCURACY_CGF)
+  }
+
+  func testInitClampsValues() {
+    let components = ColorComponents(red: -1, green: 0.5, blue: 2)
+    XCTAssertEqual(0, components.red)
+    XCTAssertEqual(0.5, components.green)
+    XCTAssertEqual(1, components.blue)
+  }
+
+  // MARK: - Helper
+
+  func assertComponents(_ components: ColorComponents?, red: Int, green: Int, blue: Int) {
+    guard let components = components else {
+      XCTFail("Components could not be parsed")
+      return
+    }
+    XCTAssertEqual(CGFloat(red) / 255.0, components.red, accuracy: TestConstants.ACCURACY_CGF)
+    XCTAssertEqual(CGFloat(green) / 255.0, components.green, accuracy: TestConstants.ACCURACY_CGF)
+    XCTAssertEqual(CGFloat(blue) / 255.0, components.blue, accuracy: TestConstants.ACCURACY_CGF)
+  }
+}
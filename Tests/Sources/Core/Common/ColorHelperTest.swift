@@ -41,8 +41,30 @@ class ColorHelperTest: XCTestCase {
     XCTAssertNil(ColorHelper.makeColor(rgb: "##000000"))
   }
 
+  // MARK: - ColorComponents
+
+  func testColorFromHueMatchesColorComponents() {
+    for hue in stride(from: CGFloat(0), through: 360, by: 15) {
+      let components = ColorComponents(hue: hue, saturation: 0.45, brightness: 0.65)
+      assertValuesForColor(ColorHelper.makeColor(hue: hue),
+        red: components.red, green: components.green, blue: components.blue)
+    }
+  }
+
   // MARK - Helper
 
+  func assertValuesForColor(_ color: UIColor, red: CGFloat, green: CGFloat, blue: CGFloat) {
+    var actualRed:CGFloat = 0
+    var actualGreen:CGFloat = 0
+    var actualBlue:CGFloat = 0
+    var actualAlpha:CGFloat = 0
+
+    color.getRed(&actualRed, green: &actualGreen, blue: &actualBlue, alpha: &actualAlpha)
+    XCTAssertEqual(red, actualRed, accuracy: TestConstants.ACCURACY_CGF)
+    XCTAssertEqual(green, actualGreen, accuracy: TestConstants.ACCURACY_CGF)
+    XCTAssertEqual(blue, actualBlue, accuracy: TestConstants.ACCURACY_CGF)
+  }
+
   func assertValuesForColor(
     _ color: UIColor, red: Int, green: Int, blue: Int, alpha: Float) {
     var actualRed:CGFloat = 0
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if SWIFT_PACKAGE
+@testable import BlocklyCore
+#else
+@testable import Blockly
+#endif
+import XCTest
+
+class LRUCacheTest: XCTestCase {
+
+  // MARK: - Tests
+
+  func testValueForKey() {
+    let cache = LRUCache<String, Int>(capacity: 2)
+    cache.setValue(1, forKey: "a")
+
+    XCTAssertEqual(1, cache.value(forKey: "a"))
+    XCTAssertNil(cache.value(forKey: "b"))
+    XCTAssertEqual(1, cache.hitCount)
+    XCTAssertEqual(1, cache.missCount)
+    XCTAssertEqual(0.5, cache.hitRate)
+  }
+
+  func testSetValueReplacesExistingValue() {
+    let cache = LRUCache<String, Int>(capacity: 2)
+    cache.setValue(1, forKey: "a")
+    cache.setValue(2, forKey: "a")
+
+    XCTAssertEqual(1, cache.count)
+    XCTAssertEqual(2, cache.value(forKey: "a"))
+  }
+
+  func testEvictsLeastRecentlyUsedValue() {
+    let cache = LRUCache<String, Int>(capacity: 2)
+    var evictedKeys = [String]()
+    cache.evictionHandler = { key, _ in evictedKeys.append(key) }
+    cache.setValue(1, forKey: "a")
+    cache.setValue(2, forKey: "b")
+
+    // Use "a", so "b" becomes the least recently used value
+    _ = cache.value(forKey: "a")
+    cache.setValue(3, forKey: "c")
+
+    XCTAssertEqual(2, cache.count)
+    XCTAssertEqual(1, cache.evictionCount)
+    XCTAssertEqual(["b"], evictedKeys)
+    XCTAssertEqual(1, cache.value(forKey: "a"))
+    XCTAssertNil(cache.value(forKey: "b"))
+    XCTAssertEqual(3, cache.value(forKey: "c"))
+  }
+
+  func testLoweringCapacityEvictsValues() {
+    let cache = LRUCache<Int, Int>(capacity: 10)
+    for i in 0 ..< 10 {
+      cache.setValue(i, forKey: i)
+    }
+
+    cache.capacity = 3
+
+    XCTAssertEqual(3, cache.count)
+    XCTAssertEqual(7, cache.evictionCount)
+    for i in 0 ..< 7 {
+      XCTAssertNil(cache.value(forKey: i))
+    }
+    for i in 7 ..< 10 {
+      XCTAssertEqual(i, cache.value(forKey: i))
+    }
+  }
+
+  func testRemoveValue() {
+    let cache = LRUCache<String, Int>(capacity: 3)
+    cache.setValue(1, forKey: "a")
+    cache.setValue(2, forKey: "b")
+    cache.setValue(3, forKey: "c")
+
+    cache.removeValue(forKey: "b")
+    cache.removeValue(forKey: "c")
+    cache.removeValue(forKey: "a")
+
+    XCTAssertEqual(0, cache.count)
+
+    // Make sure the list is still intact after removing the head and tail
+    cache.setValue(4, forKey: "d")
+    cache.setValue(5, forKey: "e")
+    XCTAssertEqual(4, cache.value(forKey: "d"))
+    XCTAssertEqual(5, cache.value(forKey: "e"))
+  }
+
+  func testRemoveAllValues() {
+    let cache = LRUCache<String, Int>(capacity: 3)
+    cache.setValue(1, forKey: "a")
+    cache.setValue(2, forKey: "b")
+    _ = cache.value(forKey: "a")
+
+    cache.removeAllValues()
+
+    XCTAssertEqual(0, cache.count)
+    XCTAssertNil(cache.value(forKey: "a"))
+    XCTAssertEqual(1, cache.hitCount)
+
+    cache.resetStatistics()
+    XCTAssertEqual(0, cache.hitCount)
+    XCTAssertEqual(0, cache.missCount)
+    XCTAssertEqual(0, cache.evictionCount)
+  }
+}
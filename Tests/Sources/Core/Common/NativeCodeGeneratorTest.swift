@@ -0,0 +1,385 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import Foundation
+@testable import Blockly
+import XCTest
+
+/** Tests for the `NativeCodeGenerator` class. */
+class NativeCodeGeneratorTest: XCTestCase {
+
+  // Subset of Python operator precedences used by web Blockly
+  static let ORDER_ATOMIC = 0
+  static let ORDER_EXPONENTIATION = 3
+  static let ORDER_MULTIPLICATIVE = 5
+  static let ORDER_ADDITIVE = 6
+  static let ORDER_NONE = 99
+
+  var _blockFactory: BlockFactory!
+  var _generator: NativeCodeGenerator!
+
+  override func setUp() {
+    super.setUp()
+
+    _blockFactory = BlockFactory()
+    _blockFactory.load(fromDefaultFiles: [.loopDefault, .mathDefault])
+    _generator = makePythonGenerator()
+  }
+
+  // MARK: - Tests
+
+  func testRepeatLoop() {
+    guard let loop = makeLoopBlock(times: 10) else {
+      return
+    }
+
+    let code = BKYAssertDoesNotThrow { try _generator.code(forTopLevelBlock: loop) }
+    XCTAssertEqual("for count in range(10):\n  pass\n", code)
+  }
+
+  func testNestedStatementsAreIndented() {
+    guard
+      let outerLoop = makeLoopBlock(times: 2),
+      let innerLoop = makeLoopBlock(times: 3),
+      let nextLoop = makeLoopBlock(times: 4) else
+    {
+      return
+    }
+    BKYAssertDoesNotThrow { () -> Void in
+      try outerLoop.firstInput(withName: "DO")?.connection?.connectTo(
+        innerLoop.previousConnection)
+      try innerLoop.nextConnection?.connectTo(nextLoop.previousConnection)
+    }
+
+    let code = BKYAssertDoesNotThrow { try _generator.code(forTopLevelBlock: outerLoop) }
+    XCTAssertEqual(
+      "for count in range(2):\n" +
+      "  for count in range(3):\n" +
+      "    pass\n" +
+      "  for count in range(4):\n" +
+      "    pass\n",
+      code)
+  }
+
+  func testOperatorPrecedence() {
+    guard
+      let product = makeArithmeticBlock(op: "MULTIPLY", a: nil, b: 3),
+      let sum = makeArithmeticBlock(op: "ADD", a: 1, b: 2) else
+    {
+      return
+    }
+
+    // (1 + 2) * 3
+    BKYAssertDoesNotThrow {
+      try product.firstInput(withName: "A")?.connection?.connectTo(sum.outputConnection)
+    }
+    XCTAssertEqual("(1 + 2) * 3\n",
+      BKYAssertDoesNotThrow { try _generator.code(forTopLevelBlock: product) })
+
+    // 1 + 2 * 3
+    guard
+      let sum2 = makeArithmeticBlock(op: "ADD", a: 1, b: nil),
+      let product2 = makeArithmeticBlock(op: "MULTIPLY", a: 2, b: 3) else
+    {
+      return
+    }
+    BKYAssertDoesNotThrow {
+      try sum2.firstInput(withName: "B")?.connection?.connectTo(product2.outputConnection)
+    }
+    XCTAssertEqual("1 + 2 * 3\n",
+      BKYAssertDoesNotThrow { try _generator.code(forTopLevelBlock: sum2) })
+  }
+
+  func testParenthesize() {
+    XCTAssertEqual("a + b", _generator.parenthesize("a + b", innerOrder: 6, outerOrder: 99))
+    XCTAssertEqual("(a + b)", _generator.parenthesize("a + b", innerOrder: 6, outerOrder: 5))
+    XCTAssertEqual("(a + b)", _generator.parenthesize("a + b", innerOrder: 6, outerOrder: 6))
+    XCTAssertEqual("a", _generator.parenthesize("a", innerOrder: 0, outerOrder: 0))
+    XCTAssertEqual("a", _generator.parenthesize("a", innerOrder: 99, outerOrder: 99))
+    XCTAssertEqual("", _generator.parenthesize("", innerOrder: 99, outerOrder: 0))
+  }
+
+  func testPrefixLines() {
+    XCTAssertEqual("  a\n\n  b\n", _generator.prefixLines("a\n\nb\n", with: "  "))
+    XCTAssertEqual("", _generator.prefixLines("", with: "  "))
+  }
+
+  func testDisabledBlocksAreSkipped() {
+    guard
+      let loop1 = makeLoopBlock(times: 1),
+      let loop2 = makeLoopBlock(times: 2),
+      let loop3 = makeLoopBlock(times: 3) else
+    {
+      return
+    }
+    BKYAssertDoesNotThrow { () -> Void in
+      try loop1.nextConnection?.connectTo(loop2.previousConnection)
+      try loop2.nextConnection?.connectTo(loop3.previousConnection)
+    }
+    loop2.disabled = true
+
+    let code = BKYAssertDoesNotThrow { try _generator.code(forTopLevelBlock: loop1) }
+    XCTAssertEqual("for count in range(1):\n  pass\nfor count in range(3):\n  pass\n", code)
+  }
+
+  func testDefinitionsArePrependedOnce() {
+    _generator.setGenerator(forBlockType: "math_number") { block, generator in
+      generator.addDefinition("import math", forName: "import_math")
+      return .value("math.pi", order: NativeCodeGeneratorTest.ORDER_ATOMIC)
+    }
+
+    guard let sum = makeArithmeticBlock(op: "ADD", a: 1, b: 2) else {
+      return
+    }
+    XCTAssertEqual("import math\n\nmath.pi + math.pi\n",
+      BKYAssertDoesNotThrow { try _generator.code(forTopLevelBlock: sum) })
+
+    // Definitions should not leak into the next generation
+    _generator.setGenerator(forBlockType: "math_number") { block, generator in
+      return .value("1", order: NativeCodeGeneratorTest.ORDER_ATOMIC)
+    }
+    XCTAssertEqual("1 + 1\n",
+      BKYAssertDoesNotThrow { try _generator.code(forTopLevelBlock: sum) })
+  }
+
+  func testTopLevelBlocksAreOrderedByPosition() {
+    guard
+      let loop1 = makeLoopBlock(times: 1),
+      let loop2 = makeLoopBlock(times: 2) else
+    {
+      return
+    }
+    loop1.position = WorkspacePoint(x: 0, y: 100)
+    loop2.position = WorkspacePoint(x: 0, y: 0)
+
+    let code = BKYAssertDoesNotThrow {
+      try _generator.code(forTopLevelBlocks: [loop1, loop2])
+    }
+    XCTAssertEqual("for count in range(2):\n  pass\nfor count in range(1):\n  pass\n", code)
+  }
+
+  func testUnknownBlockTypeThrows() {
+    guard let block = BKYAssertDoesNotThrow({
+      try self._blockFactory.makeBlock(name: "math_single")
+    }) else {
+      XCTFail("Could not build block")
+      return
+    }
+
+    BKYAssertThrow(errorType: BlocklyError.self) {
+      _ = try _generator.code(forTopLevelBlock: block)
+    }
+  }
+
+  func testCodeGeneratorServiceWithNativeBackend() {
+    let workspace = Workspace()
+    guard let loop = makeLoopBlock(times: 10) else {
+      return
+    }
+    BKYAssertDoesNotThrow { try workspace.addBlockTree(loop) }
+
+    let service = CodeGeneratorService(jsCoreDependencies: [])
+    let builder = CodeGeneratorServiceRequestBuilder(
+      nativeGenerator: _generator, blockFactory: _blockFactory)
+    service.setRequestBuilder(builder, shouldCache: true)
+
+    let expectation = self.expectation(description: "Code Generation")
+    let _ = BKYAssertDoesNotThrow {
+      try service.generateCode(
+        forWorkspace: workspace,
+        onCompletion: { _, code in
+          XCTAssertTrue(Thread.isMainThread)
+          XCTAssertEqual("for count in range(10):\n  pass\n", code)
+          expectation.fulfill()
+        }, onError: { _, error in
+          XCTFail("Error occurred during code generation: \(error)")
+          expectation.fulfill()
+        })
+    }
+
+    waitForExpectations(timeout: 10.0, handler: { error in
+      if let error = error {
+        XCTFail("Code generation timed out: \(error)")
+      }
+    })
+
+    // No web views should have been loaded
+    XCTAssertEqual(0, service.statistics.codeGeneratorLoadCount)
+  }
+
+  // MARK: - Benchmarks
+
+  func testPerformanceNativeCodeGenerationOnLargeWorkspace() {
+    guard let workspace = makeLargeWorkspace(stackCount: 500) else {
+      return
+    }
+
+    measure {
+      _ = BKYAssertDoesNotThrow { try self._generator.code(for: workspace) }
+    }
+  }
+
+  func testPerformanceJSCodeGenerationOnLargeWorkspace() {
+    guard let workspace = makeLargeWorkspace(stackCount: 500) else {
+      return
+    }
+
+    let testBundle = Bundle(for: type(of: self))
+    let service = CodeGeneratorService(
+      jsCoreDependencies: ["blockly_web/blockly_compressed.js", "blockly_web/msg/js/en.js"],
+      bundle: testBundle)
+    let builder = CodeGeneratorServiceRequestBuilder(jsGeneratorObject: "Blockly.Python")
+    builder.addJSBlockGeneratorFiles(["blockly_web/python_compressed.js"], bundle: testBundle)
+    builder.addJSONBlockDefinitionFiles(fromDefaultFiles: .allDefault)
+    service.setRequestBuilder(builder, shouldCache: true)
+
+    measure {
+      let expectation = self.expectation(description: "Code Generation")
+      let _ = BKYAssertDoesNotThrow {
+        try service.generateCode(
+          forWorkspace: workspace,
+          onCompletion: { _, _ in
+            expectation.fulfill()
+          }, onError: { _, error in
+            XCTFail("Error occurred during code generation: \(error)")
+            expectation.fulfill()
+          })
+      }
+      self.waitForExpectations(timeout: 60.0, handler: nil)
+    }
+  }
+
+  // MARK: - Helper methods
+
+  func makePythonGenerator() -> NativeCodeGenerator {
+    let generator = NativeCodeGenerator(name: "Python")
+    generator.atomicOrder = NativeCodeGeneratorTest.ORDER_ATOMIC
+    generator.noneOrder = NativeCodeGeneratorTest.ORDER_NONE
+
+    generator.setGenerator(forBlockType: "math_number") { block, generator in
+      let value = (block.firstField(withName: "NUM") as? FieldNumber)?.value ?? 0
+      let code = value == value.rounded() ? String(Int(value)) : String(value)
+      return .value(code, order: NativeCodeGeneratorTest.ORDER_ATOMIC)
+    }
+    generator.setGenerator(forBlockType: "math_arithmetic") { block, generator in
+      let operators: [String: (String, Int)] = [
+        "ADD": (" + ", NativeCodeGeneratorTest.ORDER_ADDITIVE),
+        "MINUS": (" - ", NativeCodeGeneratorTest.ORDER_ADDITIVE),
+        "MULTIPLY": (" * ", NativeCodeGeneratorTest.ORDER_MULTIPLICATIVE),
+        "DIVIDE": (" / ", NativeCodeGeneratorTest.ORDER_MULTIPLICATIVE),
+        "POWER": (" ** ", NativeCodeGeneratorTest.ORDER_EXPONENTIATION)
+      ]
+      let op = (block.firstField(withName: "OP") as? FieldDropdown)?.selectedOption?.value ?? ""
+      guard let entry = operators[op] else {
+        throw BlocklyError(.codeGeneration, "Unknown operator: \(op)")
+      }
+      let (symbol, order) = entry
+      let a = try generator.valueCode(for: block, inputName: "A", outerOrder: order)
+      let b = try generator.valueCode(for: block, inputName: "B", outerOrder: order)
+      return .value((a.isEmpty ? "0" : a) + symbol + (b.isEmpty ? "0" : b), order: order)
+    }
+    generator.setGenerator(forBlockType: "controls_repeat_ext") { block, generator in
+      var times = try generator.valueCode(
+        for: block, inputName: "TIMES", outerOrder: NativeCodeGeneratorTest.ORDER_NONE)
+      if times.isEmpty {
+        times = "0"
+      }
+      var branch = try generator.statementCode(for: block, inputName: "DO")
+      if branch.isEmpty {
+        branch = generator.indent + "pass\n"
+      }
+      return .statement("for count in range(\(times)):\n" + branch)
+    }
+
+    return generator
+  }
+
+  func makeNumberBlock(_ value: Double) -> Block? {
+    guard
+      let block = BKYAssertDoesNotThrow({ try self._blockFactory.makeBlock(name: "math_number") }),
+      let field = block.firstField(withName: "NUM") as? FieldNumber else
+    {
+      XCTFail("Could not build number block")
+      return nil
+    }
+    field.value = value
+    return block
+  }
+
+  func makeLoopBlock(times: Double) -> Block? {
+    guard
+      let loop = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: "controls_repeat_ext")
+      }),
+      let number = makeNumberBlock(times) else
+    {
+      XCTFail("Could not build loop block")
+      return nil
+    }
+    BKYAssertDoesNotThrow {
+      try loop.firstInput(withName: "TIMES")?.connection?.connectTo(number.outputConnection)
+    }
+    return loop
+  }
+
+  func makeArithmeticBlock(op: String, a: Double?, b: Double?) -> Block? {
+    guard
+      let block = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: "math_arithmetic")
+      }),
+      let field = block.firstField(withName: "OP") as? FieldDropdown,
+      let index = field.options.index(where: { $0.value == op }) else
+    {
+      XCTFail("Could not build arithmetic block")
+      return nil
+    }
+    field.selectedIndex = index
+
+    for (inputName, value) in [("A", a), ("B", b)] {
+      if let value = value, let number = makeNumberBlock(value) {
+        BKYAssertDoesNotThrow {
+          try block.firstInput(withName: inputName)?.connection?.connectTo(
+            number.outputConnection)
+        }
+      }
+    }
+    return block
+  }
+
+  func makeLargeWorkspace(stackCount: Int) -> Workspace? {
+    let workspace = Workspace()
+
+    for i in 0 ..< stackCount {
+      guard
+        let loop = makeLoopBlock(times: Double(i)),
+        let innerLoop = makeLoopBlock(times: 2),
+        let sum = makeArithmeticBlock(op: "ADD", a: Double(i), b: nil),
+        let product = makeArithmeticBlock(op: "MULTIPLY", a: 2, b: 3) else
+      {
+        return nil
+      }
+      BKYAssertDoesNotThrow { () -> Void in
+        try sum.firstInput(withName: "B")?.connection?.connectTo(product.outputConnection)
+        innerLoop.firstInput(withName: "TIMES")?.connection?.disconnect()
+        try innerLoop.firstInput(withName: "TIMES")?.connection?.connectTo(sum.outputConnection)
+        try loop.firstInput(withName: "DO")?.connection?.connectTo(innerLoop.previousConnection)
+      }
+      loop.position = WorkspacePoint(x: 0, y: CGFloat(i) * 100)
+      BKYAssertDoesNotThrow { try workspace.addBlockTree(loop) }
+    }
+
+    return workspace
+  }
+}
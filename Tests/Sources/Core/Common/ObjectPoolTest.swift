@@ -38,6 +38,91 @@ class ObjectPoolTest: XCTestCase {
     let freshOne = pool.object(forType: CokeCan.self)
     XCTAssertFalse(freshOne.recycled)
   }
+
+  func testFreeListsAreKeyedByType() {
+    let pool = ObjectPool()
+    pool.recycleObject(CokeCan())
+    pool.recycleObject(SodaBottle())
+
+    XCTAssertEqual(1, pool.recycledObjectCount(forType: CokeCan.self))
+    XCTAssertEqual(1, pool.recycledObjectCount(forType: SodaBottle.self))
+
+    XCTAssertTrue(pool.object(forType: SodaBottle.self).recycled)
+    XCTAssertFalse(pool.object(forType: SodaBottle.self).recycled)
+    XCTAssertEqual(1, pool.recycledObjectCount(forType: CokeCan.self))
+  }
+
+  func testCapacityEvictsObjects() {
+    let pool = ObjectPool()
+    pool.setCapacity(2, forType: CokeCan.self)
+
+    for _ in 0 ..< 5 {
+      pool.recycleObject(CokeCan())
+    }
+
+    XCTAssertEqual(2, pool.recycledObjectCount(forType: CokeCan.self))
+    XCTAssertEqual(3, pool.statistics(forType: CokeCan.self).evictionCount)
+
+    // Lowering the capacity discards excess objects
+    pool.setCapacity(1, forType: CokeCan.self)
+    XCTAssertEqual(1, pool.recycledObjectCount(forType: CokeCan.self))
+    XCTAssertEqual(4, pool.statistics(forType: CokeCan.self).evictionCount)
+
+    // Other types still use the default capacity
+    XCTAssertEqual(ObjectPool.DefaultCapacityPerType, pool.capacity(forType: SodaBottle.self))
+    pool.resetCapacity(forType: CokeCan.self)
+    XCTAssertEqual(pool.defaultCapacity, pool.capacity(forType: CokeCan.self))
+  }
+
+  func testPrewarm() {
+    let pool = ObjectPool()
+    pool.recycleObject(CokeCan())
+
+    pool.prewarm(CokeCan.self, count: 4)
+
+    XCTAssertEqual(4, pool.recycledObjectCount(forType: CokeCan.self))
+    XCTAssertEqual(3, pool.statistics(forType: CokeCan.self).prewarmCount)
+
+    // Prewarming never exceeds the capacity of a type
+    pool.setCapacity(6, forType: CokeCan.self)
+    pool.prewarm(CokeCan.self, count: 10)
+    XCTAssertEqual(6, pool.recycledObjectCount(forType: CokeCan.self))
+
+    // Prewarmed objects are handed out before new objects are created
+    for _ in 0 ..< 6 {
+      _ = pool.object(forType: CokeCan.self)
+    }
+    XCTAssertEqual(6, pool.statistics(forType: CokeCan.self).hitCount)
+    XCTAssertEqual(0, pool.statistics(forType: CokeCan.self).missCount)
+  }
+
+  func testStatistics() {
+    let pool = ObjectPool()
+    _ = pool.object(forType: CokeCan.self)
+    pool.recycleObject(CokeCan())
+    _ = pool.object(forType: CokeCan.self)
+    _ = pool.object(forType: SodaBottle.self)
+    pool.recycleObject(SodaBottle())
+
+    let statistics = pool.statistics
+    XCTAssertEqual(1, statistics.hitCount)
+    XCTAssertEqual(2, statistics.missCount)
+    XCTAssertEqual(1, statistics.recycledObjectCount)
+    XCTAssertEqual(1.0 / 3.0, statistics.hitRate, accuracy: 0.0001)
+
+    pool.resetStatistics()
+    XCTAssertEqual(0, pool.statistics.hitCount)
+    XCTAssertEqual(0, pool.statistics.missCount)
+  }
+
+  func testMemoryWarningRemovesRecycledObjects() {
+    let pool = ObjectPool()
+    pool.prewarm(CokeCan.self, count: 3)
+
+    NotificationCenter.default.post(name: .UIApplicationDidReceiveMemoryWarning, object: nil)
+
+    XCTAssertEqual(0, pool.recycledObjectCount(forType: CokeCan.self))
+  }
 }
 
 class CokeCan: NSObject, Recyclable {
@@ -51,3 +136,15 @@ class CokeCan: NSObject, Recyclable {
     recycled = true
   }
 }
+
+class SodaBottle: NSObject, Recyclable {
+  var recycled = false
+
+  required override init() {
+    super.init()
+  }
+
+  func prepareForReuse() {
+    recycled = true
+  }
+}
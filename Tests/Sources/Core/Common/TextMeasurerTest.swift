@@ -0,0 +1,145 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if SWIFT_PACKAGE
+@testable import BlocklyCore
+#else
+@testable import Blockly
+#endif
+import XCTest
+
+class TextMeasurerTest: XCTestCase {
+
+  // MARK: - FixedMetricsTextMeasurer
+
+  func testFixedMetricsSingleLine() {
+    let measurer = FixedMetricsTextMeasurer(characterWidthRatio: 0.5, lineHeightRatio: 1.5)
+    let font = TextMeasurementFont(name: "AnyFont", pointSize: 10)
+
+    XCTAssertEqual(CGSize(width: 25, height: 15), measurer.singleLineSize(of: "Hello", font: font))
+    XCTAssertEqual(CGSize(width: 0, height: 15), measurer.singleLineSize(of: "", font: font))
+    XCTAssertEqual(
+      CGSize(width: 30, height: 30), measurer.singleLineSize(of: "ab\nabcdef", font: font))
+  }
+
+  func testFixedMetricsMultiLineWrapsText() {
+    let measurer = FixedMetricsTextMeasurer(characterWidthRatio: 0.5, lineHeightRatio: 1.5)
+    let font = TextMeasurementFont(name: "AnyFont", pointSize: 10)
+
+    // 4 characters fit per line, so 10 characters should wrap onto 3 lines
+    XCTAssertEqual(
+      CGSize(width: 20, height: 45),
+      measurer.multiLineSize(of: "abcdefghij", font: font, constrainedToWidth: 22))
+    XCTAssertEqual(
+      CGSize(width: 10, height: 15),
+      measurer.multiLineSize(of: "ab", font: font, constrainedToWidth: .greatestFiniteMagnitude))
+  }
+
+  // MARK: - CachingTextMeasurer
+
+  func testCachingMeasurerReusesMeasurements() {
+    let countingMeasurer = CountingTextMeasurer()
+    let measurer = CachingTextMeasurer(measurer: countingMeasurer)
+    let font = TextMeasurementFont(name: "AnyFont", pointSize: 10)
+
+    let size = measurer.singleLineSize(of: "repeat", font: font)
+    XCTAssertEqual(size, measurer.singleLineSize(of: "repeat", font: font))
+    XCTAssertEqual(size, measurer.singleLineSize(of: "repeat", font: font))
+
+    XCTAssertEqual(1, countingMeasurer.measurementCount)
+    XCTAssertEqual(2, measurer.hitCount)
+    XCTAssertEqual(1, measurer.missCount)
+    XCTAssertEqual(2.0 / 3.0, measurer.hitRate, accuracy: 0.0001)
+  }
+
+  func testCachingMeasurerKeysByTextFontAndWidth() {
+    let countingMeasurer = CountingTextMeasurer()
+    let measurer = CachingTextMeasurer(measurer: countingMeasurer)
+    let font = TextMeasurementFont(name: "AnyFont", pointSize: 10)
+    // A scaled font has a different point size
+    let scaledFont = TextMeasurementFont(name: "AnyFont", pointSize: 20)
+    let boldFont = TextMeasurementFont(name: "AnyFont", pointSize: 10, traits: [.bold])
+
+    _ = measurer.singleLineSize(of: "do", font: font)
+    _ = measurer.singleLineSize(of: "if", font: font)
+    _ = measurer.singleLineSize(of: "do", font: scaledFont)
+    _ = measurer.singleLineSize(of: "do", font: boldFont)
+    _ = measurer.multiLineSize(of: "do", font: font, constrainedToWidth: 100)
+    _ = measurer.multiLineSize(of: "do", font: font, constrainedToWidth: 50)
+
+    XCTAssertEqual(6, countingMeasurer.measurementCount)
+    XCTAssertEqual(0, measurer.hitCount)
+
+    // Measuring the same values again shouldn't hit the underlying measurer
+    XCTAssertEqual(
+      CGSize(width: 24, height: 24), measurer.singleLineSize(of: "do", font: scaledFont))
+    XCTAssertEqual(
+      CGSize(width: 12, height: 12),
+      measurer.multiLineSize(of: "do", font: font, constrainedToWidth: 50))
+    XCTAssertEqual(6, countingMeasurer.measurementCount)
+  }
+
+  func testCachingMeasurerEvictsLeastRecentlyUsedMeasurements() {
+    let countingMeasurer = CountingTextMeasurer()
+    let measurer = CachingTextMeasurer(measurer: countingMeasurer, capacity: 2)
+    let font = TextMeasurementFont(name: "AnyFont", pointSize: 10)
+
+    _ = measurer.singleLineSize(of: "a", font: font)
+    _ = measurer.singleLineSize(of: "b", font: font)
+    _ = measurer.singleLineSize(of: "a", font: font)
+    _ = measurer.singleLineSize(of: "c", font: font)
+
+    XCTAssertEqual(2, measurer.cachedMeasurementCount)
+    XCTAssertEqual(1, measurer.evictionCount)
+
+    // "a" should still be cached, but "b" should have been evicted
+    _ = measurer.singleLineSize(of: "a", font: font)
+    XCTAssertEqual(3, countingMeasurer.measurementCount)
+    _ = measurer.singleLineSize(of: "b", font: font)
+    XCTAssertEqual(4, countingMeasurer.measurementCount)
+  }
+
+  // MARK: - TextMeasurementFont
+
+  func testMeasurementFontEquality() {
+    let font = TextMeasurementFont(name: "AnyFont", pointSize: 10, traits: [.bold])
+
+    XCTAssertEqual(TextMeasurementFont(name: "AnyFont", pointSize: 10, traits: [.bold]), font)
+    XCTAssertEqual(
+      TextMeasurementFont(name: "AnyFont", pointSize: 10, traits: [.bold]).hashValue,
+      font.hashValue)
+    XCTAssertNotEqual(TextMeasurementFont(name: "AnyFont", pointSize: 10), font)
+    XCTAssertNotEqual(TextMeasurementFont(name: "AnyFont", pointSize: 12, traits: [.bold]), font)
+    XCTAssertNotEqual(TextMeasurementFont(name: "OtherFont", pointSize: 10, traits: [.bold]), font)
+  }
+}
+
+/** Measurer that counts how many measurements it has performed. */
+class CountingTextMeasurer: TextMeasurer {
+  let measurer = FixedMetricsTextMeasurer(characterWidthRatio: 0.6, lineHeightRatio: 1.2)
+  var measurementCount = 0
+
+  func singleLineSize(of text: String, font: TextMeasurementFont) -> CGSize {
+    measurementCount += 1
+    return measurer.singleLineSize(of: text, font: font)
+  }
+
+  func multiLineSize(
+    of text: String, font: TextMeasurementFont, constrainedToWidth width: CGFloat) -> CGSize
+  {
+    measurementCount += 1
+    return measurer.multiLineSize(of: text, font: font, constrainedToWidth: width)
+  }
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if SWIFT_PACKAGE
+@testable import BlocklyCore
+#else
+@testable import Blockly
+#endif
+import XCTest
+
+class TileIndexTest: XCTestCase {
+
+  var _index: TileIndex<String>!
+
+  // MARK: - Setup
+
+  override func setUp() {
+    super.setUp()
+    _index = TileIndex<String>(tileSize: 100)
+  }
+
+  // MARK: - Tests
+
+  func testElementsIntersectingRect() {
+    _index.update("a", frame: CGRect(x: 10, y: 10, width: 50, height: 50))
+    _index.update("b", frame: CGRect(x: 150, y: 10, width: 50, height: 50))
+    _index.update("c", frame: CGRect(x: -300, y: -300, width: 50, height: 50))
+
+    XCTAssertEqual(3, _index.count)
+    XCTAssertEqual(
+      ["a"], _index.elements(intersecting: CGRect(x: 0, y: 0, width: 100, height: 100)))
+    XCTAssertEqual(
+      ["a", "b"], _index.elements(intersecting: CGRect(x: 0, y: 0, width: 200, height: 100)))
+    XCTAssertEqual(
+      ["c"], _index.elements(intersecting: CGRect(x: -280, y: -280, width: 10, height: 10)))
+    XCTAssertEqual([], _index.elements(intersecting: CGRect(x: 500, y: 500, width: 10, height: 10)))
+  }
+
+  func testElementSpanningSeveralTiles() {
+    _index.update("wide", frame: CGRect(x: 0, y: 0, width: 450, height: 20))
+
+    XCTAssertEqual(
+      ["wide"], _index.elements(intersecting: CGRect(x: 420, y: 10, width: 10, height: 10)))
+    XCTAssertEqual(
+      ["wide"], _index.elements(intersecting: CGRect(x: 0, y: 0, width: 500, height: 500)))
+  }
+
+  func testUpdateMovesElement() {
+    _index.update("a", frame: CGRect(x: 10, y: 10, width: 50, height: 50))
+    _index.update("a", frame: CGRect(x: 1010, y: 1010, width: 50, height: 50))
+
+    XCTAssertEqual(1, _index.count)
+    XCTAssertEqual([], _index.elements(intersecting: CGRect(x: 0, y: 0, width: 100, height: 100)))
+    XCTAssertEqual(
+      ["a"], _index.elements(intersecting: CGRect(x: 1000, y: 1000, width: 100, height: 100)))
+    XCTAssertEqual(CGRect(x: 1010, y: 1010, width: 50, height: 50), _index.frame(of: "a"))
+  }
+
+  func testUpdateWithinSameTileUsesNewFrame() {
+    _index.update("a", frame: CGRect(x: 10, y: 10, width: 10, height: 10))
+    _index.update("a", frame: CGRect(x: 80, y: 80, width: 10, height: 10))
+
+    // The query overlaps the same tile, but not the new frame
+    XCTAssertEqual([], _index.elements(intersecting: CGRect(x: 0, y: 0, width: 30, height: 30)))
+    XCTAssertEqual(
+      ["a"], _index.elements(intersecting: CGRect(x: 75, y: 75, width: 10, height: 10)))
+  }
+
+  func testRemove() {
+    _index.update("a", frame: CGRect(x: 10, y: 10, width: 50, height: 50))
+    _index.update("b", frame: CGRect(x: 20, y: 20, width: 50, height: 50))
+
+    _index.remove("a")
+
+    XCTAssertEqual(1, _index.count)
+    XCTAssertNil(_index.frame(of: "a"))
+    XCTAssertEqual(
+      ["b"], _index.elements(intersecting: CGRect(x: 0, y: 0, width: 100, height: 100)))
+
+    _index.removeAll()
+    XCTAssertEqual(0, _index.count)
+    XCTAssertEqual([], _index.elements(intersecting: CGRect(x: 0, y: 0, width: 100, height: 100)))
+  }
+
+  func testOversizedElementsAreAlwaysChecked() {
+    let hugeFrame = CGRect(x: -100_000, y: -100_000, width: 200_000, height: 200_000)
+    _index.update("huge", frame: hugeFrame)
+    _index.update("small", frame: CGRect(x: 10, y: 10, width: 10, height: 10))
+
+    XCTAssertEqual(
+      ["huge", "small"], _index.elements(intersecting: CGRect(x: 0, y: 0, width: 50, height: 50)))
+    XCTAssertEqual(
+      ["huge"], _index.elements(intersecting: CGRect(x: 5000, y: 5000, width: 50, height: 50)))
+
+    _index.remove("huge")
+    XCTAssertEqual(
+      [], _index.elements(intersecting: CGRect(x: 5000, y: 5000, width: 50, height: 50)))
+  }
+
+  func testQueryOnlyVisitsNearbyElements() {
+    // Lay out 10,000 elements in a 100x100 grid, one per tile
+    for x in 0 ..< 100 {
+      for y in 0 ..< 100 {
+        _index.update(
+          "\(x),\(y)", frame: CGRect(x: x * 100 + 10, y: y * 100 + 10, width: 50, height: 50))
+      }
+    }
+
+    let visibleElements = _index.elements(
+      intersecting: CGRect(x: 5000, y: 5000, width: 300, height: 200))
+
+    XCTAssertEqual(6, visibleElements.count)
+    XCTAssertLessThanOrEqual(_index.lastQueryVisitedCount, 12)
+  }
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import XCTest
+
+// Lists the tests of `BlocklyCoreTests` for platforms where XCTest can't discover them at runtime
+// (see `Tests/LinuxMain.swift`).
+#if os(Linux)
+extension ColorComponentsTest {
+  static var allTests = [
+    ("testInitFromRGB_valid", testInitFromRGB_valid),
+    ("testInitFromRGB_invalid", testInitFromRGB_invalid),
+    ("testInitFromHue", testInitFromHue),
+    ("testInitClampsValues", testInitClampsValues),
+  ]
+}
+
+extension LRUCacheTest {
+  static var allTests = [
+    ("testValueForKey", testValueForKey),
+    ("testSetValueReplacesExistingValue", testSetValueReplacesExistingValue),
+    ("testEvictsLeastRecentlyUsedValue", testEvictsLeastRecentlyUsedValue),
+    ("testLoweringCapacityEvictsValues", testLoweringCapacityEvictsValues),
+    ("testRemoveValue", testRemoveValue),
+    ("testRemoveAllValues", testRemoveAllValues),
+  ]
+}
+
+extension TextMeasurerTest {
+  static var allTests = [
+    ("testFixedMetricsSingleLine", testFixedMetricsSingleLine),
+    ("testFixedMetricsMultiLineWrapsText", testFixedMetricsMultiLineWrapsText),
+    ("testCachingMeasurerReusesMeasurements", testCachingMeasurerReusesMeasurements),
+    ("testCachingMeasurerKeysByTextFontAndWidth", testCachingMeasurerKeysByTextFontAndWidth),
+    ("testCachingMeasurerEvictsLeastRecentlyUsedMeasurements",
+      testCachingMeasurerEvictsLeastRecentlyUsedMeasurements),
+    ("testMeasurementFontEquality", testMeasurementFontEquality),
+  ]
+}
+
+extension TileIndexTest {
+  static var allTests = [
+    ("testElementsIntersectingRect", testElementsIntersectingRect),
+    ("testElementSpanningSeveralTiles", testElementSpanningSeveralTiles),
+    ("testUpdateMovesElement", testUpdateMovesElement),
+    ("testUpdateWithinSameTileUsesNewFrame", testUpdateWithinSameTileUsesNewFrame),
+    ("testRemove", testRemove),
+    ("testOversizedElementsAreAlwaysChecked", testOversizedElementsAreAlwaysChecked),
+    ("testQueryOnlyVisitsNearbyElements", testQueryOnlyVisitsNearbyElements),
+  ]
+}
+
+public func allTests() -> [XCTestCaseEntry] {
+  return [
+    testCase(ColorComponentsTest.allTests),
+    testCase(LRUCacheTest.allTests),
+    testCase(TextMeasurerTest.allTests),
+    testCase(TileIndexTest.allTests),
+  ]
+}
+#endif
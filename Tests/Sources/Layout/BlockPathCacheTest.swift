@@ -0,0 +1,154 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+@testable import Blockly
+import XCTest
+
+/** Tests for `BlockPathCache`. */
+class BlockPathCacheTest: XCTestCase {
+
+  var _workspaceLayout: WorkspaceLayout!
+  var _layoutBuilder: LayoutBuilder!
+
+  // MARK: - Setup
+
+  override func setUp() {
+    super.setUp()
+    _workspaceLayout = WorkspaceLayout(workspace: Workspace(), engine: DefaultLayoutEngine())
+    _layoutBuilder = LayoutBuilder(layoutFactory: LayoutFactory())
+  }
+
+  // MARK: - Tests
+
+  func testSignatureOfIdenticalBlocksIsEqual() {
+    guard
+      let layout1 = makeBlockLayout(inputTypes: [.value, .statement]),
+      let layout2 = makeBlockLayout(inputTypes: [.value, .statement]),
+      let layout3 = makeBlockLayout(inputTypes: [.value]) else
+    {
+      XCTFail("Could not build block layouts")
+      return
+    }
+
+    let signature1 = BlockPathCache.ShapeSignature(layout: layout1)
+    XCTAssertEqual(signature1, BlockPathCache.ShapeSignature(layout: layout2))
+    XCTAssertEqual(signature1.hashValue, BlockPathCache.ShapeSignature(layout: layout2).hashValue)
+    XCTAssertNotEqual(signature1, BlockPathCache.ShapeSignature(layout: layout3))
+  }
+
+  func testSignatureIncludesScale() {
+    guard let layout = makeBlockLayout(inputTypes: [.value]) else {
+      XCTFail("Could not build block layout")
+      return
+    }
+
+    let signature = BlockPathCache.ShapeSignature(layout: layout)
+    _workspaceLayout.engine.scale = 2
+    XCTAssertNotEqual(signature, BlockPathCache.ShapeSignature(layout: layout))
+  }
+
+  func testPathIsSharedForSameShape() {
+    guard
+      let layout1 = makeBlockLayout(inputTypes: [.value]),
+      let layout2 = makeBlockLayout(inputTypes: [.value]) else
+    {
+      XCTFail("Could not build block layouts")
+      return
+    }
+
+    let cache = BlockPathCache()
+    var buildCount = 0
+    let makePath: () -> UIBezierPath = {
+      buildCount += 1
+      return UIBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+    }
+
+    let path1 = cache.path(for: BlockPathCache.ShapeSignature(layout: layout1), makePath: makePath)
+    let path2 = cache.path(for: BlockPathCache.ShapeSignature(layout: layout2), makePath: makePath)
+
+    XCTAssertTrue(path1 === path2)
+    XCTAssertEqual(1, buildCount)
+    XCTAssertEqual(1, cache.cachedPathCount)
+    XCTAssertEqual(1, cache.hitCount)
+    XCTAssertEqual(1, cache.missCount)
+    XCTAssertEqual(0.5, cache.hitRate)
+  }
+
+  func testEstimatedByteCount() {
+    guard
+      let layout1 = makeBlockLayout(inputTypes: [.value]),
+      let layout2 = makeBlockLayout(inputTypes: [.statement]) else
+    {
+      XCTFail("Could not build block layouts")
+      return
+    }
+
+    let cache = BlockPathCache(capacity: 1)
+    let path = UIBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+    let byteCount = BlockPathCache.byteCount(of: path)
+    XCTAssertGreaterThan(byteCount, 0)
+
+    _ = cache.path(for: BlockPathCache.ShapeSignature(layout: layout1)) { path }
+    XCTAssertEqual(byteCount, cache.estimatedByteCount)
+
+    // Adding a second path evicts the first one
+    _ = cache.path(for: BlockPathCache.ShapeSignature(layout: layout2)) { path }
+    XCTAssertEqual(1, cache.evictionCount)
+    XCTAssertEqual(byteCount, cache.estimatedByteCount)
+
+    cache.removeAllPaths()
+    XCTAssertEqual(0, cache.cachedPathCount)
+    XCTAssertEqual(0, cache.estimatedByteCount)
+  }
+
+  func testDisabledCacheAlwaysBuildsPaths() {
+    guard let layout = makeBlockLayout(inputTypes: [.value]) else {
+      XCTFail("Could not build block layout")
+      return
+    }
+
+    let cache = BlockPathCache()
+    cache.isEnabled = false
+    var buildCount = 0
+    for _ in 0 ..< 3 {
+      _ = cache.path(for: BlockPathCache.ShapeSignature(layout: layout)) {
+        buildCount += 1
+        return UIBezierPath()
+      }
+    }
+
+    XCTAssertEqual(3, buildCount)
+    XCTAssertEqual(0, cache.cachedPathCount)
+  }
+
+  // MARK: - Helper methods
+
+  func makeBlockLayout(inputTypes: [Input.InputType]) -> DefaultBlockLayout? {
+    let builder = BlockBuilder(name: "test")
+    for (i, inputType) in inputTypes.enumerated() {
+      builder.inputBuilders.append(InputBuilder(type: inputType, name: "input\(i)"))
+    }
+
+    return BKYAssertDoesNotThrow { () -> DefaultBlockLayout? in
+      try builder.setPreviousConnection(enabled: true)
+      try builder.setNextConnection(enabled: true)
+      let block = try builder.makeBlock()
+      try _workspaceLayout.workspace.addBlockTree(block)
+      try _layoutBuilder.buildLayoutTree(forWorkspaceLayout: _workspaceLayout)
+      _workspaceLayout.updateLayoutDownTree()
+      return block.layout as? DefaultBlockLayout
+    }
+  }
+}
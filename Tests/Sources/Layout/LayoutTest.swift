@@ -104,4 +104,137 @@ class LayoutTest: XCTestCase {
 
     XCTAssertEqual(0, flattenedTree.count)
   }
+
+  func testRefreshViewPositionsForTree_OnlyIfNeededSkipsCleanTree() {
+    let (root, _, _) = makeLayoutTree()
+
+    root.refreshViewPositionsForTree()
+    XCTAssertEqual(5, root.lastViewPositionRefresh.visitedCount)
+    XCTAssertEqual(5, root.lastViewPositionRefresh.refreshedCount)
+
+    root.refreshViewPositionsForTree(onlyIfNeeded: true)
+    XCTAssertEqual(1, root.lastViewPositionRefresh.visitedCount)
+    XCTAssertEqual(0, root.lastViewPositionRefresh.refreshedCount)
+  }
+
+  func testRefreshViewPositionsForTree_OnlyIfNeededRefreshesChangedSubtree() {
+    let (root, branch, leaf) = makeLayoutTree()
+    root.refreshViewPositionsForTree()
+
+    branch.relativePosition = WorkspacePoint(x: 10, y: 20)
+    root.refreshViewPositionsForTree(onlyIfNeeded: true)
+
+    // The root and its two branches are visited, but only the changed branch and its leaf are
+    // repositioned
+    XCTAssertEqual(4, root.lastViewPositionRefresh.visitedCount)
+    XCTAssertEqual(2, root.lastViewPositionRefresh.refreshedCount)
+    XCTAssertEqual(WorkspacePoint(x: 10, y: 20), branch.absolutePosition)
+    XCTAssertEqual(WorkspacePoint(x: 15, y: 25), leaf.absolutePosition)
+  }
+
+  func testRefreshViewPositionsForTree_OnlyIfNeededRefreshesChildrenOnContentOffsetChange() {
+    let (root, branch, leaf) = makeLayoutTree()
+    root.refreshViewPositionsForTree()
+
+    branch.childContentOffset = WorkspacePoint(x: 1, y: 1)
+    root.refreshViewPositionsForTree(onlyIfNeeded: true)
+
+    XCTAssertEqual(2, root.lastViewPositionRefresh.refreshedCount)
+    XCTAssertEqual(layoutEngine.viewUnitFromWorkspaceUnit(6), leaf.viewFrame.origin.y)
+  }
+
+  func testRefreshViewPositionsForTree_UnchangedValueDoesNotNeedRefresh() {
+    let (root, branch, _) = makeLayoutTree()
+    root.refreshViewPositionsForTree()
+
+    branch.relativePosition = branch.relativePosition
+    branch.contentSize = branch.contentSize
+    root.refreshViewPositionsForTree(onlyIfNeeded: true)
+
+    XCTAssertEqual(0, root.lastViewPositionRefresh.refreshedCount)
+  }
+
+  func testTransaction_SkipsLayoutsDetachedFromWorkspace() {
+    let workspaceLayout = WorkspaceLayout(workspace: Workspace(), engine: layoutEngine)
+    let attachedLayout = CountingLayout(engine: layoutEngine)
+    let detachedLayout = CountingLayout(engine: layoutEngine)
+    let detachedChild = CountingLayout(engine: layoutEngine)
+    workspaceLayout.adoptChildLayout(attachedLayout)
+    workspaceLayout.adoptChildLayout(detachedLayout)
+    detachedLayout.adoptChildLayout(detachedChild)
+
+    layoutEngine.performTransaction {
+      attachedLayout.updateLayoutUpTree()
+      detachedLayout.updateLayoutDownTree()
+      detachedChild.updateLayoutUpTree()
+      workspaceLayout.removeChildLayout(detachedLayout)
+    }
+
+    XCTAssertEqual(1, attachedLayout.performLayoutCount)
+    XCTAssertEqual(0, detachedLayout.performLayoutCount)
+    XCTAssertEqual(0, detachedChild.performLayoutCount)
+  }
+
+  func testTransaction_SendsOneChangeEventPerLayout() {
+    let workspaceLayout = WorkspaceLayout(workspace: Workspace(), engine: layoutEngine)
+    let layout = CountingLayout(engine: layoutEngine)
+    let delegate = CountingLayoutDelegate()
+    workspaceLayout.adoptChildLayout(layout)
+    layout.delegate = delegate
+
+    layoutEngine.performTransaction {
+      layout.sendChangeEvent(withFlags: Layout.Flag_NeedsDisplay)
+      layout.updateLayoutUpTree()
+    }
+
+    // Laying out the layout during the commit changes its view frame, which should be merged into
+    // the event that was sent during the transaction
+    XCTAssertEqual(1, layout.performLayoutCount)
+    XCTAssertEqual(1, delegate.changeEventCount)
+    XCTAssertTrue(delegate.flags.intersectsWith(Layout.Flag_NeedsDisplay))
+    XCTAssertTrue(delegate.flags.intersectsWith(Layout.Flag_UpdateViewFrame))
+  }
+
+  // MARK: - Helpers
+
+  /**
+   Creates a tree of plain layouts: a root with two branches, where each branch has one leaf.
+   Returns the root, one of its branches, and that branch's leaf.
+   */
+  fileprivate func makeLayoutTree() -> (root: Layout, branch: Layout, leaf: Layout) {
+    let root = Layout(engine: layoutEngine)
+    let branches = [Layout(engine: layoutEngine), Layout(engine: layoutEngine)]
+
+    var leaf: Layout!
+    for branch in branches {
+      root.adoptChildLayout(branch)
+      leaf = Layout(engine: layoutEngine)
+      leaf.relativePosition = WorkspacePoint(x: 5, y: 5)
+      leaf.contentSize = WorkspaceSize(width: 10, height: 10)
+      branch.adoptChildLayout(leaf)
+    }
+
+    return (root, branches[1], leaf)
+  }
+}
+
+/** Layout that counts how many times it has been laid out, and grows each time. */
+fileprivate class CountingLayout: Layout {
+  var performLayoutCount = 0
+
+  override func performLayout(includeChildren: Bool) {
+    performLayoutCount += 1
+    contentSize = WorkspaceSize(width: 10, height: CGFloat(10 * performLayoutCount))
+  }
+}
+
+/** Layout delegate that counts the change events it receives. */
+fileprivate class CountingLayoutDelegate: LayoutDelegate {
+  var changeEventCount = 0
+  var flags = LayoutFlag.None
+
+  func layoutDidChange(_ layout: Layout, withFlags flags: LayoutFlag, animated: Bool) {
+    changeEventCount += 1
+    self.flags.formUnion(flags)
+  }
 }
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+@testable import Blockly
+import XCTest
+
+/** Tests for `BlockGroupView.LevelOfDetail`. */
+class LevelOfDetailTest: XCTestCase {
+
+  // MARK: - Tests
+
+  func testLevelOfDetailForScale() {
+    let config = LayoutConfig()
+    config.setFloat(0.5, for: LayoutConfig.SilhouetteDetailScale)
+    config.setFloat(0.25, for: LayoutConfig.RasterizedDetailScale)
+
+    XCTAssertEqual(.full, BlockGroupView.LevelOfDetail.forScale(1, config: config))
+    XCTAssertEqual(.full, BlockGroupView.LevelOfDetail.forScale(0.5, config: config))
+    XCTAssertEqual(.silhouette, BlockGroupView.LevelOfDetail.forScale(0.4, config: config))
+    XCTAssertEqual(.rasterized, BlockGroupView.LevelOfDetail.forScale(0.2, config: config))
+  }
+
+  func testLevelOfDetailHidesFieldViews() {
+    let blockGroupView = BlockGroupView(frame: CGRect.zero)
+    let blockView = BlockView()
+    let fieldView = FieldView(frame: CGRect.zero)
+    let nestedBlockGroupView = BlockGroupView(frame: CGRect.zero)
+    let nestedFieldView = FieldView(frame: CGRect.zero)
+    blockGroupView.addSubview(blockView)
+    blockView.addSubview(fieldView)
+    blockView.addSubview(nestedBlockGroupView)
+    nestedBlockGroupView.addSubview(nestedFieldView)
+
+    blockGroupView.levelOfDetail = .rasterized
+
+    XCTAssertTrue(fieldView.isHidden)
+    XCTAssertTrue(nestedFieldView.isHidden)
+    XCTAssertEqual(.rasterized, nestedBlockGroupView.levelOfDetail)
+    // Only the top-level block group view is rasterized
+    XCTAssertTrue(blockGroupView.layer.shouldRasterize)
+    XCTAssertFalse(nestedBlockGroupView.layer.shouldRasterize)
+
+    // Views added later match the level of detail of their block group
+    let addedFieldView = FieldView(frame: CGRect.zero)
+    blockView.addSubview(addedFieldView)
+    XCTAssertTrue(addedFieldView.isHidden)
+
+    blockGroupView.levelOfDetail = .full
+
+    XCTAssertFalse(fieldView.isHidden)
+    XCTAssertFalse(nestedFieldView.isHidden)
+    XCTAssertFalse(addedFieldView.isHidden)
+    XCTAssertFalse(blockGroupView.layer.shouldRasterize)
+  }
+
+  func testNestedBlockGroupViewMatchesParentWhenMoved() {
+    let blockGroupView = BlockGroupView(frame: CGRect.zero)
+    blockGroupView.levelOfDetail = .silhouette
+
+    let otherBlockGroupView = BlockGroupView(frame: CGRect.zero)
+    let fieldView = FieldView(frame: CGRect.zero)
+    otherBlockGroupView.addSubview(fieldView)
+    XCTAssertFalse(fieldView.isHidden)
+
+    blockGroupView.addSubview(otherBlockGroupView)
+
+    XCTAssertEqual(.silhouette, otherBlockGroupView.levelOfDetail)
+    XCTAssertTrue(fieldView.isHidden)
+  }
+}
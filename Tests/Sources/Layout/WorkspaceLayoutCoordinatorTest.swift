@@ -369,4 +369,61 @@ class WorkspaceLayoutCoordinatorTest: XCTestCase {
     XCTAssertEqual(1, blockLayout2.parentBlockGroupLayout!.blockLayouts.count)
     XCTAssertEqual(blockLayout2, blockLayout2.parentBlockGroupLayout!.blockLayouts[0])
   }
+
+  func testBatchUpdatesConnectStatementChain() {
+    let workspaceLayout = _workspaceLayoutCoordinator.workspaceLayout
+    var blocks = [Block]()
+
+    BKYAssertDoesNotThrow {
+      try _workspaceLayoutCoordinator.performBatchUpdates {
+        for _ in 0 ..< 20 {
+          let block = try _blockFactory.makeBlock(name: "statement_value_input")
+          try _workspaceLayoutCoordinator.addBlockTree(block)
+
+          if let previousBlock = blocks.last,
+            let nextConnection = previousBlock.nextConnection,
+            let previousConnection = block.previousConnection
+          {
+            try _workspaceLayoutCoordinator.connect(nextConnection, previousConnection)
+          }
+          blocks.append(block)
+        }
+
+        // The layout hierarchy is updated immediately, even though layout work is deferred
+        XCTAssertNotNil(workspaceLayout.engine.transaction)
+        XCTAssertEqual(20, blocks.first?.layout?.parentBlockGroupLayout?.blockLayouts.count)
+      }
+    }
+
+    XCTAssertNil(workspaceLayout.engine.transaction)
+    XCTAssertEqual(1, workspaceLayout.blockGroupLayouts.count)
+
+    // Positions after the batch should match those of a full layout pass
+    let batchedPositions = blocks.flatMap { $0.layout?.absolutePosition }
+    let batchedFrames = blocks.flatMap { $0.layout?.viewFrame }
+    XCTAssertEqual(20, batchedPositions.count)
+
+    for i in 1 ..< batchedPositions.count {
+      XCTAssertGreaterThan(batchedPositions[i].y, batchedPositions[i - 1].y)
+    }
+
+    workspaceLayout.updateLayoutDownTree()
+
+    XCTAssertEqual(batchedPositions, blocks.flatMap { $0.layout?.absolutePosition })
+    XCTAssertEqual(batchedFrames, blocks.flatMap { $0.layout?.viewFrame })
+  }
+
+  func testBatchUpdatesNested() {
+    let engine = _workspaceLayoutCoordinator.workspaceLayout.engine
+
+    _workspaceLayoutCoordinator.beginBatchUpdates()
+    _workspaceLayoutCoordinator.beginBatchUpdates()
+    XCTAssertEqual(2, engine.transaction?.depth)
+
+    _workspaceLayoutCoordinator.commitBatchUpdates()
+    XCTAssertEqual(1, engine.transaction?.depth)
+
+    _workspaceLayoutCoordinator.commitBatchUpdates()
+    XCTAssertNil(engine.transaction)
+  }
 }
@@ -226,6 +226,99 @@ class BlockTest: XCTestCase {
     }
   }
 
+  func testBlocksInTree() {
+    // Keep a reference to every block, since connections don't retain their target blocks
+    let blocks = makeTreeWithShadows()
+    guard let root = blocks.first else {
+      XCTFail("Couldn't initialize blocks")
+      return
+    }
+
+    // Pre-order, with real blocks before their shadows, and inputs before the next block
+    XCTAssertEqual(
+      ["root", "output", "outputShadow", "next", "nextShadow"],
+      root.blocksInTree().map { $0.uuid })
+    XCTAssertEqual(root.allBlocksForTree(), Array(root.blocksInTree()))
+    XCTAssertEqual(
+      ["root", "output", "next"], root.blocksInTree(includingShadows: false).map { $0.uuid })
+  }
+
+  func testConnectionsInTree() {
+    // Keep a reference to every block, since connections don't retain their target blocks
+    let blocks = makeTreeWithShadows()
+    guard let root = blocks.first else {
+      XCTFail("Couldn't initialize blocks")
+      return
+    }
+
+    // The root's previous connection is included, but not followed
+    let connections = Array(root.connectionsInTree())
+    XCTAssertEqual(root.allConnectionsForTree(), connections)
+    XCTAssertEqual(6, connections.count)
+    XCTAssertTrue(connections.contains { $0.sourceBlock?.uuid == "output" })
+    XCTAssertFalse(connections.contains { $0.sourceBlock?.uuid == "outputShadow" })
+
+    let connectionsWithShadows = Array(root.connectionsInTree(includingShadows: true))
+    XCTAssertEqual(9, connectionsWithShadows.count)
+    XCTAssertTrue(connectionsWithShadows.contains { $0.sourceBlock?.uuid == "outputShadow" })
+    XCTAssertTrue(connectionsWithShadows.contains { $0.sourceBlock?.uuid == "nextShadow" })
+  }
+
+  func testVisitBlocksInTree() {
+    // Keep a reference to every block, since connections don't retain their target blocks
+    let blocks = makeTreeWithShadows()
+    guard let root = blocks.first else {
+      XCTFail("Couldn't initialize blocks")
+      return
+    }
+
+    var visitedUUIDs = [String]()
+    root.visitBlocksInTree { block in
+      visitedUUIDs.append(block.uuid)
+      return block.uuid == "root" ? .skipChildren : .visitChildren
+    }
+    XCTAssertEqual(["root"], visitedUUIDs)
+
+    visitedUUIDs.removeAll()
+    root.visitBlocksInTree(includingShadows: false) { block in
+      visitedUUIDs.append(block.uuid)
+      return block.uuid == "output" ? .stop : .visitChildren
+    }
+    XCTAssertEqual(["root", "output"], visitedUUIDs)
+  }
+
+  func testBlocksInTree_LongChain() {
+    let chain = makeStatementChain(count: 10_000)
+    guard let root = chain.first else {
+      XCTFail("Couldn't create chain")
+      return
+    }
+
+    // Deep chains can't overflow the stack, since traversals aren't recursive
+    XCTAssertEqual(10_000, root.allBlocksForTree().count)
+    XCTAssertEqual(20_000, root.allConnectionsForTree().count)
+    XCTAssertTrue(root.blocksInTree().reversed().first === chain.last)
+  }
+
+  func testBlocksInTreePerformance() {
+    let chain = makeStatementChain(count: 10_000)
+    guard let root = chain.first else {
+      XCTFail("Couldn't create chain")
+      return
+    }
+
+    measure {
+      var count = 0
+      for _ in root.blocksInTree() {
+        count += 1
+      }
+      for _ in root.connectionsInTree() {
+        count += 1
+      }
+      XCTAssertEqual(30_000, count)
+    }
+  }
+
   func testDeepCopy() {
     guard
       let blockStatementOutputNoInput =
@@ -649,6 +742,51 @@ class BlockTest: XCTestCase {
 
   // MARK: - Helper methods
 
+  /// Creates a statement block with real and shadow blocks connected to its value input and next
+  /// connection. The root block is returned first.
+  func makeTreeWithShadows() -> [Block] {
+    let names = [
+      ("root", "statement_value_input", false),
+      ("output", "simple_input_output", false),
+      ("outputShadow", "simple_input_output", true),
+      ("next", "statement_no_next", false),
+      ("nextShadow", "statement_no_next", true)
+    ]
+    var blocks = [Block]()
+    for (uuid, name, shadow) in names {
+      guard let block = BKYAssertDoesNotThrow({
+        try self._blockFactory.makeBlock(name: name, shadow: shadow, uuid: uuid)
+      }) else {
+        return []
+      }
+      blocks.append(block)
+    }
+
+    BKYAssertDoesNotThrow { () -> Void in
+      let input = blocks[0].onlyValueInput()?.connection
+      try input?.connectTo(blocks[1].outputConnection)
+      try input?.connectShadowTo(blocks[2].outputConnection)
+      try blocks[0].nextConnection?.connectTo(blocks[3].previousConnection)
+      try blocks[0].nextConnection?.connectShadowTo(blocks[4].previousConnection)
+    }
+    return blocks
+  }
+
+  /// Creates a chain of statement blocks connected through their next connections.
+  func makeStatementChain(count: Int) -> [Block] {
+    var blocks = [Block]()
+    blocks.reserveCapacity(count)
+
+    BKYAssertDoesNotThrow { () -> Void in
+      for _ in 0 ..< count {
+        let block = try _blockFactory.makeBlock(name: "statement_no_input")
+        try blocks.last?.nextConnection?.connectTo(block.previousConnection)
+        blocks.append(block)
+      }
+    }
+    return blocks
+  }
+
   /**
    Compares two trees of blocks and asserts that their tree of connections is the same.
    */
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+@testable import Blockly
+import XCTest
+
+/** Tests for merging and filtering arrays of `BlocklyEvent`. */
+class BlocklyEventTest: XCTestCase {
+
+  let workspaceID = "workspace"
+
+  // MARK: - merged
+
+  func testMergedAdjacentMoveEvents() {
+    let events = ([
+      makeMoveEvent(blockID: "a", from: (0, 0), to: (10, 10)),
+      makeMoveEvent(blockID: "a", from: (10, 10), to: (20, 20))
+    ] as [BlocklyEvent]).merged()
+
+    XCTAssertEqual(1, events.count)
+    let move = events.first as? BlocklyEvent.Move
+    XCTAssertEqual(WorkspacePoint(x: 0, y: 0), move?.oldPosition)
+    XCTAssertEqual(WorkspacePoint(x: 20, y: 20), move?.newPosition)
+  }
+
+  func testMergedInterleavedMoveAndChangeEvents() {
+    let events = ([
+      makeMoveEvent(blockID: "a", from: (0, 0), to: (10, 10)),
+      makeChangeEvent(blockID: "a", fieldName: "NUM", from: "1", to: "2"),
+      makeMoveEvent(blockID: "b", from: (0, 0), to: (5, 5)),
+      makeMoveEvent(blockID: "a", from: (10, 10), to: (20, 20)),
+      makeChangeEvent(blockID: "a", fieldName: "NUM", from: "2", to: "3"),
+      makeMoveEvent(blockID: "b", from: (5, 5), to: (6, 6))
+    ] as [BlocklyEvent]).merged()
+
+    XCTAssertEqual(3, events.count)
+
+    let moveA = events[0] as? BlocklyEvent.Move
+    XCTAssertEqual("a", moveA?.blockID)
+    XCTAssertEqual(WorkspacePoint(x: 0, y: 0), moveA?.oldPosition)
+    XCTAssertEqual(WorkspacePoint(x: 20, y: 20), moveA?.newPosition)
+
+    let changeA = events[1] as? BlocklyEvent.Change
+    XCTAssertEqual("1", changeA?.oldValue)
+    XCTAssertEqual("3", changeA?.newValue)
+
+    let moveB = events[2] as? BlocklyEvent.Move
+    XCTAssertEqual("b", moveB?.blockID)
+    XCTAssertEqual(WorkspacePoint(x: 0, y: 0), moveB?.oldPosition)
+    XCTAssertEqual(WorkspacePoint(x: 6, y: 6), moveB?.newPosition)
+  }
+
+  func testMergedDoesNotMergeDifferentFields() {
+    let events = ([
+      makeChangeEvent(blockID: "a", fieldName: "NUM", from: "1", to: "2"),
+      makeChangeEvent(blockID: "a", fieldName: "TEXT", from: "x", to: "y"),
+      makeChangeEvent(blockID: "a", fieldName: "NUM", from: "2", to: "3")
+    ] as [BlocklyEvent]).merged()
+
+    XCTAssertEqual(2, events.count)
+    XCTAssertEqual("NUM", (events[0] as? BlocklyEvent.Change)?.fieldName)
+    XCTAssertEqual("3", (events[0] as? BlocklyEvent.Change)?.newValue)
+    XCTAssertEqual("TEXT", (events[1] as? BlocklyEvent.Change)?.fieldName)
+  }
+
+  func testMergedDoesNotMergeAcrossDifferentGroups() {
+    let events = ([
+      makeMoveEvent(blockID: "a", from: (0, 0), to: (10, 10), groupID: "1"),
+      makeMoveEvent(blockID: "a", from: (10, 10), to: (20, 20), groupID: "2"),
+      makeMoveEvent(blockID: "a", from: (20, 20), to: (30, 30), groupID: "1")
+    ] as [BlocklyEvent]).merged()
+
+    XCTAssertEqual(3, events.count)
+  }
+
+  func testMergedDoesNotMergeAcrossMutationEvents() {
+    let mutation = BlocklyEvent.Change(
+      element: BlocklyEvent.Change.elementMutate, workspaceID: workspaceID, blockID: "b",
+      oldValue: "<mutation items=\"1\"/>", newValue: "<mutation items=\"2\"/>")
+    let events = ([
+      makeMoveEvent(blockID: "a", from: (0, 0), to: (10, 10)),
+      mutation,
+      makeMoveEvent(blockID: "a", from: (10, 10), to: (20, 20))
+    ] as [BlocklyEvent]).merged()
+
+    XCTAssertEqual(3, events.count)
+    XCTAssertTrue(events[1] === mutation)
+  }
+
+  func testMergedDoesNotMergeMovesAcrossOtherConnectionChanges() {
+    // "a" leaves "p", "b" leaves "q", and then "a" takes the input that "b" left
+    let events = ([
+      makeMoveEvent(blockID: "a", oldParentID: "p", newParentID: nil),
+      makeMoveEvent(blockID: "b", oldParentID: "q", newParentID: nil),
+      makeMoveEvent(blockID: "a", oldParentID: nil, newParentID: "q")
+    ] as [BlocklyEvent]).merged()
+
+    XCTAssertEqual(3, events.count)
+    XCTAssertEqual(["a", "b", "a"], events.map { $0.blockID ?? "" })
+    XCTAssertEqual("q", (events[2] as? BlocklyEvent.Move)?.newParentID)
+  }
+
+  func testMergedMergesConnectionChangesOfSameBlock() {
+    // "a" is dragged out of "p" and dropped into "q", while "b" is moved around on its own
+    let events = ([
+      makeMoveEvent(blockID: "a", oldParentID: "p", newParentID: nil),
+      makeMoveEvent(blockID: "b", from: (0, 0), to: (5, 5)),
+      makeMoveEvent(blockID: "a", from: (0, 0), to: (10, 10)),
+      makeMoveEvent(blockID: "a", oldParentID: nil, newParentID: "q")
+    ] as [BlocklyEvent]).merged()
+
+    XCTAssertEqual(2, events.count)
+    let moveA = events[0] as? BlocklyEvent.Move
+    XCTAssertEqual("p", moveA?.oldParentID)
+    XCTAssertEqual("q", moveA?.newParentID)
+    XCTAssertEqual("b", events[1].blockID)
+  }
+
+  // MARK: - Create / Delete XML
+
+  func testCreateEventXMLMatchesBlockXMLWhenCreated() {
+    guard let block = makeLoopBlock() else {
+      return
+    }
+    let expectedXML = BKYAssertDoesNotThrow { try block.toXML() }
+    let event = BKYAssertDoesNotThrow {
+      try BlocklyEvent.Create(workspace: Workspace(), block: block)
+    }
+
+    // Modify the block after the event was created, which shouldn't affect the event
+    (block.firstInput(withName: "TIMES")?.connectedBlock?.firstField(withName: "NUM")
+      as? FieldNumber)?.value = 42
+    block.position = WorkspacePoint(x: 100, y: 100)
+
+    XCTAssertEqual(expectedXML, event?.xml)
+    XCTAssertEqual(block.allBlocksForTree().map { $0.uuid }, event?.blockIDs ?? [])
+  }
+
+  func testDeleteEventXMLMatchesBlockXMLWhenCreated() {
+    guard let block = makeLoopBlock() else {
+      return
+    }
+    let expectedXML = BKYAssertDoesNotThrow { try block.toXML() }
+    let event = BKYAssertDoesNotThrow {
+      try BlocklyEvent.Delete(workspace: Workspace(), block: block)
+    }
+
+    block.disabled = true
+
+    XCTAssertEqual(expectedXML, event?.oldXML)
+    XCTAssertEqual(block.allBlocksForTree().map { $0.uuid }, event?.blockIDs ?? [])
+  }
+
+  func testCreateEventJSONRoundTrip() {
+    guard
+      let block = makeLoopBlock(),
+      let event = BKYAssertDoesNotThrow({
+        try BlocklyEvent.Create(workspace: Workspace(), block: block)
+      }),
+      let json = BKYAssertDoesNotThrow({ try event.toJSON() }),
+      let decodedEvent = BKYAssertDoesNotThrow({ try BlocklyEvent.Create(json: json) }) else
+    {
+      return
+    }
+
+    XCTAssertEqual(event.xml, decodedEvent.xml)
+    XCTAssertEqual(event.blockIDs, decodedEvent.blockIDs)
+  }
+
+  // MARK: - Performance
+
+  func testPerformanceMerged100kEvents() {
+    // Simulate 100 blocks being dragged around simultaneously, alongside field edits
+    var events = [BlocklyEvent]()
+    events.reserveCapacity(100_000)
+    for i in 0 ..< 50_000 {
+      let blockID = "block\(i % 100)"
+      let step = CGFloat(i / 100)
+      events.append(makeMoveEvent(blockID: blockID, from: (step, step), to: (step + 1, step + 1)))
+      events.append(
+        makeChangeEvent(blockID: blockID, fieldName: "NUM", from: String(i), to: String(i + 1)))
+    }
+
+    measure {
+      XCTAssertEqual(200, events.merged().count)
+    }
+  }
+
+  // MARK: - Helper methods
+
+  func makeLoopBlock() -> Block? {
+    let factory = BlockFactory()
+    factory.load(fromDefaultFiles: [.loopDefault, .mathDefault])
+    guard
+      let loop = BKYAssertDoesNotThrow({ try factory.makeBlock(name: "controls_repeat_ext") }),
+      let number = BKYAssertDoesNotThrow({ try factory.makeBlock(name: "math_number") }) else
+    {
+      XCTFail("Could not build blocks")
+      return nil
+    }
+    BKYAssertDoesNotThrow {
+      try loop.firstInput(withName: "TIMES")?.connection?.connectTo(number.outputConnection)
+    }
+    loop.position = WorkspacePoint(x: 10, y: 20)
+    return loop
+  }
+
+  func makeMoveEvent(
+    blockID: String, from: (CGFloat, CGFloat), to: (CGFloat, CGFloat), groupID: String? = nil)
+    -> BlocklyEvent.Move
+  {
+    let event = BlocklyEvent.Move(
+      workspaceID: workspaceID, blockID: blockID, oldParentID: nil, oldInputName: nil,
+      oldPosition: WorkspacePoint(x: from.0, y: from.1))
+    event.newPosition = WorkspacePoint(x: to.0, y: to.1)
+    event.groupID = groupID
+    return event
+  }
+
+  func makeMoveEvent(blockID: String, oldParentID: String?, newParentID: String?)
+    -> BlocklyEvent.Move
+  {
+    let event = BlocklyEvent.Move(
+      workspaceID: workspaceID, blockID: blockID, oldParentID: oldParentID,
+      oldInputName: oldParentID != nil ? "INPUT" : nil, oldPosition: WorkspacePoint(x: 0, y: 0))
+    event.newParentID = newParentID
+    event.newInputName = newParentID != nil ? "INPUT" : nil
+    event.newPosition = WorkspacePoint(x: 0, y: 0)
+    return event
+  }
+
+  func makeChangeEvent(blockID: String, fieldName: String, from: String, to: String)
+    -> BlocklyEvent.Change
+  {
+    return BlocklyEvent.Change(
+      element: BlocklyEvent.Change.elementField, workspaceID: workspaceID, blockID: blockID,
+      fieldName: fieldName, oldValue: from, newValue: to)
+  }
+}
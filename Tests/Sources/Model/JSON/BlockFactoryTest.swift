@@ -134,4 +134,217 @@ class BlockFactoryTest: XCTestCase {
     XCTAssertTrue(firstBlockCopy !== secondBlockCopy,
                   "BlockFactory returned the same block instance twice")
   }
+
+  // MARK: - Lazy Loading
+
+  func testLoadBlocksLazily() {
+    _blockFactory.loadsBlockBuildersLazily = true
+    BKYAssertDoesNotThrow {
+      try _blockFactory.load(fromJSONPaths: ["block_factory_json_test.json"],
+                             bundle: Bundle(for: type(of: self)))
+    }
+    XCTAssertEqual(0, _blockFactory.builtBlockBuilderCount)
+    XCTAssertEqual(2, _blockFactory.pendingBlockBuilderCount)
+
+    let block1 = BKYAssertDoesNotThrow { try _blockFactory.makeBlock(name: "block_id_1") }
+    XCTAssertNotNil(block1)
+    XCTAssertEqual(1, _blockFactory.builtBlockBuilderCount)
+    XCTAssertEqual(1, _blockFactory.pendingBlockBuilderCount)
+
+    // The builder should only be built once
+    let block1Copy = BKYAssertDoesNotThrow { try _blockFactory.makeBlock(name: "block_id_1") }
+    XCTAssertNotNil(block1Copy)
+    XCTAssertNotNil(_blockFactory.blockBuilder(forName: "block_id_1"))
+    XCTAssertEqual(1, _blockFactory.builtBlockBuilderCount)
+
+    XCTAssertNotNil(_blockFactory.blockBuilder(forName: "block_id_2"))
+    XCTAssertEqual(2, _blockFactory.builtBlockBuilderCount)
+    XCTAssertEqual(0, _blockFactory.pendingBlockBuilderCount)
+  }
+
+  func testLoadBlocksEagerly() {
+    BKYAssertDoesNotThrow {
+      try _blockFactory.load(fromJSONPaths: ["block_factory_json_test.json"],
+                             bundle: Bundle(for: type(of: self)))
+    }
+    XCTAssertEqual(2, _blockFactory.builtBlockBuilderCount)
+    XCTAssertEqual(0, _blockFactory.pendingBlockBuilderCount)
+
+    _ = BKYAssertDoesNotThrow { try _blockFactory.makeBlock(name: "block_id_1") }
+    XCTAssertEqual(2, _blockFactory.builtBlockBuilderCount)
+  }
+
+  func testLoadBlocksLazilyFromDefaultFiles() {
+    _blockFactory.loadsBlockBuildersLazily = true
+    _blockFactory.load(fromDefaultFiles: .allDefault)
+    XCTAssertEqual(0, _blockFactory.builtBlockBuilderCount)
+    XCTAssertGreaterThan(_blockFactory.pendingBlockBuilderCount, 0)
+
+    // Blocks with mutators should still be built correctly
+    let block = BKYAssertDoesNotThrow { try _blockFactory.makeBlock(name: "controls_if") }
+    XCTAssertNotNil(block?.mutator)
+    XCTAssertEqual(1, _blockFactory.builtBlockBuilderCount)
+  }
+
+  func testSetBlockBuilderReplacesPendingDefinition() {
+    _blockFactory.loadsBlockBuildersLazily = true
+    BKYAssertDoesNotThrow {
+      try _blockFactory.load(fromJSONPaths: ["block_factory_json_test.json"],
+                             bundle: Bundle(for: type(of: self)))
+    }
+
+    let blockBuilder = BlockBuilder(name: "")
+    _blockFactory.setBlockBuilder(blockBuilder, forName: "block_id_1")
+    XCTAssertEqual(1, _blockFactory.pendingBlockBuilderCount)
+    XCTAssertTrue(_blockFactory.blockBuilder(forName: "block_id_1") === blockBuilder)
+    XCTAssertEqual(0, _blockFactory.builtBlockBuilderCount)
+  }
+
+  func testInvalidLazyDefinitionIsReportedOnLookup() {
+    let cache = makeTemporaryCache()
+    defer { try? cache.invalidate() }
+
+    // Seed the cache with an invalid definition, which is only parsed when it is first requested
+    let sources = [try! Data(contentsOf: Bundle(for: type(of: self))
+      .url(forResource: "block_factory_json_test.json", withExtension: nil)!)]
+    let definition =
+      "{\"type\": \"invalid\", \"output\": null, \"previousStatement\": null}"
+    BKYAssertDoesNotThrow {
+      try cache.store(
+        definitions: ["invalid": definition.data(using: .utf8)!],
+        forKey: BlockDefinitionCache.makeInvalidationKey(forSources: sources))
+    }
+    BKYAssertDoesNotThrow {
+      try _blockFactory.load(fromJSONPaths: ["block_factory_json_test.json"],
+                             bundle: Bundle(for: type(of: self)), cache: cache)
+    }
+    XCTAssertEqual(1, _blockFactory.pendingBlockBuilderCount)
+
+    XCTAssertNil(_blockFactory.blockBuilder(forName: "invalid"))
+
+    // The definition's error is still reported when making a block
+    BKYAssertThrow(errorType: BlocklyError.self) {
+      _ = try _blockFactory.makeBlock(name: "invalid")
+    }
+    XCTAssertEqual(1, _blockFactory.pendingBlockBuilderCount)
+    XCTAssertEqual(0, _blockFactory.builtBlockBuilderCount)
+  }
+
+  func testPerformanceLoadAllDefaultFilesEagerly() {
+    measure {
+      let blockFactory = BlockFactory()
+      blockFactory.load(fromDefaultFiles: .allDefault)
+    }
+  }
+
+  func testPerformanceLoadAllDefaultFilesLazily() {
+    measure {
+      let blockFactory = BlockFactory()
+      blockFactory.loadsBlockBuildersLazily = true
+      blockFactory.load(fromDefaultFiles: .allDefault)
+      _ = try? blockFactory.makeBlock(name: "controls_if")
+    }
+  }
+
+  // MARK: - Block Definition Cache
+
+  func testLoadFromJSONPathsWithCache() {
+    let cache = makeTemporaryCache()
+    defer { try? cache.invalidate() }
+
+    // First load builds the cache
+    BKYAssertDoesNotThrow {
+      try _blockFactory.load(fromJSONPaths: ["block_factory_json_test.json"],
+                             bundle: Bundle(for: type(of: self)), cache: cache)
+    }
+    XCTAssertEqual(0, cache.hitCount)
+    XCTAssertEqual(1, cache.missCount)
+    XCTAssertTrue(FileManager.default.fileExists(atPath: cache.fileURL.path))
+
+    // Second load reads from the cache
+    let cachedFactory = BlockFactory()
+    BKYAssertDoesNotThrow {
+      try cachedFactory.load(fromJSONPaths: ["block_factory_json_test.json"],
+                             bundle: Bundle(for: type(of: self)), cache: cache)
+    }
+    XCTAssertEqual(1, cache.hitCount)
+    XCTAssertEqual(1, cache.missCount)
+
+    for name in ["block_id_1", "block_id_2"] {
+      guard
+        let expected = BKYAssertDoesNotThrow({ try _blockFactory.makeBlock(name: name) }),
+        let actual = BKYAssertDoesNotThrow({ try cachedFactory.makeBlock(name: name) }) else
+      {
+        XCTFail("Could not make block '\(name)'")
+        continue
+      }
+      XCTAssertEqual(expected.name, actual.name)
+      XCTAssertEqual(expected.inputs.count, actual.inputs.count)
+      XCTAssertEqual(expected.inputs.map { $0.fields.count }, actual.inputs.map { $0.fields.count })
+      XCTAssertEqual(expected.outputConnection?.typeChecks ?? [],
+                     actual.outputConnection?.typeChecks ?? [])
+      XCTAssertEqual(expected.tooltip, actual.tooltip)
+      XCTAssertEqual(expected.inputsInline, actual.inputsInline)
+    }
+    XCTAssertNotNil(cachedFactory.blockBuilder(forName: "block_id_1"))
+    XCTAssertNil(cachedFactory.blockBuilder(forName: "unknown_block"))
+  }
+
+  func testCacheWithDifferentKeyIsIgnored() {
+    let cache = makeTemporaryCache()
+    defer { try? cache.invalidate() }
+
+    BKYAssertDoesNotThrow {
+      try cache.store(definitions: ["block": Data()], forKey: "another key")
+    }
+    XCTAssertNil(cache.definitions(forKey: "key"))
+    XCTAssertEqual(1, cache.missCount)
+    XCTAssertNotNil(cache.definitions(forKey: "another key"))
+    XCTAssertEqual(1, cache.hitCount)
+  }
+
+  func testCorruptCacheIsRebuilt() {
+    let cache = makeTemporaryCache()
+    defer { try? cache.invalidate() }
+
+    BKYAssertDoesNotThrow {
+      try FileManager.default.createDirectory(
+        at: cache.fileURL.deletingLastPathComponent(), withIntermediateDirectories: true,
+        attributes: nil)
+    }
+    BKYAssertDoesNotThrow { try "not a cache".data(using: .utf8)!.write(to: cache.fileURL) }
+    BKYAssertDoesNotThrow {
+      try _blockFactory.load(fromJSONPaths: ["block_factory_json_test.json"],
+                             bundle: Bundle(for: type(of: self)), cache: cache)
+    }
+    XCTAssertEqual(1, cache.missCount)
+    XCTAssertNotNil(BKYAssertDoesNotThrow { try _blockFactory.makeBlock(name: "block_id_1") })
+
+    let sources = [try! Data(contentsOf: Bundle(for: type(of: self))
+      .url(forResource: "block_factory_json_test.json", withExtension: nil)!)]
+    XCTAssertNotNil(
+      cache.definitions(forKey: BlockDefinitionCache.makeInvalidationKey(forSources: sources)))
+  }
+
+  func testCacheInvalidationKey() {
+    let source1 = "[{\"type\": \"a\"}]".data(using: .utf8)!
+    let source2 = "[{\"type\": \"b\"}]".data(using: .utf8)!
+
+    let key = BlockDefinitionCache.makeInvalidationKey(forSources: [source1, source2])
+    XCTAssertEqual(key, BlockDefinitionCache.makeInvalidationKey(forSources: [source1, source2]))
+    XCTAssertNotEqual(key, BlockDefinitionCache.makeInvalidationKey(forSources: [source2, source1]))
+    XCTAssertNotEqual(key, BlockDefinitionCache.makeInvalidationKey(forSources: [source1]))
+    XCTAssertNotEqual(
+      BlockDefinitionCache.makeInvalidationKey(forSources: [source1 + source2]),
+      BlockDefinitionCache.makeInvalidationKey(forSources: [source1, source2]))
+  }
+
+  // MARK: - Helper methods
+
+  func makeTemporaryCache() -> BlockDefinitionCache {
+    let url = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+      .appendingPathComponent("BlockFactoryTest", isDirectory: true)
+      .appendingPathComponent(UUID().uuidString + ".plist")
+    return BlockDefinitionCache(fileURL: url)
+  }
 }
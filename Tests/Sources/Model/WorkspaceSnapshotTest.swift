@@ -0,0 +1,265 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+@testable import Blockly
+import XCTest
+
+class WorkspaceSnapshotTest: XCTestCase {
+
+  var workspace: Workspace!
+  var factory: BlockFactory!
+
+  // MARK: - Setup
+
+  override func setUp() {
+    super.setUp()
+
+    workspace = Workspace()
+    factory = BlockFactory()
+    BKYAssertDoesNotThrow {
+      try factory.load(fromJSONPaths: ["xml_parsing_test.json"], bundle: Bundle(for: type(of: self)))
+    }
+  }
+
+  // MARK: - Tests
+
+  func testRoundTripEmptyWorkspace() {
+    guard let snapshot = BKYAssertDoesNotThrow({ try self.workspace.snapshotData() }) else {
+      XCTFail("Could not create snapshot")
+      return
+    }
+
+    let restoredWorkspace = Workspace()
+    BKYAssertDoesNotThrow { try restoredWorkspace.load(snapshot: snapshot, factory: self.factory) }
+    XCTAssertEqual(0, restoredWorkspace.allBlocks.count)
+  }
+
+  func testRoundTripMatchesXML() {
+    loadWorkspace(stackCount: 3, stackHeight: 5)
+
+    // Exercise flags, comments and field values that need escaping in XML
+    workspace.allBlocks["0_0"]?.disabled = true
+    workspace.allBlocks["1_0"]?.inputsInline = true
+    workspace.allBlocks["1_1"]?.editable = false
+    workspace.allBlocks["2_0"]?.position = WorkspacePoint(x: -250, y: 1234)
+    (workspace.allBlocks["2_3_num"]?.firstField(withName: "NUM") as? FieldInput)?.text = "<&\">"
+
+    guard
+      let snapshot = BKYAssertDoesNotThrow({ try self.workspace.snapshotData() }),
+      let expectedXML = BKYAssertDoesNotThrow({ try self.workspace.toXML() }) else
+    {
+      XCTFail("Could not serialize workspace")
+      return
+    }
+
+    let restoredWorkspace = Workspace()
+    BKYAssertDoesNotThrow { try restoredWorkspace.load(snapshot: snapshot, factory: self.factory) }
+
+    XCTAssertEqual(workspace.allBlocks.count, restoredWorkspace.allBlocks.count)
+    XCTAssertEqual(WorkspacePoint(x: -250, y: 1234), restoredWorkspace.allBlocks["2_0"]?.position)
+    XCTAssertEqual(true, restoredWorkspace.allBlocks["0_0"]?.disabled)
+    XCTAssertEqual(false, restoredWorkspace.allBlocks["1_1"]?.editable)
+    XCTAssertEqual("2_4", restoredWorkspace.allBlocks["2_3"]?.nextBlock?.uuid)
+    XCTAssertEqual("<&\">",
+      (restoredWorkspace.allBlocks["2_3_num"]?.firstField(withName: "NUM") as? FieldInput)?.text)
+
+    // Converting the snapshot back to XML should produce the same blocks
+    guard let xml = BKYAssertDoesNotThrow({
+      try WorkspaceSnapshot.xmlString(fromData: snapshot, factory: self.factory)
+    }) else {
+      XCTFail("Could not convert snapshot to XML")
+      return
+    }
+    XCTAssertEqual(expectedXML.utf8.count, xml.utf8.count)
+  }
+
+  func testRoundTripShadowBlocks() {
+    let xml = "<xml>" +
+      BlockTestStrings.assembleBlock(BlockTestStrings.NESTED_SHADOW_GOOD) +
+      "</xml>"
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+
+    guard let snapshot = BKYAssertDoesNotThrow({ try self.workspace.snapshotData() }) else {
+      XCTFail("Could not create snapshot")
+      return
+    }
+
+    let restoredWorkspace = Workspace()
+    BKYAssertDoesNotThrow { try restoredWorkspace.load(snapshot: snapshot, factory: self.factory) }
+
+    let rootBlock = restoredWorkspace.allBlocks["1"]
+    XCTAssertEqual("SHADOW1",
+      rootBlock?.firstInput(withName: "value_input")?.connection?.shadowBlock?.uuid)
+    XCTAssertEqual("SHADOW3", rootBlock?.nextShadowBlock?.uuid)
+    XCTAssertEqual(true, restoredWorkspace.allBlocks["SHADOW2"]?.shadow)
+  }
+
+  func testRoundTripMutator() {
+    factory.blockBuilder(forName: "frankenblock")?.extensions = [BlockExtensionClosure { block in
+      self.BKYAssertDoesNotThrow {
+        try block.setMutator(DummyMutator())
+      }
+    }]
+
+    let xml = "<xml>" +
+      BlockTestStrings.assembleBlock(BlockTestStrings.DUMMY_MUTATOR_VALUE) +
+      "</xml>"
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+
+    guard let snapshot = BKYAssertDoesNotThrow({ try self.workspace.snapshotData() }) else {
+      XCTFail("Could not create snapshot")
+      return
+    }
+
+    let restoredWorkspace = Workspace()
+    BKYAssertDoesNotThrow { try restoredWorkspace.load(snapshot: snapshot, factory: self.factory) }
+    XCTAssertEqual("dummy_mutator_xml_id",
+      (restoredWorkspace.allBlocks["1"]?.mutator as? DummyMutator)?.id)
+  }
+
+  func testSnapshotFromXML() {
+    let xml = makeWorkspaceXML(stackCount: 2, stackHeight: 2)
+
+    guard let snapshot = BKYAssertDoesNotThrow({
+      try WorkspaceSnapshot.makeData(fromXMLString: xml, factory: self.factory)
+    }) else {
+      XCTFail("Could not convert XML to a snapshot")
+      return
+    }
+
+    BKYAssertDoesNotThrow { try self.workspace.load(snapshot: snapshot, factory: self.factory) }
+    XCTAssertEqual(8, workspace.allBlocks.count)
+  }
+
+  func testLoadInvalidSnapshot() {
+    XCTAssertThrowsError(try workspace.load(snapshot: Data(), factory: factory))
+    XCTAssertThrowsError(try workspace.load(snapshot: Data("<xml />".utf8), factory: factory))
+
+    // Unsupported version
+    var badVersion = Data("BKYS".utf8)
+    badVersion.append(99)
+    XCTAssertThrowsError(try workspace.load(snapshot: badVersion, factory: factory))
+
+    // Truncated snapshot
+    loadWorkspace(stackCount: 1, stackHeight: 3)
+    guard let snapshot = BKYAssertDoesNotThrow({ try self.workspace.snapshotData() }) else {
+      XCTFail("Could not create snapshot")
+      return
+    }
+
+    let restoredWorkspace = Workspace()
+    XCTAssertThrowsError(
+      try restoredWorkspace.load(snapshot: snapshot.prefix(snapshot.count - 2), factory: factory))
+    XCTAssertEqual(0, restoredWorkspace.allBlocks.count)
+  }
+
+  func testSnapshotIsSmallerThanXML() {
+    loadWorkspace(stackCount: 20, stackHeight: 20)
+
+    guard
+      let snapshot = BKYAssertDoesNotThrow({ try self.workspace.snapshotData() }),
+      let xml = BKYAssertDoesNotThrow({ try self.workspace.toXML() }) else
+    {
+      XCTFail("Could not serialize workspace")
+      return
+    }
+
+    XCTAssertLessThan(snapshot.count * 2, xml.utf8.count)
+  }
+
+  // MARK: - Benchmarks
+
+  func testBenchmarkLoadSnapshot() {
+    loadWorkspace(stackCount: 50, stackHeight: 20)
+    guard let snapshot = BKYAssertDoesNotThrow({ try self.workspace.snapshotData() }) else {
+      XCTFail("Could not create snapshot")
+      return
+    }
+    print("Snapshot size: \(snapshot.count) bytes")
+
+    measure {
+      self.BKYAssertDoesNotThrow {
+        try WorkspaceSnapshot.blockTrees(fromData: snapshot, factory: self.factory)
+      }
+    }
+  }
+
+  func testBenchmarkLoadXML() {
+    loadWorkspace(stackCount: 50, stackHeight: 20)
+    guard let xml = BKYAssertDoesNotThrow({ try self.workspace.toXML() }) else {
+      XCTFail("Could not create XML")
+      return
+    }
+    let xmlData = Data(xml.utf8)
+    print("XML size: \(xmlData.count) bytes")
+
+    measure {
+      self.BKYAssertDoesNotThrow {
+        try BlockXMLStreamLoader(factory: self.factory).blockTrees(fromWorkspaceXMLData: xmlData)
+      }
+    }
+  }
+
+  func testBenchmarkCreateSnapshot() {
+    loadWorkspace(stackCount: 50, stackHeight: 20)
+
+    measure {
+      self.BKYAssertDoesNotThrow { try self.workspace.snapshotData() }
+    }
+  }
+
+  // MARK: - Helper methods
+
+  fileprivate func loadWorkspace(stackCount: Int, stackHeight: Int) {
+    let xml = makeWorkspaceXML(stackCount: stackCount, stackHeight: stackHeight)
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+  }
+
+  /**
+   Returns workspace XML containing `stackCount` stacks of `statement_value_input` blocks, where
+   each stack is `stackHeight` blocks tall and each block has a `math_number` block in its input.
+   Block ids are of the form "<stack>_<index>" and "<stack>_<index>_num".
+   */
+  fileprivate func makeWorkspaceXML(stackCount: Int, stackHeight: Int) -> String {
+    var interiorXML = ""
+
+    for stack in 0 ..< stackCount {
+      var stackXML = ""
+      for index in (0 ..< stackHeight).reversed() {
+        let uuid = "\(stack)_\(index)"
+        let position = index == 0 ? " x=\"\(stack * 100)\" y=\"0\"" : ""
+        let nextXML = stackXML.isEmpty ? "" : "<next>\(stackXML)</next>"
+        stackXML =
+          "<block type=\"statement_value_input\" id=\"\(uuid)\"\(position)>" +
+            "<value name=\"value\">" +
+              "<block type=\"math_number\" id=\"\(uuid)_num\">" +
+                "<field name=\"NUM\">\(index)</field>" +
+              "</block>" +
+            "</value>" +
+            nextXML +
+          "</block>"
+      }
+      interiorXML += stackXML
+    }
+
+    return "<xml xmlns=\"http://www.w3.org/1999/xhtml\">\(interiorXML)</xml>"
+  }
+}
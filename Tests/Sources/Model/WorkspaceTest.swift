@@ -245,4 +245,57 @@ class WorkspaceTest: XCTestCase {
     XCTAssertEqual(0, nonMatchingVariableBlocks.count)
     XCTAssertEqual([], nonMatchingVariableBlocks)
   }
+
+  func testGetAllVariables_RenamedVariable() {
+    guard let block = BKYAssertDoesNotThrow(
+        { try _blockFactory.addBlock(name: "field_variable_block", toWorkspace: _workspace)} ),
+      let field = block.firstField(withName: "VAR") as? FieldVariable else
+    {
+      XCTFail("Could not create block")
+      return
+    }
+
+    BKYAssertDoesNotThrow { try field.setVariable("variable2") }
+
+    XCTAssertEqual(0, _workspace.allVariableBlocks(forName: "variable1").count)
+    XCTAssertEqual([block], _workspace.allVariableBlocks(forName: "variable2"))
+    XCTAssertEqual([field], _workspace.allVariableFields(forName: "variable2"))
+  }
+
+  func testGetAllVariables_RemovedBlock() {
+    guard let block1 = BKYAssertDoesNotThrow(
+        { try _blockFactory.addBlock(name: "field_variable_block", toWorkspace: _workspace)} ),
+      let block2 = BKYAssertDoesNotThrow(
+        { try _blockFactory.addBlock(name: "field_variable_block", toWorkspace: _workspace)} ),
+      let field1 = block1.firstField(withName: "VAR") as? FieldVariable else
+    {
+      XCTFail("Could not create blocks")
+      return
+    }
+
+    BKYAssertDoesNotThrow { try _workspace.removeBlockTree(block1) }
+
+    XCTAssertEqual([block2], _workspace.allVariableBlocks(forName: "variable1"))
+
+    // Changes to blocks that are no longer in the workspace are ignored
+    BKYAssertDoesNotThrow { try field1.setVariable("variable2") }
+    XCTAssertEqual(0, _workspace.allVariableBlocks(forName: "variable2").count)
+  }
+
+  func testGetAllVariables_AppendedInput() {
+    guard let block = BKYAssertDoesNotThrow(
+        { try _blockFactory.addBlock(name: "no_connections", toWorkspace: _workspace)} ) else
+    {
+      XCTFail("Could not create block")
+      return
+    }
+
+    let field = FieldVariable(name: "VAR", variable: "variable3")
+    block.appendInput(Input(type: .dummy, name: "dummy", fields: [field]))
+
+    XCTAssertEqual([block], _workspace.allVariableBlocks(forName: "variable3"))
+
+    BKYAssertDoesNotThrow { try field.setVariable("variable4") }
+    XCTAssertEqual([block], _workspace.allVariableBlocks(forName: "variable4"))
+  }
 }
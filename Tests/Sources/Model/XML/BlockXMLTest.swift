@@ -303,6 +303,44 @@ class BlockXMLTest: XCTestCase {
     XCTAssertEqual("dummy_mutator_xml_id", (block?.rootBlock.mutator as? DummyMutator)?.id)
   }
 
+  func testParseXMLString_BlockWithMutator() {
+    factory.blockBuilder(forName: "frankenblock")?.extensions = [BlockExtensionClosure { block in
+      self.BKYAssertDoesNotThrow {
+        try block.setMutator(DummyMutator())
+      }
+    }]
+
+    // Parse block with mutation xml, using the streaming loader
+    let xml = BlockTestStrings.assembleBlock(BlockTestStrings.DUMMY_MUTATOR_VALUE)
+    let blockTree = BKYAssertDoesNotThrow {
+      try Block.blockTree(fromXMLString: xml, factory: self.factory)
+    }
+
+    XCTAssertNotNil(blockTree?.rootBlock)
+    XCTAssertEqual("dummy_mutator_xml_id", (blockTree?.rootBlock.mutator as? DummyMutator)?.id)
+  }
+
+  func testParseXMLString_MatchesDOM() {
+    let xml = BlockTestStrings.assembleBlock(BlockTestStrings.NESTED_SHADOW_GOOD)
+    guard
+      let streamingTree = BKYAssertDoesNotThrow({
+        try Block.blockTree(fromXMLString: xml, factory: self.factory)
+      }),
+      let domTree = parseBlockFromXML(xml, factory) else
+    {
+      XCTFail("Could not load block from XML")
+      return
+    }
+
+    XCTAssertEqual(domTree.allBlocks.map { $0.uuid }, streamingTree.allBlocks.map { $0.uuid })
+    XCTAssertEqual(domTree.allBlocks.map { $0.shadow }, streamingTree.allBlocks.map { $0.shadow })
+  }
+
+  func testParseXMLString_BlockWithInvalidNestedShadowBlocks() {
+    let xml = BlockTestStrings.assembleBlock(BlockTestStrings.NESTED_SHADOW_BAD)
+    XCTAssertThrowsError(try Block.blockTree(fromXMLString: xml, factory: factory))
+  }
+
   func testParseXML_BlockDeletableTrue() throws {
     if let rootBlock =
       parseBlockFromXML(BlockTestStrings.BLOCK_DELETABLE_TRUE, factory)?.rootBlock {
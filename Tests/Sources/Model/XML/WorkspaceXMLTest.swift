@@ -15,6 +15,7 @@
 
 @testable import Blockly
 import XCTest
+import AEXML
 
 class WorkspaceXMLTest: XCTestCase {
   var workspace: Workspace!
@@ -103,6 +104,194 @@ class WorkspaceXMLTest: XCTestCase {
     }
   }
 
+  func testParseXML_StreamingMatchesDOM() {
+    let xml = makeLargeWorkspaceXML(stackCount: 5, stackHeight: 10)
+
+    let streamingWorkspace = Workspace()
+    BKYAssertDoesNotThrow {
+      try streamingWorkspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+
+    let domWorkspace = Workspace()
+    BKYAssertDoesNotThrow {
+      let xmlDoc = try AEXMLDocument(xml: xml)
+      try domWorkspace.loadBlocks(fromXML: xmlDoc.root, factory: self.factory)
+    }
+
+    XCTAssertEqual(100, streamingWorkspace.allBlocks.count)
+    assertWorkspace(streamingWorkspace, equalTo: domWorkspace)
+  }
+
+  func testParseXML_FromInputStream() {
+    let xml = makeLargeWorkspaceXML(stackCount: 2, stackHeight: 3)
+    let stream = InputStream(data: Data(xml.utf8))
+
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLStream: stream, factory: self.factory)
+    }
+    XCTAssertEqual(12, workspace.allBlocks.count)
+    XCTAssertEqual(2, workspace.topLevelBlocks().count)
+    XCTAssertEqual(WorkspacePoint(x: 100, y: 0), workspace.allBlocks["1_0"]?.position)
+    XCTAssertEqual("2",
+      (workspace.allBlocks["0_2_num"]?.firstField(withName: "NUM") as? FieldInput)?.text)
+  }
+
+  func testParseXML_StreamingLoaderStatistics() {
+    let xml = makeLargeWorkspaceXML(stackCount: 3, stackHeight: 4)
+    let loader = BlockXMLStreamLoader(factory: factory)
+
+    XCTAssertNil(loader.lastLoadStatistics)
+    BKYAssertDoesNotThrow { try loader.blockTrees(fromWorkspaceXMLData: Data(xml.utf8)) }
+    XCTAssertEqual(24, loader.lastLoadStatistics?.blockCount)
+    XCTAssertEqual(xml.utf8.count, loader.lastLoadStatistics?.byteCount)
+  }
+
+  func testParseXML_StreamingBadXMLDoesNotLoadBlocks() {
+    let xml = makeLargeWorkspaceXML(stackCount: 2, stackHeight: 2) + "<block"
+
+    XCTAssertThrowsError(try workspace.loadBlocks(fromXMLString: xml, factory: factory))
+    XCTAssertEqual(0, workspace.allBlocks.count)
+  }
+
+  func testParseXML_StreamingMutationAfterOtherElements() {
+    let factory = BlockFactory()
+    factory.load(fromDefaultFiles: .logicDefault)
+
+    // The "IF1" input only exists once the mutation has been applied
+    let xml = assembleWorkspace(
+      "<block type=\"controls_if\" id=\"if\" x=\"10\" y=\"20\">" +
+        "<value name=\"IF1\">" +
+          "<block type=\"logic_boolean\" id=\"bool\"><field name=\"BOOL\">FALSE</field></block>" +
+        "</value>" +
+        "<mutation elseif=\"1\" else=\"1\"></mutation>" +
+        "<statement name=\"ELSE\">" +
+          "<block type=\"controls_if\" id=\"nested\">" +
+            "<value name=\"IF0\">" +
+              "<block type=\"logic_boolean\" id=\"nested_bool\"></block>" +
+            "</value>" +
+          "</block>" +
+        "</statement>" +
+      "</block>")
+
+    let streamingWorkspace = Workspace()
+    BKYAssertDoesNotThrow {
+      try streamingWorkspace.loadBlocks(fromXMLString: xml, factory: factory)
+    }
+
+    let domWorkspace = Workspace()
+    BKYAssertDoesNotThrow {
+      let xmlDoc = try AEXMLDocument(xml: xml)
+      try domWorkspace.loadBlocks(fromXML: xmlDoc.root, factory: factory)
+    }
+
+    XCTAssertEqual(4, streamingWorkspace.allBlocks.count)
+    assertWorkspace(streamingWorkspace, equalTo: domWorkspace)
+
+    let ifBlock = streamingWorkspace.allBlocks["if"]
+    XCTAssertTrue(ifBlock?.firstInput(withName: "IF1")?.connectedBlock ===
+      streamingWorkspace.allBlocks["bool"])
+    XCTAssertEqual("FALSE",
+      (streamingWorkspace.allBlocks["bool"]?.firstField(withName: "BOOL") as? FieldDropdown)?
+        .selectedOption?.value)
+    XCTAssertTrue(ifBlock?.firstInput(withName: "ELSE")?.connectedBlock ===
+      streamingWorkspace.allBlocks["nested"])
+    XCTAssertTrue(streamingWorkspace.allBlocks["nested"]?.firstInput(withName: "IF0")?
+      .connectedBlock === streamingWorkspace.allBlocks["nested_bool"])
+  }
+
+  func testParseXML_StreamingMutationlessBlocksWithLongChain() {
+    let factory = BlockFactory()
+    factory.load(fromDefaultFiles: .logicDefault)
+
+    // Blockly omits the mutation of an "if" block without any "else-if" or "else" inputs
+    let chainLength = 40
+    var xml = ""
+    for i in 0 ..< chainLength {
+      let position = (i == 0) ? " x=\"0\" y=\"0\"" : ""
+      xml += "<block type=\"controls_if\" id=\"if_\(i)\"\(position)>"
+      xml += "<value name=\"IF0\"><block type=\"logic_boolean\" id=\"bool_\(i)\">"
+      xml += "<field name=\"BOOL\">TRUE</field></block></value>"
+      if i < chainLength - 1 {
+        xml += "<next>"
+      }
+    }
+    for i in 0 ..< chainLength {
+      xml += (i > 0) ? "</next></block>" : "</block>"
+    }
+    xml = assembleWorkspace(xml)
+
+    let loader = BlockXMLStreamLoader(factory: factory)
+    let blockTrees = BKYAssertDoesNotThrow {
+      try loader.blockTrees(fromWorkspaceXMLData: Data(xml.utf8))
+    }
+    XCTAssertEqual(1, blockTrees?.count)
+    XCTAssertEqual(chainLength * 2, blockTrees?.first?.allBlocks.count)
+    XCTAssertEqual(chainLength * 2, loader.lastLoadStatistics?.blockCount)
+    // Nothing needed to wait for a mutation
+    XCTAssertEqual(0, loader.lastLoadStatistics?.bufferedElementCount)
+
+    let streamingWorkspace = Workspace()
+    BKYAssertDoesNotThrow {
+      try streamingWorkspace.loadBlocks(fromXMLString: xml, factory: factory)
+    }
+
+    let domWorkspace = Workspace()
+    BKYAssertDoesNotThrow {
+      let xmlDoc = try AEXMLDocument(xml: xml)
+      try domWorkspace.loadBlocks(fromXML: xmlDoc.root, factory: factory)
+    }
+
+    assertWorkspace(streamingWorkspace, equalTo: domWorkspace)
+    XCTAssertTrue(streamingWorkspace.allBlocks["if_\(chainLength - 1)"]?.previousBlock ===
+      streamingWorkspace.allBlocks["if_\(chainLength - 2)"])
+    XCTAssertTrue(streamingWorkspace.allBlocks["if_0"]?.firstInput(withName: "IF0")?
+      .connectedBlock === streamingWorkspace.allBlocks["bool_0"])
+  }
+
+  // MARK: - XML Parsing Benchmarks
+
+  func testBenchmarkParseXML_Streaming() {
+    let xmlData = Data(makeLargeWorkspaceXML(stackCount: 50, stackHeight: 20).utf8)
+    let loader = BlockXMLStreamLoader(factory: factory)
+
+    measure {
+      self.BKYAssertDoesNotThrow {
+        try loader.blockTrees(fromWorkspaceXMLData: xmlData)
+      }
+    }
+
+    if let statistics = loader.lastLoadStatistics {
+      print("Streaming XML load: \(statistics.blockCount) blocks, " +
+        "\(Int(statistics.blocksPerSecond)) blocks/sec, " +
+        "\(Int(statistics.bytesPerSecond ?? 0)) bytes/sec")
+    }
+  }
+
+  func testBenchmarkParseXML_DOM() {
+    let xmlData = Data(makeLargeWorkspaceXML(stackCount: 50, stackHeight: 20).utf8)
+    var blockCount = 0
+    var duration: TimeInterval = 0
+
+    measure {
+      let startTime = Date()
+      self.BKYAssertDoesNotThrow {
+        let xmlDoc = try AEXMLDocument(xml: xmlData)
+        blockCount = 0
+        for blockXML in xmlDoc.root["block"].all ?? [] {
+          let blockTree = try Block.blockTree(fromXML: blockXML, factory: self.factory)
+          blockCount += blockTree.allBlocks.count
+        }
+      }
+      duration = Date().timeIntervalSince(startTime)
+    }
+
+    if duration > 0 {
+      print("DOM XML load: \(blockCount) blocks, " +
+        "\(Int(Double(blockCount) / duration)) blocks/sec, " +
+        "\(Int(Double(xmlData.count) / duration)) bytes/sec")
+    }
+  }
+
   // MARK: - XML Serialization Tests
 
   func testSerializeXML_EmptyWorkspace() {
@@ -209,9 +398,205 @@ class WorkspaceXMLTest: XCTestCase {
     }
   }
 
+  func testSerializeXML_WriterMatchesDOM() {
+    let xml = makeLargeWorkspaceXML(stackCount: 3, stackHeight: 4)
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+
+    // Exercise escaping and optional attributes
+    (workspace.allBlocks["0_1_num"]?.firstField(withName: "NUM") as? FieldInput)?.text =
+      "<a & 'b' \"c\">"
+    workspace.allBlocks["1_0"]?.disabled = true
+    workspace.allBlocks["2_0"]?.inputsInline = true
+    workspace.allBlocks["2_0"]?.editable = false
+
+    guard
+      let expected = BKYAssertDoesNotThrow({ try self.workspace.toXMLDocument().xml }),
+      let actual = BKYAssertDoesNotThrow({
+        try BlockXMLWriter().xmlString(forWorkspace: self.workspace)
+      }) else
+    {
+      XCTFail("Could not serialize workspace")
+      return
+    }
+
+    assertXML(actual, equalTo: expected)
+  }
+
+  func testSerializeXML_WriterMatchesDOMForBlock() {
+    let xml = makeLargeWorkspaceXML(stackCount: 1, stackHeight: 3)
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+
+    guard
+      let block = workspace.allBlocks["0_0"],
+      let expected = BKYAssertDoesNotThrow({ try block.toXMLElement().xml }),
+      let actual = BKYAssertDoesNotThrow({ try block.toXML() }) else
+    {
+      XCTFail("Could not serialize block")
+      return
+    }
+
+    assertXML(actual, equalTo: expected)
+  }
+
+  func testSerializeXML_WriterMatchesDOMForEmptyWorkspace() {
+    guard
+      let expected = BKYAssertDoesNotThrow({ try Workspace().toXMLDocument().xml }),
+      let actual = BKYAssertDoesNotThrow({ try Workspace().toXML() }) else
+    {
+      XCTFail("Could not serialize workspace")
+      return
+    }
+
+    XCTAssertEqual(expected, actual)
+  }
+
+  func testSerializeXML_WriterToOutputStream() {
+    let xml = makeLargeWorkspaceXML(stackCount: 20, stackHeight: 20)
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+
+    let writer = BlockXMLWriter()
+    let stream = OutputStream.toMemory()
+    stream.open()
+    BKYAssertDoesNotThrow { try writer.write(workspace: self.workspace, to: stream) }
+    stream.close()
+
+    guard
+      let data = stream.property(forKey: .dataWrittenToMemoryStreamKey) as? Data,
+      let expected =
+        BKYAssertDoesNotThrow({ try writer.xmlString(forWorkspace: self.workspace) }) else
+    {
+      XCTFail("Could not serialize workspace")
+      return
+    }
+
+    XCTAssertEqual(expected, String(decoding: data, as: UTF8.self))
+    XCTAssertEqual(data.count, writer.lastWriteStatistics?.byteCount)
+  }
+
+  // MARK: - XML Serialization Benchmarks
+
+  func testBenchmarkSerializeXML_Writer() {
+    let xml = makeLargeWorkspaceXML(stackCount: 50, stackHeight: 20)
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+    let writer = BlockXMLWriter()
+
+    measure {
+      self.BKYAssertDoesNotThrow { try writer.xmlString(forWorkspace: self.workspace) }
+    }
+
+    if let statistics = writer.lastWriteStatistics {
+      print("BlockXMLWriter: \(statistics.elementCount) elements, \(statistics.byteCount) bytes, " +
+        "\(statistics.bufferGrowthCount) buffer reallocations, " +
+        "\(Int(statistics.duration * 1000)) ms")
+    }
+  }
+
+  func testBenchmarkSerializeXML_DOM() {
+    let xml = makeLargeWorkspaceXML(stackCount: 50, stackHeight: 20)
+    BKYAssertDoesNotThrow {
+      try self.workspace.loadBlocks(fromXMLString: xml, factory: self.factory)
+    }
+
+    measure {
+      self.BKYAssertDoesNotThrow { try self.workspace.toXMLDocument().xml }
+    }
+  }
+
   // MARK: - Helper methods
 
   fileprivate func assembleWorkspace(_ interiorXML: String) -> String {
     return "<xml xmlns=\"http://www.w3.org/1999/xhtml\">\(interiorXML)</xml>"
   }
+
+  /**
+   Returns workspace XML containing `stackCount` stacks of `statement_value_input` blocks, where
+   each stack is `stackHeight` blocks tall and each block has a `math_number` block in its input.
+   Block ids are of the form "<stack>_<index>" and "<stack>_<index>_num".
+   */
+  fileprivate func makeLargeWorkspaceXML(stackCount: Int, stackHeight: Int) -> String {
+    var interiorXML = ""
+
+    for stack in 0 ..< stackCount {
+      var stackXML = ""
+      for index in (0 ..< stackHeight).reversed() {
+        let uuid = "\(stack)_\(index)"
+        let position = index == 0 ? " x=\"\(stack * 100)\" y=\"0\"" : ""
+        let nextXML = stackXML.isEmpty ? "" : "<next>\(stackXML)</next>"
+        stackXML =
+          "<block type=\"statement_value_input\" id=\"\(uuid)\"\(position)>" +
+            "<value name=\"value\">" +
+              "<block type=\"math_number\" id=\"\(uuid)_num\">" +
+                "<field name=\"NUM\">\(index)</field>" +
+              "</block>" +
+            "</value>" +
+            nextXML +
+          "</block>"
+      }
+      interiorXML += stackXML
+    }
+
+    return assembleWorkspace(interiorXML)
+  }
+
+  /**
+   Asserts that two XML strings are identical, except for the order of attributes within each
+   element (since `AEXMLElement` writes attributes in dictionary order).
+   */
+  fileprivate func assertXML(_ xml: String, equalTo expected: String) {
+    XCTAssertEqual(expected.utf8.count, xml.utf8.count)
+    XCTAssertEqual(normalizeAttributeOrder(expected), normalizeAttributeOrder(xml))
+  }
+
+  fileprivate func normalizeAttributeOrder(_ xml: String) -> String {
+    let tagRegex = try! NSRegularExpression(pattern: "<([^\\s/>?]+)((?:\\s[^\\s=]+=\"[^\"]*\")*)")
+    let attributeRegex = try! NSRegularExpression(pattern: "\\s[^\\s=]+=\"[^\"]*\"")
+    let nsXML = xml as NSString
+    var result = ""
+    var location = 0
+
+    for match in tagRegex.matches(in: xml, range: NSRange(location: 0, length: nsXML.length)) {
+      let attributesRange = match.range(at: 2)
+      let attributesString = nsXML.substring(with: attributesRange)
+      let attributesLength = (attributesString as NSString).length
+      let attributes = attributeRegex
+        .matches(in: attributesString, range: NSRange(location: 0, length: attributesLength))
+        .map { (attributesString as NSString).substring(with: $0.range) }
+        .sorted()
+
+      result += nsXML.substring(
+        with: NSRange(location: location, length: attributesRange.location - location))
+      result += attributes.joined()
+      location = attributesRange.location + attributesRange.length
+    }
+    result += nsXML.substring(from: location)
+
+    return result
+  }
+
+  fileprivate func assertWorkspace(_ workspace: Workspace, equalTo expected: Workspace) {
+    XCTAssertEqual(expected.allBlocks.count, workspace.allBlocks.count)
+
+    for (uuid, expectedBlock) in expected.allBlocks {
+      guard let block = workspace.allBlocks[uuid] else {
+        XCTFail("Missing block with uuid '\(uuid)'")
+        continue
+      }
+
+      XCTAssertEqual(expectedBlock.name, block.name)
+      XCTAssertEqual(expectedBlock.position, block.position)
+      XCTAssertEqual(expectedBlock.parentBlock?.uuid, block.parentBlock?.uuid)
+      XCTAssertEqual(expectedBlock.nextBlock?.uuid, block.nextBlock?.uuid)
+      XCTAssertEqual(
+        (expectedBlock.firstField(withName: "NUM") as? FieldInput)?.text,
+        (block.firstField(withName: "NUM") as? FieldInput)?.text)
+    }
+  }
 }
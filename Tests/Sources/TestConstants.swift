@@ -14,7 +14,6 @@
 */
 
 import Foundation
-import UIKit
 
 public class TestConstants {
   /** Allow for this amount of difference when comparing two Floats together. */